@@ -90,6 +90,7 @@ gem_kernelSBO(gemID src, gemID tool, /*@null@*/ double *xform, int type,
   mdl->location  = NULL;
   mdl->modeler   = gem_strdup("EGADS");
   mdl->nBRep     = nBRep;
+  mdl->mBRep     = nBRep;
   mdl->BReps     = BReps;
   mdl->nParams   = 0;
   mdl->Params    = NULL;
@@ -36,6 +36,14 @@ gem_kernelInit()
 }
 
 
+int
+gem_kernelThreadSafe()
+{
+  /* EGADS (OpenCASCADE) is not reentrant -- keep all calls serial */
+  return 0;
+}
+
+
 /*@null@*/ /*@observer@*/ const char *
 gem_kernelError(int code)
 {
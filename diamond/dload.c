@@ -762,6 +762,7 @@ gem_kernelLoad(gemCntxt *gem_cntxt, /*@null@*/ char *server,
     mdl->location  = gem_strdup(name);
     mdl->modeler   = gem_strdup("OpenCSM");
     mdl->nBRep     = nBRep;
+    mdl->mBRep     = nBRep;
     mdl->BReps     = BReps;
     mdl->nParams   = 0;
     mdl->Params    = NULL;
@@ -816,6 +817,7 @@ gem_kernelLoad(gemCntxt *gem_cntxt, /*@null@*/ char *server,
     mdl->location  = gem_strdup(name);
     mdl->modeler   = gem_strdup("EGADS");
     mdl->nBRep     = nBRep;
+    mdl->mBRep     = nBRep;
     mdl->BReps     = BReps;
     mdl->nParams   = 0;
     mdl->Params    = NULL;
@@ -12,6 +12,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #ifdef WIN32
 #define snprintf _snprintf
 #endif
@@ -32,21 +33,293 @@
 
   extern void gem_releaseBRep(/*@only@*/ gemBRep *brep);
   extern int  gem_clrDReps(gemModel *model, int phase);
+  extern int  gem_refreshDReps(gemModel *model, int *keep);
   extern int  gem_diamondBody(ego object, /*@null@*/ char *bID, 
                               gemBRep *brep);
 
 
+/*
+ * FNV-1a hash of the bytes
+ */
+static void
+gem_hashAdd(unsigned int *hash, const void *data, size_t nbytes)
+{
+  size_t              i;
+  const unsigned char *bytes = (const unsigned char *) data;
+  
+  for (i = 0; i < nbytes; i++) {
+    *hash ^= bytes[i];
+    *hash *= 16777619U;
+  }
+}
+
+
+/*
+ * the topology & geometry hashes of a loaded Body -- these match what
+ *   gem_egoHash returns for the EGADS Body it was made from
+ */
+static void
+gem_bodyHash(gemBody *body, unsigned int *topo, unsigned int *geom)
+{
+  int i, n[5];
+  
+  *topo = *geom = 2166136261U;
+  n[0] = body->nnode;
+  n[1] = body->nedge;
+  n[2] = body->nloop;
+  n[3] = body->nface;
+  n[4] = body->nshell;
+  gem_hashAdd(topo, n, 5*sizeof(int));
+  for (i = 0; i < body->nloop; i++)
+    gem_hashAdd(topo, &body->loops[i].nedges, sizeof(int));
+  for (i = 0; i < body->nface; i++) {
+    gem_hashAdd(topo, &body->faces[i].nloops, sizeof(int));
+    gem_hashAdd(topo, &body->faces[i].norm,   sizeof(int));
+  }
+  for (i = 0; i < body->nshell; i++)
+    gem_hashAdd(topo, &body->shells[i].nfaces, sizeof(int));
+  
+  gem_hashAdd(geom, body->box, 6*sizeof(double));
+  for (i = 0; i < body->nnode; i++)
+    gem_hashAdd(geom, body->nodes[i].xyz,    3*sizeof(double));
+  for (i = 0; i < body->nedge; i++)
+    gem_hashAdd(geom, body->edges[i].tlimit, 2*sizeof(double));
+  for (i = 0; i < body->nface; i++)
+    gem_hashAdd(geom, body->faces[i].uvbox,  4*sizeof(double));
+}
+
+
+/*
+ * the Body's Nodes, Edges, Loops, Faces & Shells -- Degenerate Edges are
+ *   removed (as in gem_diamondBody)
+ */
+static int
+gem_egoTopos(ego object, int *n, ego **objs)
+{
+  int    i, j, stat, oclass, mtype, nchild, *senses;
+  double limits[4];
+  ego    geom, *child;
+  
+  for (i = 0; i < 5; i++) {
+    n[i]    = 0;
+    objs[i] = NULL;
+  }
+  stat = EG_getBodyTopos(object, NULL, NODE,  &n[0], &objs[0]);
+  if (stat != EGADS_SUCCESS) return stat;
+  stat = EG_getBodyTopos(object, NULL, EDGE,  &n[1], &objs[1]);
+  if (stat != EGADS_SUCCESS) return stat;
+  stat = EG_getBodyTopos(object, NULL, LOOP,  &n[2], &objs[2]);
+  if (stat != EGADS_SUCCESS) return stat;
+  stat = EG_getBodyTopos(object, NULL, FACE,  &n[3], &objs[3]);
+  if (stat != EGADS_SUCCESS) return stat;
+  stat = EG_getBodyTopos(object, NULL, SHELL, &n[4], &objs[4]);
+  if (stat != EGADS_SUCCESS) return stat;
+  
+  for (j = i = 0; i < n[1]; i++) {
+    stat = EG_getTopology(objs[1][i], &geom, &oclass, &mtype, limits, &nchild,
+                          &child, &senses);
+    if (stat != EGADS_SUCCESS) return stat;
+    if (mtype == DEGENERATE) continue;
+    objs[1][j] = objs[1][i];
+    j++;
+  }
+  n[1] = j;
+  
+  return EGADS_SUCCESS;
+}
+
+
+static void
+gem_egoFree(ego **objs)
+{
+  int i;
+  
+  for (i = 0; i < 5; i++)
+    if (objs[i] != NULL) EG_free(objs[i]);
+}
+
+
+/*
+ * the topology & geometry hashes of an EGADS Body (see gem_bodyHash)
+ */
+static int
+gem_egoHash(ego object, unsigned int *topo, unsigned int *geom)
+{
+  int    i, j, k, stat, oclass, mtype, nchild, nedge, *senses, n[5];
+  double limits[4], box[6];
+  ego    eg, *child, *edges, *objs[5];
+  
+  *topo = *geom = 2166136261U;
+  stat  = EG_getBoundingBox(object, box);
+  if (stat != EGADS_SUCCESS) return stat;
+  stat  = gem_egoTopos(object, n, objs);
+  if (stat != EGADS_SUCCESS) goto ret;
+  gem_hashAdd(topo, n, 5*sizeof(int));
+  gem_hashAdd(geom, box, 6*sizeof(double));
+
+  for (i = 0; i < n[2]; i++) {
+    stat = EG_getTopology(objs[2][i], &eg, &oclass, &mtype, limits, &nedge,
+                          &edges, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    for (k = j = 0; j < nedge; j++) {
+      stat = EG_getTopology(edges[j], &eg, &oclass, &mtype, limits, &nchild,
+                            &child, &senses);
+      if (stat != EGADS_SUCCESS) goto ret;
+      if (mtype != DEGENERATE) k++;
+    }
+    gem_hashAdd(topo, &k, sizeof(int));
+  }
+  for (i = 0; i < n[3]; i++) {
+    stat = EG_getTopology(objs[3][i], &eg, &oclass, &mtype, limits, &nchild,
+                          &child, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    gem_hashAdd(topo, &nchild, sizeof(int));
+    gem_hashAdd(topo, &mtype,  sizeof(int));
+  }
+  for (i = 0; i < n[4]; i++) {
+    stat = EG_getTopology(objs[4][i], &eg, &oclass, &mtype, limits, &nchild,
+                          &child, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    gem_hashAdd(topo, &nchild, sizeof(int));
+  }
+  
+  for (i = 0; i < n[0]; i++) {
+    stat = EG_getTopology(objs[0][i], &eg, &oclass, &mtype, limits, &nchild,
+                          &child, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    gem_hashAdd(geom, limits, 3*sizeof(double));
+  }
+  for (i = 0; i < n[1]; i++) {
+    stat = EG_getTopology(objs[1][i], &eg, &oclass, &mtype, limits, &nchild,
+                          &child, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    gem_hashAdd(geom, limits, 2*sizeof(double));
+  }
+  for (i = 0; i < n[3]; i++) {
+    stat = EG_getTopology(objs[3][i], &eg, &oclass, &mtype, limits, &nchild,
+                          &child, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    gem_hashAdd(geom, limits, 4*sizeof(double));
+  }
+  stat = EGADS_SUCCESS;
+
+ret:
+  gem_egoFree(objs);
+  return stat;
+}
+
+
+/*
+ * point a reused Body at the rebuilt EGADS objects -- the same construction
+ *   returns the entities in the same order but the hashes cannot tell
+ *   Faces apart that only swapped places, so each Face's OpenCSM ID & 
+ *   limits are checked first. Returns 1 (nothing changed) on a mismatch
+ */
+static int
+gem_diamondRebind(ego object, gemBody *body)
+{
+  int          i, j, m, stat, oclass, mtype, nchild, atype, alen, n[5];
+  int          *senses;
+  const int    *ints;
+  double       limits[4];
+  const double *reals;
+  char         buffer[1025];
+  const char   *string;
+  ego          geom, *child, *objs[5];
+  
+  stat = gem_egoTopos(object, n, objs);
+  if (stat != EGADS_SUCCESS) goto ret;
+  stat = 1;
+  if ((n[0] != body->nnode) || (n[1] != body->nedge) ||
+      (n[2] != body->nloop) || (n[3] != body->nface) ||
+      (n[4] != body->nshell)) goto ret;
+  for (i = 0; i < body->nface; i++) {
+    stat = EG_getTopology(objs[3][i], &geom, &oclass, &mtype, limits,
+                          &nchild, &child, &senses);
+    if (stat != EGADS_SUCCESS) goto ret;
+    stat = 1;
+    for (j = 0; j < 4; j++)
+      if (limits[j] != body->faces[i].uvbox[j]) goto ret;
+    if (body->faces[i].ID == NULL) goto ret;
+    if (EG_attributeRet(objs[3][i], "body", &atype, &alen, &ints, &reals,
+                        &string) != EGADS_SUCCESS) goto ret;
+    if ((atype != ATTRINT) || (alen < 2)) goto ret;
+    snprintf(buffer, 1024, "%d:%d", ints[0], ints[1]);
+    for (j = 2; j < alen; j+=2) {
+      m = strlen(buffer);
+      if (m >= 1024) break;
+      snprintf(&buffer[m], 1024-m, "::%d:%d", ints[j], ints[j+1]);
+    }
+    buffer[1024] = 0;
+    if (strcmp(buffer, body->faces[i].ID) != 0) goto ret;
+  }
+  
+  body->handle.ident.ptr = object;
+  for (i = 0; i < body->nnode; i++)
+    body->nodes[i].handle.ident.ptr  = objs[0][i];
+  for (i = 0; i < body->nedge; i++)
+    body->edges[i].handle.ident.ptr  = objs[1][i];
+  for (i = 0; i < body->nloop; i++)
+    body->loops[i].handle.ident.ptr  = objs[2][i];
+  for (i = 0; i < body->nface; i++)
+    body->faces[i].handle.ident.ptr  = objs[3][i];
+  for (i = 0; i < body->nshell; i++)
+    body->shells[i].handle.ident.ptr = objs[4][i];
+  stat = EGADS_SUCCESS;
+
+ret:
+  gem_egoFree(objs);
+  return stat;
+}
+
+
+/*
+ * the first Branch (bias 1) with an argument that uses the Parameter --
+ *   nbrch+1 if none does
+ */
+static int
+gem_firstUse(void *modl, int nbrch, const char *name)
+{
+  int    i, j, len, stat, type, class, actv, ichld, ileft, irite, narg, nattr;
+  char   args[1025], *s;
+  double value;
+  
+  len = strlen(name);
+  for (i = 1; i <= nbrch; i++) {
+    stat = ocsmGetBrch(modl, i, &type, &class, &actv, &ichld, &ileft, &irite,
+                       &narg, &nattr);
+    if (stat != SUCCESS) return i;
+    for (j = 1; j <= narg; j++) {
+      stat = ocsmGetArg(modl, i, j, args, &value);
+      if (stat != SUCCESS) return i;
+      for (s = strstr(args, name); s != NULL; s = strstr(s+1, name)) {
+        if ((s != args) && (isalnum(s[-1]) || (s[-1] == '_') ||
+                            (s[-1] == '@') || (s[-1] == ':'))) continue;
+        if (isalnum(s[len]) || (s[len] == '_') || (s[len] == '@') ||
+            (s[len] == ':')) continue;
+        return i;
+      }
+    }
+  }
+  
+  return nbrch+1;
+}
+
+
 int
 gem_kernelRegen(gemModel *model)
 {
-  int    i, j, k, n, nrow, ncol;
-  int    stat, actv, type, buildTo, builtTo, nBRep, ibody;
-  char   defn[22], name[129];
-  void   *modl;
-  double real;
-  ego    obj;
-  modl_T *MODL;
-  gemID  handle;
+  int          i, j, k, n, nrow, ncol, nbrch, npmtr, nbod, first, nold;
+  int          stat, actv, type, buildTo, builtTo, nBRep, ibody, same;
+  int          *match;
+  unsigned int topo, geom, *hashes;
+  char         defn[22], name[129];
+  void         *modl;
+  double       real;
+  ego          obj;
+  modl_T       *MODL;
+  gemID        handle;
+  gemBRep      **BReps, **old;
   
   modl = model->handle.ident.ptr;
   MODL = (modl_T *) modl;
@@ -55,6 +328,11 @@ gem_kernelRegen(gemModel *model)
     if (model->Params[i].changed == 0) continue;
     if (model->Params[i].type != GEM_REAL) return GEM_BADTYPE;
   }
+  stat = ocsmInfo(modl, &nbrch, &npmtr, &nbod);
+  if (stat != SUCCESS) return stat;
+  
+  /* set the changes & find the first Branch that sees one */
+  first = nbrch+1;
   for (i = 0; i < model->nParams; i++) {
     if (model->Params[i].changed == 0) continue;
     stat = ocsmGetPmtr(modl, i+1, &type, &nrow, &ncol, name);
@@ -78,6 +356,8 @@ gem_kernelRegen(gemModel *model)
         }
     }
     model->Params[i].changed = 0;
+    j = gem_firstUse(modl, nbrch, name);
+    if (j < first) first = j;
   }
 
   for (i = 0; i < model->nBranches; i++) {
@@ -89,80 +369,120 @@ gem_kernelRegen(gemModel *model)
       printf(" GEM/OpenCSM status = %d on changing %s to %d!\n",
              stat, model->Branches[i].name, actv);
     model->Branches[i].changed = 0;
+    if (i < first) first = i;
   }
   
-  /* remove old geometry, rebuild */
+#ifdef GEM_REBIND
+  /* none of the built Branches see the changes */
+  if ((first > nbrch) && (model->nBRep != 0)) return GEM_SUCCESS;
+#else
+  /* no Body is reused -- everything is reloaded & the DReps refilled */
+  first = 1;
+#endif
+  
+  /* remove old geometry (the BReps are kept for reuse), rebuild */
   
-  for (i = 0; i < model->nBRep; i++) {
-    obj = (ego) model->BReps[i]->body->handle.ident.ptr;
+  nold   = model->nBRep;
+  old    = model->BReps;
+  hashes = NULL;
+  match  = NULL;
+  BReps  = NULL;
+  nBRep  = 0;
+#ifdef GEM_REBIND
+  if (nold != 0) {
+    hashes = (unsigned int *) gem_allocate(2*nold*sizeof(unsigned int));
+    if (hashes == NULL) return GEM_ALLOC;
+    for (i = 0; i < nold; i++)
+      gem_bodyHash(old[i]->body, &hashes[2*i], &hashes[2*i+1]);
+  }
+#endif
+  for (i = 0; i < nold; i++) {
+    obj = (ego) old[i]->body->handle.ident.ptr;
     EG_deleteObject(obj);
-    gem_releaseBRep(model->BReps[i]);
   }
-  gem_free(model->BReps);
-  model->BReps = NULL;
-  model->nBRep = 0;
-  gem_clrDReps(model, 0);
   
   buildTo = 0;                          /* all */
   nbody   = MAX_BODYS;
   stat    = ocsmBuild(modl, buildTo, &builtTo, &nbody, bodyList);
   EG_deleteObject(dia_context);         /* clean up after build */
-  if (stat != SUCCESS) return stat;
-  nBRep = nbody;
-
-  /* put away the new BReps */
-  model->BReps = (gemBRep **) gem_allocate(nBRep*sizeof(gemBRep *));
-  if (model->BReps == NULL) {
-    for (i = 0; i < nbody; i++) {
-      ibody = bodyList[i];
-      obj   = MODL->body[ibody].ebody;
-      EG_deleteObject(obj);
-    }
-    return GEM_ALLOC;
+  if (stat != SUCCESS) {
+    nbody = 0;
+    goto cleanup;
   }
+
+  /* put away the new BReps -- a Body from before the first changed Branch
+     that hashes the same as an old one takes over its BRep */
+  stat  = GEM_ALLOC;
+  BReps = (gemBRep **) gem_allocate(nbody*sizeof(gemBRep *));
+  if (BReps == NULL) goto cleanup;
+  match = (int *) gem_allocate(nbody*sizeof(int));
+  if (match == NULL) goto cleanup;
   handle.index     = 0;
   handle.ident.ptr = modl;
-  for (i = 0; i < nBRep; i++) {
-    model->BReps[i] = (gemBRep *) gem_allocate(sizeof(gemBRep));
-    if (model->BReps[i] == NULL) {
-      for (j = 0; j < i; j++) gem_free(model->BReps[j]);
-      gem_free(model->BReps);
-      model->BReps = NULL;
-      for (j = 0; j < nbody; j++) {
-        ibody = bodyList[j];
-        obj   = MODL->body[ibody].ebody;
-        EG_deleteObject(obj);
+  for (nBRep = 0; nBRep < nbody; nBRep++) {
+    ibody        = bodyList[nBRep];
+    obj          = MODL->body[ibody].ebody;
+    match[nBRep] = -1;
+    if (MODL->body[ibody].ibrch < first) {
+      stat = gem_egoHash(obj, &topo, &geom);
+      if (stat != EGADS_SUCCESS) goto cleanup;
+      for (j = 0; j < nold; j++) {
+        if (old[j] == NULL) continue;
+        if ((hashes[2*j] != topo) || (hashes[2*j+1] != geom)) continue;
+        stat = gem_diamondRebind(obj, old[j]->body);
+        if (stat > EGADS_SUCCESS) break;
+        if (stat < EGADS_SUCCESS) goto cleanup;
+        BReps[nBRep] = old[j];
+        match[nBRep] = j;
+        old[j]       = NULL;
+        break;
       }
-      return GEM_ALLOC;
+      if (match[nBRep] >= 0) continue;
     }
-    model->BReps[i]->magic   = GEM_MBREP;
-    model->BReps[i]->omodel  = NULL;
-    model->BReps[i]->phandle = handle;
-    model->BReps[i]->ibranch = 0;
-    model->BReps[i]->inumber = 0;
-    model->BReps[i]->body    = NULL;
-  }
-  
-  /* reload the BReps */
-  for (j = i = 0; i < nbody; i++) {
-    ibody = bodyList[i];
-    obj   = MODL->body[ibody].ebody;
-    stat  = gem_diamondBody(obj, NULL, model->BReps[j]);
+    stat         = GEM_ALLOC;
+    BReps[nBRep] = (gemBRep *) gem_allocate(sizeof(gemBRep));
+    if (BReps[nBRep] == NULL) goto cleanup;
+    BReps[nBRep]->magic   = GEM_MBREP;
+    BReps[nBRep]->omodel  = NULL;
+    BReps[nBRep]->phandle = handle;
+    BReps[nBRep]->ibranch = 0;
+    BReps[nBRep]->inumber = 0;
+    BReps[nBRep]->body    = NULL;
+    stat = gem_diamondBody(obj, NULL, BReps[nBRep]);
     if (stat != EGADS_SUCCESS) {
-      for (j = 0; j < nBRep; j++) gem_releaseBRep(model->BReps[j]);
-      gem_free(model->BReps);
-      model->BReps = NULL;
-      for (j = 0; j < nbody; j++) {
-        ibody = bodyList[j];
-        obj   = MODL->body[ibody].ebody;
-        EG_deleteObject(obj);
+      if (BReps[nBRep]->body == NULL) {
+        gem_free(BReps[nBRep]);
+      } else {
+        gem_releaseBRep(BReps[nBRep]);
       }
-      return stat;
+      goto cleanup;
     }
   }
-  for (i = 0; i < nBRep; i++) model->BReps[i]->omodel = model;
+  for (i = 0; i < nold; i++)
+    if (old[i] != NULL) gem_releaseBRep(old[i]);
+  
+  /* with the same number of BReps the DReps keep what was done on the
+     ones that stay in place -- otherwise they are refilled */
+  same = 0;
+#ifdef GEM_REBIND
+  if (nBRep == nold) {
+    same = 1;
+    for (i = 0; i < nBRep; i++) match[i] = (match[i] == i) ? 1 : 0;
+  }
+#endif
+  if (same == 0) gem_clrDReps(model, 0);
+  for (i = 0; i < nBRep; i++) BReps[i]->omodel = model;
   model->nBRep = nBRep;
-  gem_clrDReps(model, 1);
+  model->mBRep = nBRep;
+  model->BReps = BReps;
+  if (same == 0) {
+    gem_clrDReps(model, 1);
+  } else {
+    gem_refreshDReps(model, match);
+  }
+  gem_free(old);
+  gem_free(match);
+  gem_free(hashes);
   
   /* refresh the parameters */
   for (i = 0; i < model->nParams; i++) {
@@ -183,4 +503,23 @@ gem_kernelRegen(gemModel *model)
   }
 
   return GEM_SUCCESS;
+  
+cleanup:
+  for (i = 0; i < nold; i++)
+    if (old[i] != NULL) gem_releaseBRep(old[i]);
+  for (i = 0; i < nBRep; i++) gem_releaseBRep(BReps[i]);
+  for (i = 0; i < nbody; i++) {
+    ibody = bodyList[i];
+    obj   = MODL->body[ibody].ebody;
+    EG_deleteObject(obj);
+  }
+  gem_free(old);
+  gem_free(BReps);
+  gem_free(match);
+  gem_free(hashes);
+  model->BReps = NULL;
+  model->nBRep = 0;
+  model->mBRep = 0;
+  gem_clrDReps(model, 0);
+  return stat;
 }
@@ -28,3 +28,6 @@ gem_clrAttribs(gemAttrs **attrx);
 
 extern void
 gem_cpyAttribs(gemAttrs *attrs, gemAttrs **attrx);
+
+extern void
+gem_memAttribs(/*@null@*/ gemAttrs *attr, int cat, gemMemReport *report);
@@ -41,6 +41,19 @@ typedef struct {
 } gemAprx1D;
 
 
+/*
+ * defines a uniform cell hash over the spline knot positions
+ */
+typedef struct {
+  int    ndim;                  /* number of hashed state-vector members */
+  int    ncell[3];              /* number of cells in each direction */
+  double lo[3];                 /* lower corner of the hashed box */
+  double del[3];                /* cell size in each direction */
+  int    *start;                /* first knot of each cell -- ncells+1 */
+  int    *knots;                /* knot indices sorted by cell */
+} gemKnotHash;
+
+
 typedef struct {
   int    nrank;                 /* number of members in the state-vector */
   int    periodic;              /* 0 non, 1 U, 2 V, 3 periodic in both U&V */
@@ -52,6 +65,8 @@ typedef struct {
   int    num;                   /* number of U mapping points */
   int    nvm;                   /* number of V mapping points */
   double *uvmap;                /* mapping data -- NULL unmapped */
+  gemKnotHash *khash;           /* hash of the spline knots -- NULL none */
+  gemKnotHash *mhash;           /* hash of the mapping knots -- NULL none */
 } gemAprx2D;
 
 
@@ -122,6 +137,26 @@ typedef struct {
   } gemElement;
 
 
+/*
+ * packed (structure-of-arrays) copy of the quilt geometry for the numerical
+ * kernels -- built by GEM once the disMethod has defined and GEM has checked
+ * the quilt. GEM owns it and the disMethods must treat it as read-only.
+ * All indices are bias 0.
+ */
+  typedef struct {
+    int    nPoints;             /* number of points */
+    double *xyz;                /* point coordinates -- 3*nPoints in length */
+    int    *fptr;               /* the Face entries of each point -- fptr[i]
+                                   to fptr[i+1]-1 (nPoints+1 in length) */
+    int    *fown;               /* Face entry owner (bias 1) -- fptr[nPoints] */
+    double *uv;                 /* Face entry [u,v] -- 2*fptr[nPoints] */
+    int    nElems;              /* number of elements */
+    int    *eptr;               /* the geometry reference points of element i
+                                   are conn[eptr[i]] to conn[eptr[i+1]-1] */
+    int    *conn;               /* element point indices -- eptr[nElems] */
+  } gemPacked;
+
+
 /*
  * defines a discretized quilt (the collection of Faces)
  *
@@ -147,6 +182,7 @@ typedef struct {
     int        nElems;          /* number of Elements */
     gemElement *elems;          /* the Elements (nElems in length) */
     void       *ptrm;           /* pointer for optional method use */
+    gemPacked  *packed;         /* GEM's packed copy -- NULL until checked */
   } gemQuilt;
 
 
@@ -170,6 +206,24 @@ typedef struct {
   } gemDSet;
 
 
+/*
+ * uniform bucket grid over the (non-degenerate) internal triangles of a
+ * source quilt in [u,v] -- used to accelerate point location. Built on
+ * demand and shared by all transfers out of the VertexSet.
+ */
+  typedef struct {
+    int    ntris;               /* number of internal triangles */
+    int    *tris;               /* elem/tri/i0/i1/i2 (bias 0) -- 5*ntris */
+    int    nu;                  /* number of cells in U */
+    int    nv;                  /* number of cells in V */
+    double box[4];              /* uv limits (umin,umax,vmin,vmax) */
+    double du;                  /* cell size in U */
+    double dv;                  /* cell size in V */
+    int    *start;              /* cell start into cells -- nu*nv+1 long */
+    int    *cells;              /* triangle indices binned in the cells */
+  } gemUVGrid;
+
+
 /*
  * defines the vertex set
  */
@@ -179,6 +233,7 @@ typedef struct {
     gemCollct *nonconn;         /* xyzs for non-connected VertexSet or NULL */
     int       ntris;            /* number of triangles constructed from quilt */
     prmTri    *tris;            /* the triangles and neighbors */
+    gemUVGrid *locate;          /* point-location grid for the quilt or NULL */
     int       nSets;            /* number of datasets */
     gemDSet   *sets;            /* the datasets */
   } gemVSet;
@@ -202,6 +257,27 @@ typedef struct {
   } gemMatch;
 
 
+/*
+ * assembled least-squares system for conservative transfers -- depends only
+ * on the MatchPoints and the target Quilt so it is reused across transfers
+ */
+  typedef struct {
+    int       n;                /* number of target data points */
+    int       nrow;             /* number of active MatchPoints */
+    int       *imat;            /* MatchPoint index for each row */
+    int       *wptr;            /* row pointers into wcol/wval (nrow+1) */
+    int       *wcol;            /* target data index (bias 0) */
+    double    *wval;            /* interpolation weight */
+    int       *sptr;            /* normal matrix row pointers (n+1) */
+    int       *scol;            /* normal matrix column indices (bias 0) */
+    double    *sval;            /* normal matrix values */
+    int       *pin;             /* 1 - point not seen by any MatchPoint */
+    double    *area;            /* d(target integral)/d(data) -- n in length */
+    double    *y;               /* normal matrix inverse applied to area */
+    double    ay;               /* area . y */
+  } gemCSys;
+
+
 /*
  * structure to hold the intersection data for one Vertex set against another
  */
@@ -214,6 +290,10 @@ typedef struct {
     int       nMatch;           /* number of match locations */
     gemTarget *position;        /* the positions in target for source */
     gemMatch  *match;           /* matching in source for target */
+    gemCSys   *csys;            /* conservative system or NULL */
+    int       cstat;            /* status of building csys -- not retried
+                                   when it failed (other than GEM_ALLOC) */
+    struct gemArena *scratch;   /* scratch kept between transfers or NULL */
     struct gemXfer *next;       /* pointer to next set of cuts */
   } gemXfer;
 
@@ -260,12 +340,14 @@ typedef struct {
 
 /*
  * defines the tessellation as a collection of discretized faces & edges
+ *   instances of the same Body share all but the xyzs with the first BRep
  */
   typedef struct {
     int      nEdges;            /* number of Edges */
     gemDEdge *Edges;            /* the Edge discretizations */
     int      nFaces;            /* number of Faces */
     gemTri   *Faces;            /* the Face tessellations */
+    int      owner;             /* 0 or BRep (bias 1) owning the shared data */
   } gemTRep;
 
 
@@ -279,6 +361,7 @@ typedef struct {
     char     **IDs;             /* the persistent Face IDs */
     int      nBReps;            /* number of BReps found in the Model */
     gemTRep  *TReps;            /* the tessellation of the BReps */
+    int      mTReps;            /* number of allocated TRep slots */
     int      nBound;            /* the number of Boundaries found in the DRep */
     gemBound *bound;            /* the Boundaries */
     gemAttrs *attr;             /* attribute structure */
@@ -640,3 +723,38 @@ gemIntegrate_bar(gemQuilt *quilt,       /* (in)   the quilt description */
                                                   (rank in length) */
                  double   dat_bar[]);   /* (both) d(objective)/d(data) 
                                                   (rank*npts in len) */
+
+
+/* the following batched functions are optional -- if not found in the 
+   so/DLL then the single element functions above are invoked in a loop */
+
+
+extern int
+gemInterpolationBatch(gemQuilt  *quilt, /* (in)  the quilt description */
+                      int       geomFlag,
+                                        /* (in)  0 - data ref, 1 - geom based
+                                                 specifies length of data */
+                      int       npts,   /* (in)  number of positions */
+                      gemTarget pos[],  /* (in)  element index (bias 1) and
+                                                 ref coordinates -- eIndex <= 0
+                                                 positions are skipped */
+                      int       rank,   /* (in)  # of members per */
+                      double    data[], /* (in)  values (rank*npts in length) */
+                      double    result[]);
+                                        /* (out) interpolated results - 
+                                                 (rank*npts in length) */
+
+
+extern int
+gemIntegrationBatch(gemQuilt *quilt,    /* (in)  the quilt description */
+                    int      geomFlag,  /* (in)  0 - data ref, 1 - geom based 
+                                                 specifies length of data */
+                    int      nelem,     /* (in)  number of elements */
+                    /*@null@*/
+                    int      eIndices[],
+                                        /* (in)  element indices (bias 1) or
+                                                 NULL for elements 1 to nelem */
+                    int      rank,      /* (in)  # of members per */
+                    double   data[],    /* (in)  values (rank*npts in length) */
+                    double   result[]); /* (out) integrated results -
+                                                 (rank*nelem in length) */
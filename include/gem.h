@@ -135,9 +135,84 @@
     gemModel *model;            /* starting model */
     gemDRep  *drep;             /* starting DRep */
     gemAttrs *attr;             /* the context attributes */
+    int      nThread;           /* threads for DRep operations -- 1 serial */
+    int      alloc;             /* allocator slot -- 0 malloc */
+    void     *prof;             /* the profile -- NULL without GEM_PROFILE */
   } gemCntxt;
 
 
+/*
+ * a replacement for malloc/realloc/free -- user is handed back on each call
+ */
+  typedef struct {
+    void *(*allocate)(void *user, size_t nbytes);
+    void *(*reallocate)(void *user, void *ptr, size_t nbytes);
+    void  (*release)(void *user, void *ptr);
+    void  *user;                /* the allocator's own data */
+  } gemAllocator;
+
+
+/*
+ * the memory statistics of the GEM storage
+ */
+  typedef struct {
+    long long nAlloc;           /* number of allocations */
+    long long nRealloc;         /* number of reallocations */
+    long long nFree;            /* number of frees */
+    long long inUse;            /* bytes in use */
+    long long peak;             /* most bytes in use at once */
+  } gemMemStats;
+
+
+/*
+ * the categories of a memory report
+ */
+#define GEM_MEMTREP     0       /* tessellations */
+#define GEM_MEMQUILT    1       /* quilts, their triangles & location grids */
+#define GEM_MEMDSET     2       /* DataSets & unconnected positions */
+#define GEM_MEMXFER     3       /* transfer caches */
+#define GEM_MEMAPPROX   4       /* Bound surface approximations */
+#define GEM_MEMMODEL    5       /* Model, Parameter & BRep storage */
+#define GEM_MEMOTHER    6       /* the objects, IDs & attributes */
+#define GEM_NMEMCAT     7
+
+  typedef struct {
+    long long bytes[GEM_NMEMCAT];       /* bytes held in each category */
+    long long count[GEM_NMEMCAT];       /* blocks held in each category */
+  } gemMemReport;
+
+
+/*
+ * the timed phases of a profile (built with GEM_PROFILE defined)
+ */
+#define GEM_PTESSEL     0       /* gem_kernelTessel */
+#define GEM_PDEFQUILT   1       /* the method's gemDefineQuilt */
+#define GEM_PCHECKQUILT 2       /* gem_checkQuilt */
+#define GEM_PPARAMQUILT 3       /* gem_paramQuilt -- includes the next 3 */
+#define GEM_PCREATEUV   4       /* prm_CreateUV */
+#define GEM_PSMOOTHUV   5       /* prm_SmoothUV */
+#define GEM_PBESTGRID   6       /* prm_BestGrid */
+#define GEM_PLOCATE     7       /* point location for transfers */
+#define GEM_PCONJGRAD   8       /* gem_conjGrad (conservative transfers) */
+#define GEM_NPHASE      9
+
+/*
+ * the counters of a profile
+ */
+#define GEM_CLOCATED    0       /* points located inside an element */
+#define GEM_CEXTRAP     1       /* points extrapolated from an element */
+#define GEM_CCGITER     2       /* gem_conjGrad iterations */
+#define GEM_CBCGITER    3       /* BiCG iterations (sparseBCG & ILU) */
+#define GEM_CGRIDLEVEL  4       /* prm_BestGrid refinement levels */
+#define GEM_NCOUNT      5
+
+  typedef struct {
+    long long calls[GEM_NPHASE];        /* times each phase was entered */
+    double    seconds[GEM_NPHASE];      /* wall time spent in each phase */
+    long long counts[GEM_NCOUNT];       /* the counters */
+  } gemProfile;
+
+
 
 /* Initialize GEM
  *
@@ -157,10 +232,94 @@ extern int
 gem_terminate(gemCntxt *context);       /* (in)  the context */
 
 
+/* set the number of threads
+ *
+ * Sets the number of threads used for point location, interpolation and
+ * (thread-safe kernels only) evaluation in the DReps of the Context. The 
+ * default is 1 (serial); 0 uses all of the available processors. Results 
+ * are the same as the serial ones.
+ */
+extern int
+gem_setThreads(gemCntxt *context,       /* (in)  the context */
+               int      nThread);       /* (in)  number of threads */
+
+
+/* set the memory allocator
+ *
+ * Directs the GEM storage to the functions in alloc (NULL restores malloc,
+ * realloc and free) while this Context is the last one set. Blocks are 
+ * always handed back to the allocator that made them, so the allocator 
+ * must remain valid until they are freed. Not to be called while other 
+ * threads are running GEM functions.
+ */
+extern int
+gem_setAllocator(gemCntxt     *context, /* (in)  the context */
+                /*@null@*/
+                 gemAllocator *alloc);  /* (in)  the allocator or NULL */
+
+
+/* get the memory statistics
+ *
+ * Returns the counts and the current and peak bytes of the GEM storage
+ * over all allocators. reset = 1 restarts the counts, and the peak from 
+ * the bytes now in use, after they are returned.
+ */
+extern int
+gem_getMemStats(gemCntxt    *context,   /* (in)  the context */
+                int         reset,      /* (in)  1 -- restart the counts */
+                gemMemStats *stats);    /* (out) the statistics */
+
+
+/* get the profile
+ *
+ * Returns the time spent in the hot phases of the DRep operations made in
+ * the Context and the work counters. Phases run on several threads add up
+ * the time of each. The profile is selected process wide (like the 
+ * allocator) as each DRep operation starts, so when Contexts are used
+ * concurrently on different threads the work is credited to whichever
+ * selected last. Only available when GEM is built with GEM_PROFILE
+ * defined (GEM_UNSUPPORTED otherwise).
+ */
+extern int
+gem_getProfile(gemCntxt   *context,     /* (in)  the context */
+               int        reset,        /* (in)  1 -- restart the profile */
+               gemProfile *profile);    /* (out) the profile */
+
+
+/* trace the phases
+ *
+ * Starts recording each phase of the Context as it happens. A NULL filename
+ * (or gem_terminate) stops the recording and writes the events (with the
+ * counters) to the file given at the start in the Chrome trace JSON format
+ * (for chrome://tracing or Perfetto). Only available when GEM is built with
+ * GEM_PROFILE defined.
+ */
+extern int
+gem_traceProfile(gemCntxt   *context,   /* (in)  the context */
+                 /*@null@*/
+                 const char *filename); /* (in)  file to write or NULL */
+
+
+/* report the memory held by an object
+ *
+ * Returns the bytes and blocks held by a Context (everything in it), a 
+ * Model (with its BReps), a BRep or a DRep, by category. For a DRep, 
+ * ibound > 0 reports only that Bound. Quilts are allocated by their 
+ * disMethod so their bytes are sized from the array lengths. Storage that
+ * is in use (see gem_getMemStats) but not in any Context has leaked or is 
+ * held by the caller.
+ */
+extern int
+gem_memoryReport(void         *gemObj,  /* (in)  Context, Model, BRep or DRep */
+                 int          ibound,   /* (in)  Bound (DRep only) or 0 */
+                 gemMemReport *report); /* (out) the report */
+
+
 /* make an empty (static) non-parametric model
  *
  * Returns an empty static (non-parametric) Model in the specified 
- * Context. Use gem_add2Model to populate the Model from existing BReps.
+ * Context. Use gem_add2Model to populate the Model from existing BReps
+ * (or gem_addBReps2Model to add many at once).
  */
 extern int
 gem_staticModel(gemCntxt *cntxt,        /* (in)  context */
@@ -18,3 +18,22 @@ extern /*@null@*/ /*@only@*/ void *gem_reallocate(/*@null@*/ /*@only@*/
 
 extern /*@null@*/ /*@only@*/ char *gem_strdup(/*@null@*/ const char *str);
 
+
+
+/* scratch arena -- a bump allocator over a chain of gem_allocate blocks */
+  typedef struct gemArena {
+    /*@null@*/ void *block;     /* the newest block (NULL -- empty) */
+    size_t          used;       /* bytes taken from the newest block */
+    size_t          high;       /* the most bytes the chain has spanned */
+  } gemArena;
+
+extern void gem_arenaInit(gemArena *arena);
+
+extern size_t gem_arenaMark(gemArena *arena);
+
+extern /*@null@*/ /*@out@*/ void *gem_arenaAlloc(gemArena *arena,
+                                                 size_t nbytes);
+
+extern void gem_arenaRelease(gemArena *arena, size_t mark);
+
+extern void gem_arenaFree(gemArena *arena);
@@ -96,6 +96,7 @@ typedef struct gemModel {
   char     *location;           /* location of model on disk */
   char     *modeler;            /* CAD system / Kernel */
   int      nBRep;		/* number of BReps */
+  int      mBRep;		/* number of allocated BRep slots */
   gemBRep  **BReps;		/* pointer to list of BRep objs */
   int      nParams;		/* number of Parameters */
   gemParam *Params;		/* the Parameters */
@@ -118,6 +119,21 @@ gem_add2Model(gemModel *model,          /* (in)  the model to add the BRep */
               /*@null@*/
               double   xform[]);        /* (in)  transformation mat or NULL */
 
+
+/* add BReps to a non-parametric model
+ *
+ * Adds copies of the nBRep BReps to the static Model in one step. If xforms
+ * is not NULL, it holds 12 values for each BRep that transform it to its new
+ * position/orientation. Tessellations and Bounds already in the Model's DReps
+ * are kept -- the DReps are extended with the (untessellated) new BReps.
+ */
+extern int
+gem_addBReps2Model(gemModel *model,     /* (in)  the model to add the BReps */
+                   int      nBRep,      /* (in)  the number of BReps */
+                   gemBRep  *BReps[],   /* (in)  pointers to added BReps */
+                   /*@null@*/
+                   double   xforms[]);  /* (in)  12*nBRep transforms or NULL */
+
            
 /* save a model
  *
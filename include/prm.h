@@ -121,6 +121,9 @@ typedef struct {
     gridCell         *cell;             /* array  of Cells */
     int              nknt;              /* number of Knots */
     double           *knot;             /* array  of Knots */
+    int              *lcel;             /* finest Cell in each lattice slot
+                                           (NULL unless the finest Cells
+                                           form a uniform lattice) */
 } gridTree;
 
 /**********************************************************************/
@@ -322,6 +325,8 @@ prm_BestGrid(int      nvrt,             /* (in)   number of Vertices */
                                         /*        = 1  periodic in U */
                                         /*        = 2  periodic in V */
   /*@null@*/ int      ppnts[],          /* (in)   indices of periodic points */
+             int      nthread,          /* (in)   threads for the U & V trials
+                                                  (1 runs them serially) */
              int      *nu,              /* (in)   limit on nu if > 0 */
                                         /* (out)  number of Knots in U-dirn */
              int      *nv,              /* (in)   limit on nv if > 0 */
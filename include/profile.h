@@ -0,0 +1,35 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Profile Functions Include
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+/* the spans and counters compile away unless GEM_PROFILE is defined */
+#ifdef GEM_PROFILE
+
+extern void gem_profSelect(/*@null@*/ gemCntxt *cntxt);
+
+extern void gem_profBegin(int phase);
+
+extern void gem_profEnd(int phase);
+
+extern void gem_profCount(int counter, long long n);
+
+#define GEM_PROFSELECT(c)   gem_profSelect(c)
+#define GEM_PROFBEG(p)      gem_profBegin(p)
+#define GEM_PROFEND(p)      gem_profEnd(p)
+#define GEM_PROFCOUNT(c, n) gem_profCount(c, n)
+
+#else
+
+#define GEM_PROFSELECT(c)
+#define GEM_PROFBEG(p)
+#define GEM_PROFEND(p)
+#define GEM_PROFCOUNT(c, n)
+
+#endif
@@ -0,0 +1 @@
+nmake /e /f NMakefile %1
@@ -0,0 +1,159 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Copy Functions -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#define snprintf _snprintf
+#endif
+
+#include "gem.h"
+#include "memory.h"
+#include "mock.h"
+
+
+  extern int  gem_mockBody(mockBody *mb, /*@null@*/ char *bID, gemBRep *brep);
+  extern int  gem_invertXform(double *xform, double *invXform);
+  extern void gem_releaseBRep(/*@only@*/ gemBRep *brep);
+
+
+/* c = a*b for 3x4 placement matrices */
+static void
+gem_mockMult(double *a, double *b, double *c)
+{
+  int i, j;
+
+  for (i = 0; i < 3; i++) {
+    for (j = 0; j < 4; j++)
+      c[4*i+j] = a[4*i  ]*b[j  ] + a[4*i+1]*b[j+4] + a[4*i+2]*b[j+8];
+    c[4*i+3] += a[4*i+3];
+  }
+}
+
+
+int
+gem_kernelDelete(gemID handle)
+{
+  gem_free(handle.ident.ptr);
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_kernelCopyMM(gemModel *model)
+{
+  int       i;
+  mockModel *mm, *copy;
+
+  mm = (mockModel *) model->handle.ident.ptr;
+  if (mm == NULL) return GEM_SUCCESS;
+
+  copy = (mockModel *) gem_allocate(sizeof(mockModel));
+  if (copy == NULL) return GEM_ALLOC;
+  copy->prims = (mockPrim *) gem_allocate(mm->nprim*sizeof(mockPrim));
+  if (copy->prims == NULL) {
+    gem_free(copy);
+    return GEM_ALLOC;
+  }
+  copy->nprim = mm->nprim;
+  for (i = 0; i < mm->nprim; i++) copy->prims[i] = mm->prims[i];
+
+  model->handle.ident.ptr = copy;
+  for (i = 0; i < model->nBRep; i++)
+    model->BReps[i]->phandle = model->handle;
+  for (i = 0; i < model->nParams; i++)
+    model->Params[i].handle.ident.ptr = copy;
+  for (i = 0; i < model->nBranches; i++)
+    model->Branches[i].handle.ident.ptr = copy;
+
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_kernelCopy(gemBRep *brep, /*@null@*/ double *xform, gemBRep **newBRep)
+{
+  int      i, stat, ibody, alen;
+  char     *bID, *name;
+  double   inst[12];
+  mockBody *mb, *copy;
+  gemBRep  *nbrep;
+  gemModel *model;
+
+  *newBRep =  NULL;
+  if (brep == NULL) return GEM_NULLOBJ;
+  if (brep->magic != GEM_MBREP) return GEM_BADBREP;
+  mb = (mockBody *) brep->body->handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+
+  /* the copy owns its primitive with the instance placement folded in */
+  copy = (mockBody *) gem_allocate(sizeof(mockBody));
+  if (copy == NULL) return GEM_ALLOC;
+  copy->type    = mb->type;
+  copy->size[0] = mb->size[0];
+  copy->size[1] = mb->size[1];
+  copy->size[2] = mb->size[2];
+  if (brep->ibranch == 0) {
+    for (i = 0; i < 12; i++) inst[i] = mb->xform[i];
+  } else {
+    gem_mockMult(brep->xform, mb->xform, inst);
+  }
+  if (xform == NULL) {
+    for (i = 0; i < 12; i++) copy->xform[i] = inst[i];
+  } else {
+    gem_mockMult(xform, inst, copy->xform);
+  }
+  stat = gem_invertXform(copy->xform, copy->invXform);
+  if (stat != GEM_SUCCESS) {
+    gem_free(copy);
+    return stat;
+  }
+
+  nbrep = (gemBRep *) gem_allocate(sizeof(gemBRep));
+  if (nbrep == NULL) {
+    gem_free(copy);
+    return GEM_ALLOC;
+  }
+  nbrep->magic   = GEM_MBREP;
+  nbrep->omodel  = NULL;
+  nbrep->phandle = brep->phandle;
+  nbrep->ibranch = 0;
+  nbrep->inumber = 0;
+  nbrep->body    = NULL;
+  model = brep->omodel;
+  for (ibody = 1; ibody <= model->nBRep; ibody++)
+    if (model->BReps[ibody-1] == brep) break;
+
+  name = model->location;
+  if (name == NULL) name = "CopiedModel";
+  alen = strlen(name)+11;
+  bID  = (char *) gem_allocate(alen*sizeof(char));
+  if (bID == NULL) {
+    gem_free(nbrep);
+    gem_free(copy);
+    return GEM_ALLOC;
+  }
+  alen--;
+  snprintf(bID, alen, "%s:%d", name, ibody);
+  bID[alen] = 0;
+
+  stat = gem_mockBody(copy, bID, nbrep);
+  gem_free(bID);
+  if (stat != GEM_SUCCESS) {
+    gem_releaseBRep(nbrep);
+    gem_free(copy);
+    return stat;
+  }
+
+  *newBRep = nbrep;
+  return GEM_SUCCESS;
+}
@@ -0,0 +1,199 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Evaluation Functions -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gem.h"
+#include "mock.h"
+
+
+int
+gem_kernelEval(gemDRep *drep, gemPair bface, int npts, double *uvs,
+               double *xyzs)
+{
+  int      i;
+  gemModel *mdl;
+  gemBRep  *brep;
+  mockBody *mb;
+
+  mdl  = drep->model;
+  brep = mdl->BReps[bface.BRep-1];
+  mb   = (mockBody *) brep->body->handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+  if ((bface.index < 1) || (bface.index > brep->body->nface))
+    return GEM_BADINDEX;
+
+  for (i = 0; i < npts; i++)
+    mock_evalFace(mb, bface.index, &uvs[2*i], &xyzs[3*i]);
+
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_kernelInvEval(gemDRep *drep, gemPair bface, int npts, double *xyzs,
+                  double *uvs)
+{
+  int      i;
+  gemModel *mdl;
+  gemBRep  *brep;
+  mockBody *mb;
+
+  mdl  = drep->model;
+  brep = mdl->BReps[bface.BRep-1];
+  mb   = (mockBody *) brep->body->handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+  if ((bface.index < 1) || (bface.index > brep->body->nface))
+    return GEM_BADINDEX;
+
+  for (i = 0; i < npts; i++)
+    mock_invEvalFace(mb, bface.index, &xyzs[3*i], &uvs[2*i]);
+
+  return GEM_SUCCESS;
+}
+
+
+static int
+gem_mockQuiltFace(gemDRep *drep, int bound, int vs, int j, mockBody **mb,
+                  double **uv)
+{
+  int      b, k, m;
+  gemPair  bface;
+  gemBRep  *brep;
+
+  b = bound - 1;
+  if (drep->bound[b].VSet[vs-1].quilt->points[j].nFaces > 2) {
+    k = drep->bound[b].VSet[vs-1].quilt->points[j].findices.multi[0]-1;
+  } else {
+    k = drep->bound[b].VSet[vs-1].quilt->points[j].findices.faces[0]-1;
+  }
+  m     = drep->bound[b].VSet[vs-1].quilt->faceUVs[k].owner-1;
+  *uv   = drep->bound[b].VSet[vs-1].quilt->faceUVs[k].uv;
+  bface = drep->bound[b].VSet[vs-1].quilt->bfaces[m];
+  brep  = drep->model->BReps[bface.BRep-1];
+  *mb   = (mockBody *) brep->body->handle.ident.ptr;
+  return bface.index;
+}
+
+
+int
+gem_kernelEvalDs(gemDRep *drep, int bound, int vs, double *d1, double *d2)
+{
+  int      j, face;
+  double   *uv;
+  mockBody *mb;
+
+  if (drep->bound[bound-1].VSet[vs-1].quilt == NULL) return GEM_NOTPARAMBND;
+
+  for (j = 0; j < drep->bound[bound-1].VSet[vs-1].quilt->nPoints; j++) {
+    face = gem_mockQuiltFace(drep, bound, vs, j, &mb, &uv);
+    if (mb == NULL) return GEM_NULLOBJ;
+    mock_derivFace(mb, face, uv, &d1[6*j], &d2[9*j]);
+  }
+
+  return GEM_SUCCESS;
+}
+
+
+static void
+gem_mockUnit(double *vec)
+{
+  double len;
+
+  len = sqrt(vec[0]*vec[0] + vec[1]*vec[1] + vec[2]*vec[2]);
+  if (len == 0.0) return;
+  vec[0] /= len;
+  vec[1] /= len;
+  vec[2] /= len;
+}
+
+
+/* principal curvatures & directions from the derivatives (the sign is
+ *   that of the outward normal) -- isocurve directions when umbilic */
+static void
+gem_mockCurvCalc(double *d1, double *d2, double *curv)
+{
+  int    i, k;
+  double norm[3], g11, g12, g22, b11, b12, b22, a, b, c, disc, kk, ud, vd;
+
+  norm[0] = d1[1]*d1[5] - d1[2]*d1[4];
+  norm[1] = d1[2]*d1[3] - d1[0]*d1[5];
+  norm[2] = d1[0]*d1[4] - d1[1]*d1[3];
+  gem_mockUnit(norm);
+  g11 = g12 = g22 = b11 = b12 = b22 = 0.0;
+  for (i = 0; i < 3; i++) {
+    g11 += d1[i  ]*d1[i  ];
+    g12 += d1[i  ]*d1[i+3];
+    g22 += d1[i+3]*d1[i+3];
+    b11 += norm[i]*d2[i  ];
+    b12 += norm[i]*d2[i+3];
+    b22 += norm[i]*d2[i+6];
+  }
+  a    =   g11*g22 - g12*g12;
+  b    = -(g11*b22 + b11*g22 - 2.0*g12*b12);
+  c    =   b11*b22 - b12*b12;
+  disc = b*b - 4.0*a*c;
+  if (disc < 0.0) disc = 0.0;
+
+  for (k = 0; k < 2; k++) {
+    for (i = 0; i < 3; i++) curv[4*k+1+i] = d1[3*k+i];
+    curv[4*k] = 0.0;
+    if (a == 0.0) continue;
+    kk = (k == 0) ? (-b + sqrt(disc))/(2.0*a) : (-b - sqrt(disc))/(2.0*a);
+    curv[4*k] = kk;
+    if (disc == 0.0) continue;
+    ud =  (b12 - kk*g12);
+    vd = -(b11 - kk*g11);
+    if ((ud == 0.0) && (vd == 0.0)) {
+      ud =  (b22 - kk*g22);
+      vd = -(b12 - kk*g12);
+    }
+    for (i = 0; i < 3; i++) curv[4*k+1+i] = d1[i]*ud + d1[3+i]*vd;
+  }
+  gem_mockUnit(&curv[1]);
+  gem_mockUnit(&curv[5]);
+}
+
+
+int
+gem_kernelCurvature(gemDRep *drep, int bound, int vs, double *curv)
+{
+  int      i, j, face;
+  double   d1[6], d2[9], *uv, x[3];
+  mockBody *mb;
+
+  if (drep->bound[bound-1].VSet[vs-1].quilt == NULL) return GEM_NOTPARAMBND;
+
+  for (j = 0; j < drep->bound[bound-1].VSet[vs-1].quilt->nPoints; j++) {
+    face = gem_mockQuiltFace(drep, bound, vs, j, &mb, &uv);
+    if (mb == NULL) return GEM_NULLOBJ;
+    mock_derivFace(mb, face, uv, d1, d2);
+    gem_mockCurvCalc(d1, d2, &curv[8*j]);
+    if ((mb->type != MOCK_SPHERE) || (curv[8*j] != 0.0)) continue;
+
+    /* the poles of a sphere -- umbilic along the placed x & y */
+    for (i = 0; i < 3; i++) x[i] = mb->xform[4*i];
+    gem_mockUnit(x);
+    curv[8*j  ] = curv[8*j+4] = -1.0/mb->size[0];
+    curv[8*j+1] = x[0];
+    curv[8*j+2] = x[1];
+    curv[8*j+3] = x[2];
+    for (i = 0; i < 3; i++) x[i] = mb->xform[4*i+1];
+    gem_mockUnit(x);
+    curv[8*j+5] = x[0];
+    curv[8*j+6] = x[1];
+    curv[8*j+7] = x[2];
+  }
+
+  return GEM_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Initialization Function -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gem.h"
+
+  static int mock_open = 0;
+
+
+int
+gem_kernelInit()
+{
+  if (mock_open != 0) return GEM_BADCONTEXT;
+
+  printf("\n GEM Info: Using the Mock analytic kernel\n\n");
+  mock_open = 1;
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_kernelThreadSafe()
+{
+  /* all geometry is closed-form and only the target TRep is written */
+  return 1;
+}
+
+
+/*@null@*/ /*@observer@*/ const char *
+gem_kernelError(int code)
+{
+  return NULL;
+}
+
+
+int
+gem_kernelClose()
+{
+  mock_open = 0;
+  return GEM_SUCCESS;
+}
@@ -0,0 +1,541 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Load Function -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifndef WIN32
+#include <strings.h>
+#else
+#define snprintf    _snprintf
+#define strcasecmp  _stricmp
+#endif
+
+#include "gem.h"
+#include "memory.h"
+#include "mock.h"
+
+
+  extern void gem_releaseBRep(/*@only@*/ gemBRep *brep);
+  extern void gem_clrModel(/*@only@*/ gemModel *model);
+
+
+static void
+gem_matIdent(double *xform)
+{
+  int i;
+
+  for (i = 0; i < 12; i++) xform[i] = 0.0;
+  xform[0] = xform[5] = xform[10] = 1.0;
+}
+
+
+/*
+ * fills the GEM Body for a mock primitive -- all handles point at the
+ *   primitive with the index being that of the entity
+ */
+int
+gem_mockBody(mockBody *mb, /*@null@*/ char *bID, gemBRep *brep)
+{
+  int      i, j, m, len, stat;
+  gemID    gid;
+  gemBody  *body;
+  mockTopo topo;
+
+  stat = mock_topology(mb->type, &topo);
+  if (stat != GEM_SUCCESS) return stat;
+  gid.index     = 0;
+  gid.ident.ptr = mb;
+
+  body = (gemBody *) gem_allocate(sizeof(gemBody));
+  if (body == NULL) return GEM_ALLOC;
+  body->handle = gid;
+  body->nnode  = 0;
+  body->nodes  = NULL;
+  body->nedge  = 0;
+  body->edges  = NULL;
+  body->nloop  = 0;
+  body->loops  = NULL;
+  body->nface  = 0;
+  body->faces  = NULL;
+  body->nshell = 0;
+  body->shells = NULL;
+  body->attr   = NULL;
+  body->type   = topo.btype;
+  brep->body   = body;
+  gem_matIdent(brep->xform);
+  gem_matIdent(brep->invXform);
+  mock_bbox(mb, body->box);
+
+  /* make the edges */
+  body->edges = (gemEdge *) gem_allocate(topo.nedge*sizeof(gemEdge));
+  if (body->edges == NULL) return GEM_ALLOC;
+  body->nedge = topo.nedge;
+  for (i = 0; i < topo.nedge; i++) {
+    gid.index                 = i+1;
+    body->edges[i].handle     = gid;
+    mock_edgeRange(mb, i+1, body->edges[i].tlimit);
+    body->edges[i].nodes[0]   = topo.edges[i].nodes[0];
+    body->edges[i].nodes[1]   = topo.edges[i].nodes[1];
+    body->edges[i].faces[0]   = body->edges[i].faces[1] = 0;
+    body->edges[i].attr       = NULL;
+  }
+
+  /* make the nodes -- at the ends of the edges */
+  body->nodes = (gemNode *) gem_allocate(topo.nnode*sizeof(gemNode));
+  if (body->nodes == NULL) return GEM_ALLOC;
+  body->nnode = topo.nnode;
+  for (i = 0; i < topo.nnode; i++) {
+    gid.index             = i+1;
+    body->nodes[i].handle = gid;
+    body->nodes[i].attr   = NULL;
+    for (j = 0; j < topo.nedge; j++) {
+      if (topo.edges[j].nodes[0] == i+1) {
+        mock_evalEdge(mb, j+1, body->edges[j].tlimit[0],
+                      body->nodes[i].xyz);
+        break;
+      }
+      if (topo.edges[j].nodes[1] == i+1) {
+        mock_evalEdge(mb, j+1, body->edges[j].tlimit[1],
+                      body->nodes[i].xyz);
+        break;
+      }
+    }
+  }
+
+  /* make the loops -- one per face, counterclockwise in uv */
+  body->loops = (gemLoop *) gem_allocate(topo.nface*sizeof(gemLoop));
+  if (body->loops == NULL) return GEM_ALLOC;
+  for (i = 0; i < topo.nface; i++) {
+    body->loops[i].edges = NULL;
+    body->loops[i].attr  = NULL;
+  }
+  body->nloop = topo.nface;
+  for (i = 0; i < topo.nface; i++) {
+    gid.index             = i+1;
+    body->loops[i].handle = gid;
+    body->loops[i].type   = 0;
+    body->loops[i].face   = i+1;
+    body->loops[i].edges  = (int *)
+                            gem_allocate(topo.faces[i].nedge*sizeof(int));
+    if (body->loops[i].edges == NULL) return GEM_ALLOC;
+    body->loops[i].nedges = topo.faces[i].nedge;
+    for (j = 0; j < topo.faces[i].nedge; j++) {
+      m = topo.faces[i].loop[j];
+      body->loops[i].edges[j] = m;
+      if (m < 0) {
+        body->edges[-m-1].faces[0] = i+1;
+      } else {
+        body->edges[ m-1].faces[1] = i+1;
+      }
+    }
+  }
+
+  /* make the faces */
+  len = 0;
+  if (bID != NULL) len = strlen(bID);
+  body->faces = (gemFace *) gem_allocate(topo.nface*sizeof(gemFace));
+  if (body->faces == NULL) return GEM_ALLOC;
+  for (i = 0; i < topo.nface; i++) {
+    body->faces[i].loops = NULL;
+    body->faces[i].ID    = NULL;
+    body->faces[i].attr  = NULL;
+  }
+  body->nface = topo.nface;
+  for (i = 0; i < topo.nface; i++) {
+    gid.index               = i+1;
+    body->faces[i].handle   = gid;
+    mock_faceBox(mb, i+1, body->faces[i].uvbox);
+    body->faces[i].norm     = 1;
+    body->faces[i].loops    = (int *) gem_allocate(sizeof(int));
+    if (body->faces[i].loops == NULL) return GEM_ALLOC;
+    body->faces[i].nloops   = 1;
+    body->faces[i].loops[0] = i+1;
+    body->faces[i].ID = (char *) gem_allocate((len+10)*sizeof(char));
+    if (body->faces[i].ID == NULL) return GEM_ALLOC;
+    if (bID == NULL) {
+      snprintf(body->faces[i].ID, 10, "%d", i+1);
+    } else {
+      snprintf(body->faces[i].ID, len+10, "%s:%d", bID, i+1);
+    }
+  }
+
+  /* make the shell */
+  body->shells = (gemShell *) gem_allocate(sizeof(gemShell));
+  if (body->shells == NULL) return GEM_ALLOC;
+  body->shells[0].faces  = NULL;
+  body->shells[0].attr   = NULL;
+  body->nshell           = 1;
+  gid.index              = 1;
+  body->shells[0].handle = gid;
+  body->shells[0].type   = 0;
+  body->shells[0].faces  = (int *) gem_allocate(topo.nface*sizeof(int));
+  if (body->shells[0].faces == NULL) return GEM_ALLOC;
+  body->shells[0].nfaces = topo.nface;
+  for (i = 0; i < topo.nface; i++) body->shells[0].faces[i] = i+1;
+
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * parses a single primitive of the location -- name[(s0,...)][*count]
+ */
+static int
+gem_mockParse(char *token, mockPrim *prim)
+{
+  int  i, n, ndim;
+  char *ptr, *end;
+
+  prim->count = 1;
+  n = mock_lookup(token, &prim->type, &ndim, prim->size);
+  if (n == 0) return GEM_BADNAME;
+  ptr = &token[n];
+
+  if (*ptr == '(') {
+    ptr++;
+    for (i = 0; i < ndim; i++) {
+      prim->size[i] = strtod(ptr, &end);
+      if (end == ptr) return GEM_BADVALUE;
+      ptr = end;
+      if (i == ndim-1) break;
+      if (*ptr != ',') return GEM_BADVALUE;
+      ptr++;
+    }
+    if (*ptr != ')') return GEM_BADNAME;
+    ptr++;
+  }
+  if (mock_checkSize(prim->type, prim->size) != GEM_SUCCESS)
+    return GEM_BADVALUE;
+  if (*ptr == '*') {
+    prim->count = atoi(&ptr[1]);
+    if (prim->count < 1) return GEM_BADVALUE;
+    ptr++;
+    while ((*ptr >= '0') && (*ptr <= '9')) ptr++;
+  }
+  if (*ptr != 0) return GEM_BADNAME;
+
+  return GEM_SUCCESS;
+}
+
+
+void
+gem_mockCleanup(int nBRep, /*@only@*/ gemBRep **BReps)
+{
+  int i;
+
+  for (i = 0; i < nBRep; i++) {
+    if (BReps[i] == NULL) continue;
+    if (BReps[i]->body == NULL) {
+      gem_free(BReps[i]);
+      continue;
+    }
+    if (BReps[i]->inumber == 0) gem_free(BReps[i]->body->handle.ident.ptr);
+    gem_releaseBRep(BReps[i]);
+  }
+  gem_free(BReps);
+}
+
+
+/*
+ * makes the BReps of the primitives -- each active primitive makes a Body
+ *   owned by its first BRep, "count" adds instances of that Body placed
+ *   side by side in x. the primitives are stacked in y (suppressed ones keep
+ *   their place) and the Face IDs start with the Branch name (when given)
+ */
+int
+gem_mockBReps(int nprim, mockPrim *prims, /*@null@*/ gemFeat *branches,
+              gemID phandle, int *nBRep, gemBRep ***BReps)
+{
+  int      i, j, k, n, stat, nbrep;
+  double   box[6], offset, space;
+  char     bID[32], *ID;
+  gemBRep  **breps;
+  mockBody *mb;
+
+  *nBRep = 0;
+  *BReps = NULL;
+  for (nbrep = j = 0; j < nprim; j++) {
+    if (branches != NULL)
+      if (branches[j].sflag == GEM_SUPPRESSED) continue;
+    nbrep += prims[j].count;
+  }
+  if (nbrep == 0) return GEM_SUCCESS;
+
+  breps = (gemBRep **) gem_allocate(nbrep*sizeof(gemBRep *));
+  if (breps == NULL) return GEM_ALLOC;
+  for (i = 0; i < nbrep; i++) breps[i] = NULL;
+
+  offset = 0.0;
+  for (n = j = 0; j < nprim; j++) {
+    stat = GEM_ALLOC;
+    mb   = (mockBody *) gem_allocate(sizeof(mockBody));
+    if (mb == NULL) goto cleanup;
+    mb->type    = prims[j].type;
+    mb->size[0] = prims[j].size[0];
+    mb->size[1] = prims[j].size[1];
+    mb->size[2] = prims[j].size[2];
+    gem_matIdent(mb->xform);
+    gem_matIdent(mb->invXform);
+    mock_bbox(mb, box);
+    space = 0.0;
+    for (i = 0; i < 3; i++)
+      if (box[i+3]-box[i] > space) space = box[i+3] - box[i];
+    space *= 1.5;
+    /* the low corner of the bounding box at (0,offset) */
+    mb->xform[3]    = 0.0 - box[0];
+    mb->invXform[3] = box[0];
+    mb->xform[7]    = offset - box[1];
+    mb->invXform[7] = box[1] - offset;
+    offset         += space;
+    if (branches != NULL)
+      if (branches[j].sflag == GEM_SUPPRESSED) {
+        gem_free(mb);
+        continue;
+      }
+
+    for (k = 0; k < prims[j].count; k++, n++) {
+      breps[n] = (gemBRep *) gem_allocate(sizeof(gemBRep));
+      if (breps[n] == NULL) {
+        if (k == 0) gem_free(mb);
+        goto cleanup;
+      }
+      breps[n]->magic   = GEM_MBREP;
+      breps[n]->omodel  = NULL;
+      breps[n]->phandle = phandle;
+      breps[n]->ibranch = 0;
+      breps[n]->inumber = 0;
+      breps[n]->body    = NULL;
+      if (k == 0) {
+        ID = bID;
+        if (branches != NULL) {
+          ID = branches[j].name;
+        } else {
+          snprintf(bID, 32, "%d", n+1);
+        }
+        stat = gem_mockBody(mb, ID, breps[n]);
+        if (stat != GEM_SUCCESS) {
+          if (breps[n]->body == NULL) gem_free(mb);
+          goto cleanup;
+        }
+      } else {
+        breps[n]->ibranch     = j+1;
+        breps[n]->inumber     = k;
+        breps[n]->body        = breps[n-k]->body;
+        gem_matIdent(breps[n]->xform);
+        gem_matIdent(breps[n]->invXform);
+        breps[n]->xform[3]    =  k*space;
+        breps[n]->invXform[3] = -k*space;
+      }
+    }
+  }
+
+  *nBRep = nbrep;
+  *BReps = breps;
+  return GEM_SUCCESS;
+
+cleanup:
+  gem_mockCleanup(nbrep, breps);
+  return stat;
+}
+
+
+/* a Branch & a fixed length Param holding the dimensions per primitive */
+static int
+gem_mockMaster(mockModel *mm, gemModel *mdl)
+{
+  int      i, j, ndim;
+  char     name[32];
+  gemFeat  *branches;
+  gemParam *params;
+
+  branches = (gemFeat *) gem_allocate(mm->nprim*sizeof(gemFeat));
+  if (branches == NULL) return GEM_ALLOC;
+  for (i = 0; i < mm->nprim; i++) {
+    branches[i].name             = NULL;
+    branches[i].handle.index     = i+1;
+    branches[i].handle.ident.ptr = mm;
+    branches[i].sflag            = GEM_ACTIVE;
+    branches[i].changed          = 0;
+    branches[i].branchType       = NULL;
+    branches[i].nParents         = 0;
+    branches[i].parents.pnode    = 0;
+    branches[i].nChildren        = 0;
+    branches[i].children.node    = 0;
+    branches[i].attr             = NULL;
+  }
+  mdl->nBranches = mm->nprim;
+  mdl->Branches  = branches;
+
+  params = (gemParam *) gem_allocate(mm->nprim*sizeof(gemParam));
+  if (params == NULL) return GEM_ALLOC;
+  for (i = 0; i < mm->nprim; i++) {
+    params[i].name             = NULL;
+    params[i].handle.index     = i+1;
+    params[i].handle.ident.ptr = mm;
+    params[i].type             = GEM_REAL;
+    params[i].order            = 0;
+    params[i].bitflag          = 2;
+    params[i].len              = 1;
+    params[i].vals.real        = 0.0;
+    params[i].bnds.rlims[0]    = 0.0;
+    params[i].bnds.rlims[1]    = 0.0;
+    params[i].attr             = NULL;
+    params[i].changed          = 0;
+  }
+  mdl->nParams = mm->nprim;
+  mdl->Params  = params;
+
+  for (i = 0; i < mm->nprim; i++) {
+    snprintf(name, 32, "%s%d", mock_name(mm->prims[i].type, &ndim), i+1);
+    branches[i].name       = gem_strdup(name);
+    branches[i].branchType = gem_strdup(mock_name(mm->prims[i].type, NULL));
+    params[i].name         = gem_strdup(name);
+    if ((branches[i].name == NULL) || (branches[i].branchType == NULL) ||
+        (params[i].name   == NULL)) return GEM_ALLOC;
+    if (ndim == 1) {
+      params[i].vals.real = mm->prims[i].size[0];
+    } else {
+      params[i].vals.reals = (double *) gem_allocate(ndim*sizeof(double));
+      if (params[i].vals.reals == NULL) return GEM_ALLOC;
+      params[i].len = ndim;
+      for (j = 0; j < ndim; j++)
+        params[i].vals.reals[j] = mm->prims[i].size[j];
+    }
+  }
+
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * the location is a list of primitives (separated by blanks or semicolons)
+ *   -- box(dx,dy,dz), plane(dx,dy), cylinder(r,h), sphere(r) or torus(R,r)
+ *   with an optional "*count" for that many instances. a leading "param"
+ *   makes a parametric model: each primitive is a Branch (which can be
+ *   suppressed) and a Param holding its dimensions
+ */
+int
+gem_kernelLoad(gemCntxt *gem_cntxt, /*@null@*/ char *server,
+               char *name, gemModel **model)
+{
+  int       i, stat, param, nprim, nBRep;
+  char      *copy, *token;
+  gemID     gid;
+  gemModel  *mdl, *prev;
+  gemBRep   **BReps;
+  mockPrim  *prims;
+  mockModel *mm;
+
+  *model = NULL;
+  if (gem_cntxt == NULL) return GEM_NULLOBJ;
+  if (gem_cntxt->magic != GEM_MCONTEXT) return GEM_BADCONTEXT;
+  if (name == NULL) return GEM_NULLNAME;
+
+  /* count the primitives */
+  copy = gem_strdup(name);
+  if (copy == NULL) return GEM_ALLOC;
+  param = nprim = 0;
+  token = strtok(copy, " \t\n;");
+  if (token != NULL)
+    if (strcasecmp(token, "param") == 0) {
+      param = 1;
+      token = strtok(NULL, " \t\n;");
+    }
+  for (; token != NULL; token = strtok(NULL, " \t\n;")) nprim++;
+  gem_free(copy);
+  if (nprim == 0) return GEM_BADNAME;
+
+  prims = (mockPrim *) gem_allocate(nprim*sizeof(mockPrim));
+  if (prims == NULL) return GEM_ALLOC;
+  copy = gem_strdup(name);
+  if (copy == NULL) {
+    gem_free(prims);
+    return GEM_ALLOC;
+  }
+  token = strtok(copy, " \t\n;");
+  if (param == 1) token = strtok(NULL, " \t\n;");
+  for (i = 0; i < nprim; i++) {
+    stat = gem_mockParse(token, &prims[i]);
+    if (stat != GEM_SUCCESS) {
+      gem_free(copy);
+      gem_free(prims);
+      return stat;
+    }
+    token = strtok(NULL, " \t\n;");
+  }
+  gem_free(copy);
+
+  /* make the GEM model */
+  mm            = NULL;
+  gid.index     = 0;
+  gid.ident.ptr = NULL;
+  if (param == 1) {
+    mm = (mockModel *) gem_allocate(sizeof(mockModel));
+    if (mm == NULL) {
+      gem_free(prims);
+      return GEM_ALLOC;
+    }
+    mm->nprim     = nprim;
+    mm->prims     = prims;
+    gid.index     = 1;
+    gid.ident.ptr = mm;
+  }
+  mdl = (gemModel *) gem_allocate(sizeof(gemModel));
+  if (mdl == NULL) {
+    gem_free(mm);
+    gem_free(prims);
+    return GEM_ALLOC;
+  }
+
+  mdl->magic     = GEM_MMODEL;
+  mdl->handle    = gid;
+  mdl->nonparam  = (param == 1) ? 0 : 1;
+  mdl->server    = gem_strdup(server);
+  mdl->location  = gem_strdup(name);
+  mdl->modeler   = gem_strdup("Mock");
+  mdl->nBRep     = 0;
+  mdl->mBRep     = 0;
+  mdl->BReps     = NULL;
+  mdl->nParams   = 0;
+  mdl->Params    = NULL;
+  mdl->nBranches = 0;
+  mdl->Branches  = NULL;
+  mdl->attr      = NULL;
+  mdl->prev      = (gemModel *) gem_cntxt;
+  mdl->next      = NULL;
+
+  stat = GEM_SUCCESS;
+  if (mm != NULL) stat = gem_mockMaster(mm, mdl);
+  if (stat == GEM_SUCCESS)
+    stat = gem_mockBReps(nprim, prims, mdl->Branches, gid, &nBRep, &BReps);
+  if (stat != GEM_SUCCESS) {
+    gem_clrModel(mdl);
+    gem_free(mm);
+    gem_free(prims);
+    return stat;
+  }
+  if (mm == NULL) gem_free(prims);
+  mdl->nBRep = nBRep;
+  mdl->mBRep = nBRep;
+  mdl->BReps = BReps;
+  for (i = 0; i < nBRep; i++) BReps[i]->omodel = mdl;
+
+  prev = gem_cntxt->model;
+  gem_cntxt->model = mdl;
+  if (prev != NULL) {
+    mdl->next  = prev;
+    prev->prev = gem_cntxt->model;
+  }
+
+  *model = mdl;
+  return GEM_SUCCESS;
+}
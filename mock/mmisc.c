@@ -0,0 +1,289 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Miscellaneous Functions -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "gem.h"
+#include "mock.h"
+
+
+int
+gem_kernelSave(gemModel *model, /*@null@*/ char *filename)
+{
+  if (model == NULL) return GEM_NULLOBJ;
+
+  return GEM_UNSUPPORTED;
+}
+
+
+int
+gem_kernelBRepAttr(gemID handle, int etype, char *name, int atype, int alen,
+                   /*@null@*/ int *integers, /*@null@*/ double *reals,
+                   /*@null@*/ char *string)
+{
+  if ((etype < GEM_NODE) || (etype > GEM_BREP)) return GEM_BADTYPE;
+
+  /* the attributes only live in the GEM structures */
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_kernelBranchAttr(gemID handle, int branch, char *name, int atype,
+                     int alen, /*@null@*/ int *ints, /*@null@*/ double *reals,
+                     /*@null@*/ char *string)
+{
+  /* the attributes of a parametric model only live in the GEM structures */
+  if (handle.ident.ptr == NULL) return GEM_NOTPARMTRIC;
+
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * volume, area, center of gravity & inertia (about the CG) for unit density
+ */
+int
+gem_kernelMassProps(gemID handle, int etype, double *props)
+{
+  int      i, j, d, s, a, b;
+  double   *x, sz[3], p[3], diag[3], vol, r2, h2;
+  mockBody *mb;
+
+  for (i = 0; i < 14; i++) props[i] = 0.0;
+  if ((etype < GEM_FACE) || (etype > GEM_BREP)) return GEM_BADTYPE;
+  mb = (mockBody *) handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+  x  = mb->xform;
+  for (i = 0; i < 3; i++) sz[i] = mb->size[i];
+  p[0] = p[1] = p[2] = 0.0;
+
+  if (etype == GEM_FACE) {
+    if (mb->type == MOCK_BOX) {
+      mock_boxFace(handle.index, &d, &s, &a, &b);
+      props[1] = sz[a]*sz[b];
+      p[d]     = s*sz[d];
+      p[a]     = 0.5*sz[a];
+      p[b]     = 0.5*sz[b];
+    } else if (mb->type == MOCK_PLANE) {
+      props[1] = sz[0]*sz[1];
+      p[0]     = 0.5*sz[0];
+      p[1]     = 0.5*sz[1];
+    } else if (mb->type == MOCK_CYLINDER) {
+      if (handle.index == 1) {
+        props[1] = 2.0*MOCK_PI*sz[0]*sz[1];
+        p[2]     = 0.5*sz[1];
+      } else {
+        props[1] = MOCK_PI*sz[0]*sz[0];
+        if (handle.index == 3) p[2] = sz[1];
+      }
+    } else if (mb->type == MOCK_SPHERE) {
+      props[1] = 4.0*MOCK_PI*sz[0]*sz[0];
+    } else if (mb->type == MOCK_TORUS) {
+      props[1] = 4.0*MOCK_PI*MOCK_PI*sz[0]*sz[1];
+    }
+    mock_xform(x, p, &props[2]);
+    return GEM_SUCCESS;
+  }
+
+  /* the principal inertia in the primitive's frame */
+  diag[0] = diag[1] = diag[2] = 0.0;
+  if (mb->type == MOCK_BOX) {
+    props[0] = sz[0]*sz[1]*sz[2];
+    props[1] = 2.0*(sz[0]*sz[1] + sz[1]*sz[2] + sz[2]*sz[0]);
+    for (i = 0; i < 3; i++) p[i] = 0.5*sz[i];
+    diag[0] = props[0]*(sz[1]*sz[1] + sz[2]*sz[2])/12.0;
+    diag[1] = props[0]*(sz[0]*sz[0] + sz[2]*sz[2])/12.0;
+    diag[2] = props[0]*(sz[0]*sz[0] + sz[1]*sz[1])/12.0;
+  } else if (mb->type == MOCK_PLANE) {
+    props[1] = sz[0]*sz[1];
+    p[0]     = 0.5*sz[0];
+    p[1]     = 0.5*sz[1];
+  } else if (mb->type == MOCK_CYLINDER) {
+    r2       = sz[0]*sz[0];
+    h2       = sz[1]*sz[1];
+    vol      = MOCK_PI*r2*sz[1];
+    props[0] = vol;
+    props[1] = 2.0*MOCK_PI*sz[0]*(sz[0] + sz[1]);
+    p[2]     = 0.5*sz[1];
+    diag[0]  = diag[1] = vol*(3.0*r2 + h2)/12.0;
+    diag[2]  = 0.5*vol*r2;
+  } else if (mb->type == MOCK_SPHERE) {
+    r2       = sz[0]*sz[0];
+    vol      = 4.0*MOCK_PI*r2*sz[0]/3.0;
+    props[0] = vol;
+    props[1] = 4.0*MOCK_PI*r2;
+    diag[0]  = diag[1] = diag[2] = 0.4*vol*r2;
+  } else if (mb->type == MOCK_TORUS) {
+    r2       = sz[1]*sz[1];
+    h2       = sz[0]*sz[0];
+    vol      = 2.0*MOCK_PI*MOCK_PI*sz[0]*r2;
+    props[0] = vol;
+    props[1] = 4.0*MOCK_PI*MOCK_PI*sz[0]*sz[1];
+    diag[0]  = diag[1] = vol*(0.5*h2 + 0.625*r2);
+    diag[2]  = vol*(h2 + 0.75*r2);
+  }
+  mock_xform(x, p, &props[2]);
+
+  /* rotate the principal inertia into place */
+  for (i = 0; i < 3; i++)
+    for (j = 0; j < 3; j++)
+      props[5+3*i+j] = x[4*i  ]*diag[0]*x[4*j  ] +
+                       x[4*i+1]*diag[1]*x[4*j+1] +
+                       x[4*i+2]*diag[2]*x[4*j+2];
+
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_kernelEquivalent(int etype, gemID handle1, gemID handle2)
+{
+  if ((etype < GEM_NODE) || (etype > GEM_SHELL)) return GEM_BADTYPE;
+  if ((handle1.ident.ptr == handle2.ident.ptr) &&
+      (handle1.index     == handle2.index)) return GEM_SUCCESS;
+
+  return GEM_OUTSIDE;
+}
+
+
+int
+gem_kernelSBO(gemID src, gemID tool, /*@null@*/ double *xform, int type,
+              gemModel **model)
+{
+  *model = NULL;
+  return GEM_UNSUPPORTED;
+}
+
+
+/* the plane of a Face in model space -- unit normal and offset */
+static int
+gem_mockPlane(gemModel *model, gemPair bface, double *plane)
+{
+  int      i;
+  double   uv[2], pt[3], du[3], dv[3], pu[3], pv[3], len;
+  gemBRep  *brep;
+  mockBody *mb;
+
+  brep = model->BReps[bface.BRep-1];
+  mb   = (mockBody *) brep->body->handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+  uv[0] = uv[1] = 0.0;
+  mock_evalFace(mb, bface.index, uv, pt);
+  uv[0] = 1.0;
+  mock_evalFace(mb, bface.index, uv, pu);
+  uv[0] = 0.0;
+  uv[1] = 1.0;
+  mock_evalFace(mb, bface.index, uv, pv);
+  if (brep->ibranch != 0) {
+    mock_xform(brep->xform, pt, pt);
+    mock_xform(brep->xform, pu, pu);
+    mock_xform(brep->xform, pv, pv);
+  }
+  for (i = 0; i < 3; i++) {
+    du[i] = pu[i] - pt[i];
+    dv[i] = pv[i] - pt[i];
+  }
+  plane[0] = du[1]*dv[2] - du[2]*dv[1];
+  plane[1] = du[2]*dv[0] - du[0]*dv[2];
+  plane[2] = du[0]*dv[1] - du[1]*dv[0];
+  len = sqrt(plane[0]*plane[0] + plane[1]*plane[1] + plane[2]*plane[2]);
+  if (len == 0.0) return GEM_DEGENERATE;
+  for (i = 0; i < 3; i++) plane[i] /= len;
+  plane[3] = plane[0]*pt[0] + plane[1]*pt[1] + plane[2]*pt[2];
+
+  return GEM_SUCCESS;
+}
+
+
+/* the curved surface of a Face in model space */
+static int
+gem_mockSurface(gemModel *model, gemPair bface, double *origin, double *axis,
+                double *radii)
+{
+  int      i, kind;
+  double   o[3], a[3];
+  gemBRep  *brep;
+  mockBody *mb;
+
+  brep = model->BReps[bface.BRep-1];
+  mb   = (mockBody *) brep->body->handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+  kind = mock_surface(mb, bface.index, o, a, radii);
+  if (brep->ibranch == 0) {
+    for (i = 0; i < 3; i++) {
+      origin[i] = o[i];
+      axis[i]   = a[i];
+    }
+  } else {
+    mock_xform(brep->xform, o, origin);
+    for (i = 0; i < 3; i++)
+      axis[i] = brep->xform[4*i  ]*a[0] + brep->xform[4*i+1]*a[1] +
+                brep->xform[4*i+2]*a[2];
+  }
+
+  return kind;
+}
+
+
+/* planes match by their plane, curved surfaces by their placement & radii */
+int
+gem_kernelSameSurfs(gemModel *model, int nFaces, gemPair *bfaces)
+{
+  int    i, stat, kind0, kind;
+  double plane0[4], plane[4], dot, org0[3], org[3], axis0[3], axis[3];
+  double rad0[2], rad[2], d[3];
+
+  if (nFaces < 2) return GEM_SUCCESS;
+  kind0 = gem_mockSurface(model, bfaces[0], org0, axis0, rad0);
+  if (kind0 < GEM_SUCCESS) return kind0;
+  if (kind0 == MOCK_PLANE) {
+    stat = gem_mockPlane(model, bfaces[0], plane0);
+    if (stat != GEM_SUCCESS) return stat;
+  }
+
+  for (i = 1; i < nFaces; i++) {
+    kind = gem_mockSurface(model, bfaces[i], org, axis, rad);
+    if (kind < GEM_SUCCESS) return kind;
+    if (kind != kind0) return GEM_OUTSIDE;
+    if (kind == MOCK_PLANE) {
+      stat = gem_mockPlane(model, bfaces[i], plane);
+      if (stat != GEM_SUCCESS) return stat;
+      dot  = plane0[0]*plane[0] + plane0[1]*plane[1] + plane0[2]*plane[2];
+      if (fabs(fabs(dot) - 1.0) > 1.e-10) return GEM_OUTSIDE;
+      if (fabs(plane[3] - dot*plane0[3]) > 1.e-10) return GEM_OUTSIDE;
+      continue;
+    }
+    if (fabs(rad[0] - rad0[0]) > 1.e-10) return GEM_OUTSIDE;
+    if (fabs(rad[1] - rad0[1]) > 1.e-10) return GEM_OUTSIDE;
+    d[0] = org[0] - org0[0];
+    d[1] = org[1] - org0[1];
+    d[2] = org[2] - org0[2];
+    if (kind == MOCK_SPHERE) {
+      if (sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]) > 1.e-10) return GEM_OUTSIDE;
+      continue;
+    }
+    dot = axis0[0]*axis[0] + axis0[1]*axis[1] + axis0[2]*axis[2];
+    if (fabs(fabs(dot) - 1.0) > 1.e-10) return GEM_OUTSIDE;
+    /* cylinders may slide along the axis -- tori may not */
+    if (kind == MOCK_CYLINDER) {
+      dot   = d[0]*axis0[0] + d[1]*axis0[1] + d[2]*axis0[2];
+      d[0] -= dot*axis0[0];
+      d[1] -= dot*axis0[1];
+      d[2] -= dot*axis0[2];
+    }
+    if (sqrt(d[0]*d[0] + d[1]*d[1] + d[2]*d[2]) > 1.e-10) return GEM_OUTSIDE;
+  }
+
+  return GEM_SUCCESS;
+}
@@ -0,0 +1,164 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Mock (Analytic) Kernel Internal Include
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#define MOCK_PI      3.1415926535897931159979635
+
+/* primitive types */
+#define MOCK_BOX         1
+#define MOCK_PLANE       2
+#define MOCK_CYLINDER    3
+#define MOCK_SPHERE      4
+#define MOCK_TORUS       5
+
+/* Face tessellation layouts */
+#define MOCK_GRID        0      /* structured in uv */
+#define MOCK_POLES       1      /* structured with both v ends collapsed */
+#define MOCK_DISK        2      /* rings about the center */
+
+/* default number of segments along a side (or quarter circle) when no
+ *   tessellation parameter applies */
+#define MOCK_NSEG        8
+#define MOCK_MAXSEG   4096
+
+#define MOCK_MAXEDGE    12
+#define MOCK_MAXFACE     6
+
+
+  /* the analytic description behind every gemBody handle */
+  typedef struct {
+    int    type;                /* primitive type */
+    double size[3];             /* primitive dimensions */
+    double xform[12];           /* placement of the primitive */
+    double invXform[12];        /* inverse of the placement */
+  } mockBody;
+
+  /* an Edge of a primitive's topology */
+  typedef struct {
+    int    nodes[2];            /* the bounding Nodes */
+    int    slot;                /* the segment count used along it */
+  } mockEdge;
+
+  /* a Face of a primitive's topology -- one Loop */
+  typedef struct {
+    int    kind;                /* tessellation layout */
+    int    uslot;               /* segment count in u (DISK: around) */
+    int    vslot;               /* segment count in v (DISK: rings) */
+    int    nedge;               /* number of Edges in the Loop */
+    int    loop[4];             /* signed Edges counterclockwise in uv */
+    int    side[4];             /* Edges at vmin, umax, vmax & umin */
+    int    corner[4];           /* Nodes at (umin,vmin), (umax,vmin),
+                                            (umax,vmax) & (umin,vmax) */
+  } mockFace;
+
+  typedef struct {
+    int      btype;             /* GEM Body type */
+    int      nnode;
+    int      nedge;
+    int      nface;
+    mockEdge edges[MOCK_MAXEDGE];
+    mockFace faces[MOCK_MAXFACE];
+  } mockTopo;
+
+  /* a primitive of a location -- count is the number of instances */
+  typedef struct {
+    int    type;
+    int    count;
+    double size[3];
+  } mockPrim;
+
+  /* the master model behind a parametric model -- Param & Branch i are
+   *   primitive i */
+  typedef struct {
+    int      nprim;
+    mockPrim *prims;
+  } mockModel;
+
+
+/* the local frame of a box Face: fixed direction d at side s, u along a,
+ *   v along b (a x b is the outward normal) */
+extern void
+mock_boxFace(int face, int *d, int *s, int *a, int *b);
+
+/* the box Edge (signed for sense) running from node n0 to node n1 */
+extern int
+mock_boxEdge(int n0, int n1);
+
+/* the box Node index for the corner bits */
+extern int
+mock_boxNode(int *bits);
+
+/* the primitive type that starts the string -- returns the name length
+ *   (0 if none) and fills the number & default values of the dimensions */
+extern int
+mock_lookup(const char *name, int *type, int *ndim, double *size);
+
+/* the name and number of dimensions of a primitive type */
+extern /*@null@*/ const char *
+mock_name(int type, /*@null@*/ int *ndim);
+
+/* are the dimensions valid for the primitive? */
+extern int
+mock_checkSize(int type, double *size);
+
+/* the topology of a primitive type */
+extern int
+mock_topology(int type, mockTopo *topo);
+
+/* the bounding box of the placed primitive */
+extern void
+mock_bbox(mockBody *mb, double *box);
+
+/* the parameter range of an Edge & the uv box of a Face */
+extern void
+mock_edgeRange(mockBody *mb, int edge, double *tlimit);
+
+extern void
+mock_faceBox(mockBody *mb, int face, double *uvbox);
+
+/* the segment counts for each slot from the tessellation parameters */
+extern void
+mock_segments(mockBody *mb, double angle, double mxside, double sag,
+              int *nseg);
+
+/* apply a placement transformation */
+extern void
+mock_xform(double *xform, double *in, double *out);
+
+/* the number of tessellation segments for a length */
+extern int
+mock_nSeg(double length, double mxside);
+
+/* evaluate the Face at uv */
+extern void
+mock_evalFace(mockBody *mb, int face, double *uv, double *xyz);
+
+/* the first (du, dv) & second (duu, duv, dvv) derivatives of the Face */
+extern void
+mock_derivFace(mockBody *mb, int face, double *uv, double *d1, double *d2);
+
+/* the uv of a DISK Face at radius rho and angle theta */
+extern void
+mock_diskUV(mockBody *mb, int face, double rho, double theta, double *uv);
+
+/* evaluate the Edge at t */
+extern void
+mock_evalEdge(mockBody *mb, int edge, double t, double *xyz);
+
+/* inverse evaluate the Face at xyz */
+extern void
+mock_invEvalFace(mockBody *mb, int face, double *xyz, double *uv);
+
+/* the surface under a Face placed in model space -- returns its kind
+ *   (MOCK_PLANE, MOCK_CYLINDER, MOCK_SPHERE or MOCK_TORUS) with an origin,
+ *   an axis and up to 2 radii */
+extern int
+mock_surface(mockBody *mb, int face, double *origin, double *axis,
+             double *radii);
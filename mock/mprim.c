@@ -0,0 +1,647 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Mock Kernel Analytic Primitive Functions
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#ifndef WIN32
+#include <strings.h>
+#else
+#define strncasecmp _strnicmp
+#endif
+
+#include "gem.h"
+#include "mock.h"
+
+#define TWOPI  (2.0*MOCK_PI)
+
+
+/* the primitives -- name, type, number of dimensions & their defaults */
+  static struct {
+    const char *name;
+    int        type;
+    int        ndim;
+    double     size[3];
+  } mockPrims[5] = { {"box",      MOCK_BOX,      3, {1.0, 1.0,  1.0}},
+                     {"plane",    MOCK_PLANE,    2, {1.0, 1.0,  0.0}},
+                     {"cylinder", MOCK_CYLINDER, 2, {0.5, 1.0,  0.0}},
+                     {"sphere",   MOCK_SPHERE,   1, {0.5, 0.0,  0.0}},
+                     {"torus",    MOCK_TORUS,    2, {1.0, 0.25, 0.0}} };
+
+/* box Face frames -- fixed direction, side, u direction, v direction */
+  static int boxFaces[6][4] = { {0, 0, 2, 1}, {0, 1, 1, 2},
+                                {1, 0, 0, 2}, {1, 1, 2, 0},
+                                {2, 0, 1, 0}, {2, 1, 0, 1} };
+
+/* a rectangular sheet -- the Edges run in +x & +y */
+  static mockTopo planeTopo = {
+    GEM_SHEET, 4, 4, 1,
+    { {{1, 2}, 0}, {{2, 3}, 1}, {{4, 3}, 0}, {{1, 4}, 1} },
+    { {MOCK_GRID,  0, 1, 4, {1, 2, -3, -4}, {1, 2, 3, 4}, {1, 2, 3, 4}} } };
+
+/* side, bottom & top -- the bottom & top circles and the seam */
+  static mockTopo cylinderTopo = {
+    GEM_SOLID, 2, 3, 3,
+    { {{1, 1}, 0}, {{2, 2}, 0}, {{1, 2}, 1} },
+    { {MOCK_GRID,  0, 1, 4, {1, 3, -2, -3}, {1, 3, 2, 3}, {1, 1, 2, 2}},
+      {MOCK_DISK,  0, 2, 1, {-1},           {1},          {1}},
+      {MOCK_DISK,  0, 2, 1, { 2},           {2},          {2}} } };
+
+/* one Face between the poles -- the seam runs south to north */
+  static mockTopo sphereTopo = {
+    GEM_SOLID, 2, 1, 1,
+    { {{1, 2}, 1} },
+    { {MOCK_POLES, 0, 1, 2, {1, -1},        {0, 1, 0, 1}, {1, 1, 2, 2}} } };
+
+/* one doubly periodic Face -- the outer equator and a meridian circle */
+  static mockTopo torusTopo = {
+    GEM_SOLID, 1, 2, 1,
+    { {{1, 1}, 0}, {{1, 1}, 1} },
+    { {MOCK_GRID,  0, 1, 4, {1, 2, -1, -2}, {1, 2, 1, 2}, {1, 1, 1, 1}} } };
+
+
+void
+mock_boxFace(int face, int *d, int *s, int *a, int *b)
+{
+  *d = boxFaces[face-1][0];
+  *s = boxFaces[face-1][1];
+  *a = boxFaces[face-1][2];
+  *b = boxFaces[face-1][3];
+}
+
+
+int
+mock_boxNode(int *bits)
+{
+  return 1 + bits[0] + 2*bits[1] + 4*bits[2];
+}
+
+
+/* box Edges are grouped by direction (x, y then z) and ordered within the
+ *   group by the corner bits of the other 2 directions */
+int
+mock_boxEdge(int n0, int n1)
+{
+  int i, ax, o1, o2, b0[3], b1[3];
+
+  for (i = 0; i < 3; i++) {
+    b0[i] = ((n0-1) >> i) & 1;
+    b1[i] = ((n1-1) >> i) & 1;
+  }
+  for (ax = 0; ax < 3; ax++)
+    if (b0[ax] != b1[ax]) break;
+  if (ax == 3) return 0;
+  o1 = (ax == 0) ? 1 : 0;
+  o2 = (ax == 2) ? 1 : 2;
+
+  i = 1 + 4*ax + b0[o1] + 2*b0[o2];
+  if (b0[ax] == 1) i = -i;
+  return i;
+}
+
+
+int
+mock_lookup(const char *name, int *type, int *ndim, double *size)
+{
+  int i, j, len;
+
+  *type = 0;
+  *ndim = 0;
+  for (i = 0; i < 5; i++) {
+    len = strlen(mockPrims[i].name);
+    if (strncasecmp(name, mockPrims[i].name, len) != 0) continue;
+    *type = mockPrims[i].type;
+    *ndim = mockPrims[i].ndim;
+    for (j = 0; j < 3; j++) size[j] = mockPrims[i].size[j];
+    return len;
+  }
+
+  return 0;
+}
+
+
+/*@null@*/ const char *
+mock_name(int type, /*@null@*/ int *ndim)
+{
+  int i;
+
+  for (i = 0; i < 5; i++)
+    if (mockPrims[i].type == type) {
+      if (ndim != NULL) *ndim = mockPrims[i].ndim;
+      return mockPrims[i].name;
+    }
+
+  if (ndim != NULL) *ndim = 0;
+  return NULL;
+}
+
+
+int
+mock_checkSize(int type, double *size)
+{
+  int i, ndim;
+
+  if (mock_name(type, &ndim) == NULL) return GEM_BADTYPE;
+  for (i = 0; i < ndim; i++)
+    if (size[i] <= 0.0) return GEM_BADVALUE;
+  /* no self-intersecting tori */
+  if ((type == MOCK_TORUS) && (size[1] >= size[0])) return GEM_BADVALUE;
+
+  return GEM_SUCCESS;
+}
+
+
+int
+mock_topology(int type, mockTopo *topo)
+{
+  int i, j, d, s, a, b, bits[3], corner[5];
+
+  if (type == MOCK_PLANE) {
+    *topo = planeTopo;
+  } else if (type == MOCK_CYLINDER) {
+    *topo = cylinderTopo;
+  } else if (type == MOCK_SPHERE) {
+    *topo = sphereTopo;
+  } else if (type == MOCK_TORUS) {
+    *topo = torusTopo;
+  } else if (type == MOCK_BOX) {
+    topo->btype = GEM_SOLID;
+    topo->nnode = 8;
+    topo->nedge = 12;
+    topo->nface = 6;
+    for (i = 0; i < 12; i++) {
+      a       = i/4;
+      b       = (a == 0) ? 1 : 0;
+      j       = (a == 2) ? 1 : 2;
+      bits[a] = 0;
+      bits[b] =  i       & 1;
+      bits[j] = (i >> 1) & 1;
+      topo->edges[i].nodes[0] = mock_boxNode(bits);
+      bits[a] = 1;
+      topo->edges[i].nodes[1] = mock_boxNode(bits);
+      topo->edges[i].slot     = a;
+    }
+    for (i = 0; i < 6; i++) {
+      mock_boxFace(i+1, &d, &s, &a, &b);
+      for (j = 0; j < 5; j++) {
+        bits[d]   = s;
+        bits[a]   = ((j+1)/2) & 1;
+        bits[b]   = (j/2)     & 1;
+        corner[j] = mock_boxNode(bits);
+      }
+      topo->faces[i].kind  = MOCK_GRID;
+      topo->faces[i].uslot = a;
+      topo->faces[i].vslot = b;
+      topo->faces[i].nedge = 4;
+      for (j = 0; j < 4; j++) {
+        topo->faces[i].loop[j]   = mock_boxEdge(corner[j], corner[j+1]);
+        topo->faces[i].side[j]   = abs(topo->faces[i].loop[j]);
+        topo->faces[i].corner[j] = corner[j];
+      }
+    }
+  } else {
+    return GEM_BADTYPE;
+  }
+
+  return GEM_SUCCESS;
+}
+
+
+void
+mock_xform(double *xform, double *in, double *out)
+{
+  double x, y, z;
+
+  x = in[0];
+  y = in[1];
+  z = in[2];
+  out[0] = xform[ 0]*x + xform[ 1]*y + xform[ 2]*z + xform[ 3];
+  out[1] = xform[ 4]*x + xform[ 5]*y + xform[ 6]*z + xform[ 7];
+  out[2] = xform[ 8]*x + xform[ 9]*y + xform[10]*z + xform[11];
+}
+
+
+/* directions only see the rotation */
+static void
+mock_rotate(double *xform, double *in, double *out)
+{
+  double x, y, z;
+
+  x = in[0];
+  y = in[1];
+  z = in[2];
+  out[0] = xform[ 0]*x + xform[ 1]*y + xform[ 2]*z;
+  out[1] = xform[ 4]*x + xform[ 5]*y + xform[ 6]*z;
+  out[2] = xform[ 8]*x + xform[ 9]*y + xform[10]*z;
+}
+
+
+void
+mock_bbox(mockBody *mb, double *box)
+{
+  int    i, j;
+  double *sz, lo[3], hi[3], p[3], xyz[3];
+
+  sz = mb->size;
+  for (i = 0; i < 3; i++) lo[i] = hi[i] = 0.0;
+  if (mb->type == MOCK_BOX) {
+    for (i = 0; i < 3; i++) hi[i] = sz[i];
+  } else if (mb->type == MOCK_PLANE) {
+    hi[0] = sz[0];
+    hi[1] = sz[1];
+  } else if (mb->type == MOCK_CYLINDER) {
+    lo[0] = lo[1] = -sz[0];
+    hi[0] = hi[1] =  sz[0];
+    hi[2] = sz[1];
+  } else if (mb->type == MOCK_SPHERE) {
+    for (i = 0; i < 3; i++) {
+      lo[i] = -sz[0];
+      hi[i] =  sz[0];
+    }
+  } else if (mb->type == MOCK_TORUS) {
+    lo[0] = lo[1] = -(sz[0]+sz[1]);
+    hi[0] = hi[1] =   sz[0]+sz[1];
+    lo[2] = -sz[1];
+    hi[2] =  sz[1];
+  }
+
+  /* the placed corners of the local box */
+  for (i = 0; i < 8; i++) {
+    for (j = 0; j < 3; j++) p[j] = (((i >> j) & 1) == 0) ? lo[j] : hi[j];
+    mock_xform(mb->xform, p, xyz);
+    for (j = 0; j < 3; j++) {
+      if ((i == 0) || (xyz[j] < box[j]))   box[j]   = xyz[j];
+      if ((i == 0) || (xyz[j] > box[j+3])) box[j+3] = xyz[j];
+    }
+  }
+}
+
+
+void
+mock_edgeRange(mockBody *mb, int edge, double *tlimit)
+{
+  tlimit[0] = 0.0;
+  tlimit[1] = TWOPI;
+  if (mb->type == MOCK_BOX) {
+    tlimit[1] = mb->size[(edge-1)/4];
+  } else if (mb->type == MOCK_PLANE) {
+    tlimit[1] = mb->size[(edge-1)%2];
+  } else if (mb->type == MOCK_CYLINDER) {
+    if (edge == 3) tlimit[1] = mb->size[1];
+  } else if (mb->type == MOCK_SPHERE) {
+    tlimit[0] = -0.5*MOCK_PI;
+    tlimit[1] =  0.5*MOCK_PI;
+  }
+}
+
+
+void
+mock_faceBox(mockBody *mb, int face, double *uvbox)
+{
+  int d, s, a, b;
+
+  uvbox[0] = uvbox[2] = 0.0;
+  uvbox[1] = uvbox[3] = TWOPI;
+  if (mb->type == MOCK_BOX) {
+    mock_boxFace(face, &d, &s, &a, &b);
+    uvbox[1] = mb->size[a];
+    uvbox[3] = mb->size[b];
+  } else if (mb->type == MOCK_PLANE) {
+    uvbox[1] = mb->size[0];
+    uvbox[3] = mb->size[1];
+  } else if (mb->type == MOCK_CYLINDER) {
+    if (face == 1) {
+      uvbox[3] =  mb->size[1];
+    } else {
+      uvbox[0] = uvbox[2] = -mb->size[0];
+      uvbox[1] = uvbox[3] =  mb->size[0];
+    }
+  } else if (mb->type == MOCK_SPHERE) {
+    uvbox[2] = -0.5*MOCK_PI;
+    uvbox[3] =  0.5*MOCK_PI;
+  }
+}
+
+
+int
+mock_nSeg(double length, double mxside)
+{
+  double n;
+
+  if (mxside <= 0.0) return MOCK_NSEG;
+  n = ceil(length/mxside);
+  if (n < 1.0) return 1;
+  if (n > MOCK_MAXSEG) return MOCK_MAXSEG;
+  return (int) n;
+}
+
+
+/* the segments for an arc -- the finest the angle (in degrees), the side
+ *   length and the sag ask for */
+static int
+mock_nArc(double radius, double sweep, double angle, double mxside,
+          double sag)
+{
+  double n, m;
+
+  n = 0.0;
+  if (angle > 0.0) {
+    m = ceil(sweep/(angle*MOCK_PI/180.0));
+    if (m > n) n = m;
+  }
+  if (mxside > 0.0) {
+    m = ceil(radius*sweep/mxside);
+    if (m > n) n = m;
+  }
+  if ((sag > 0.0) && (sag < radius)) {
+    m = ceil(sweep/(2.0*acos(1.0 - sag/radius)));
+    if (m > n) n = m;
+  }
+  if (n == 0.0) n = floor(MOCK_NSEG*sweep/(0.5*MOCK_PI) + 0.5);
+
+  /* a closed curve needs 3 segments to not fold onto itself */
+  m = (sweep < TWOPI) ? 2.0 : 3.0;
+  if (n < m) n = m;
+  if (n > MOCK_MAXSEG) n = MOCK_MAXSEG;
+  return (int) n;
+}
+
+
+void
+mock_segments(mockBody *mb, double angle, double mxside, double sag,
+              int *nseg)
+{
+  int    i;
+  double *sz;
+
+  sz = mb->size;
+  for (i = 0; i < 3; i++) nseg[i] = 1;
+  if (mb->type == MOCK_BOX) {
+    for (i = 0; i < 3; i++) nseg[i] = mock_nSeg(sz[i], mxside);
+  } else if (mb->type == MOCK_PLANE) {
+    for (i = 0; i < 2; i++) nseg[i] = mock_nSeg(sz[i], mxside);
+  } else if (mb->type == MOCK_CYLINDER) {
+    nseg[0] = mock_nArc(sz[0], TWOPI, angle, mxside, sag);
+    nseg[1] = mock_nSeg(sz[1], mxside);
+    /* rings about as far apart as the points around */
+    nseg[2] = (nseg[0]+5)/6;
+  } else if (mb->type == MOCK_SPHERE) {
+    nseg[0] = mock_nArc(sz[0], TWOPI,   angle, mxside, sag);
+    nseg[1] = mock_nArc(sz[0], MOCK_PI, angle, mxside, sag);
+  } else if (mb->type == MOCK_TORUS) {
+    nseg[0] = mock_nArc(sz[0]+sz[1], TWOPI, angle, mxside, sag);
+    nseg[1] = mock_nArc(sz[1],       TWOPI, angle, mxside, sag);
+  }
+}
+
+
+/* a full turn is no turn -- the seams of periodic Faces then evaluate to
+ *   the same coordinates on both sides */
+static void
+mock_cosSin(double angle, double *c, double *s)
+{
+  if (angle == TWOPI) angle = 0.0;
+  *c = cos(angle);
+  *s = sin(angle);
+}
+
+
+void
+mock_evalFace(mockBody *mb, int face, double *uv, double *xyz)
+{
+  int    d, s, a, b;
+  double p[3], *sz, rho, cu, su, cv, sv;
+
+  sz = mb->size;
+  mock_cosSin(uv[0], &cu, &su);
+  mock_cosSin(uv[1], &cv, &sv);
+  if (mb->type == MOCK_BOX) {
+    mock_boxFace(face, &d, &s, &a, &b);
+    p[d] = s*sz[d];
+    p[a] = uv[0];
+    p[b] = uv[1];
+  } else if (mb->type == MOCK_CYLINDER) {
+    if (face == 1) {
+      p[0] = sz[0]*cu;
+      p[1] = sz[0]*su;
+      p[2] = uv[1];
+    } else if (face == 2) {
+      p[0] = uv[1];
+      p[1] = uv[0];
+      p[2] = 0.0;
+    } else {
+      p[0] = uv[0];
+      p[1] = uv[1];
+      p[2] = sz[1];
+    }
+  } else if (mb->type == MOCK_SPHERE) {
+    rho  = sz[0]*cv;
+    p[0] = rho*cu;
+    p[1] = rho*su;
+    p[2] = sz[0]*sv;
+  } else if (mb->type == MOCK_TORUS) {
+    rho  = sz[0] + sz[1]*cv;
+    p[0] = rho*cu;
+    p[1] = rho*su;
+    p[2] = sz[1]*sv;
+  } else {
+    p[0] = uv[0];
+    p[1] = uv[1];
+    p[2] = 0.0;
+  }
+  mock_xform(mb->xform, p, xyz);
+}
+
+
+void
+mock_derivFace(mockBody *mb, int face, double *uv, double *d1, double *d2)
+{
+  int    i, d, s, a, b;
+  double *sz, cu, su, cv, sv, rho, l1[6], l2[9];
+
+  sz = mb->size;
+  for (i = 0; i < 6; i++) l1[i] = 0.0;
+  for (i = 0; i < 9; i++) l2[i] = 0.0;
+  mock_cosSin(uv[0], &cu, &su);
+  mock_cosSin(uv[1], &cv, &sv);
+  if (mb->type == MOCK_BOX) {
+    mock_boxFace(face, &d, &s, &a, &b);
+    l1[a]   = 1.0;
+    l1[3+b] = 1.0;
+  } else if ((mb->type == MOCK_CYLINDER) && (face == 1)) {
+    l1[0] = -sz[0]*su;
+    l1[1] =  sz[0]*cu;
+    l1[5] =  1.0;
+    l2[0] = -sz[0]*cu;
+    l2[1] = -sz[0]*su;
+  } else if ((mb->type == MOCK_CYLINDER) && (face == 2)) {
+    l1[1] = 1.0;
+    l1[3] = 1.0;
+  } else if ((mb->type == MOCK_SPHERE) || (mb->type == MOCK_TORUS)) {
+    rho = sz[0]*cv;
+    if (mb->type == MOCK_TORUS) rho = sz[0] + sz[1]*cv;
+    if (mb->type == MOCK_TORUS) sz = &mb->size[1];
+    l1[0] = -rho*su;
+    l1[1] =  rho*cu;
+    l1[3] = -sz[0]*sv*cu;
+    l1[4] = -sz[0]*sv*su;
+    l1[5] =  sz[0]*cv;
+    l2[0] = -rho*cu;
+    l2[1] = -rho*su;
+    l2[3] =  sz[0]*sv*su;
+    l2[4] = -sz[0]*sv*cu;
+    l2[6] = -sz[0]*cv*cu;
+    l2[7] = -sz[0]*cv*su;
+    l2[8] = -sz[0]*sv;
+  } else {
+    l1[0] = 1.0;
+    l1[4] = 1.0;
+  }
+
+  for (i = 0; i < 2; i++) mock_rotate(mb->xform, &l1[3*i], &d1[3*i]);
+  for (i = 0; i < 3; i++) mock_rotate(mb->xform, &l2[3*i], &d2[3*i]);
+}
+
+
+/* the disks are planes in x & y -- the bottom swaps them to face down */
+void
+mock_diskUV(mockBody *mb, int face, double rho, double theta, double *uv)
+{
+  if ((mb->type == MOCK_CYLINDER) && (face == 2)) {
+    uv[0] = rho*sin(theta);
+    uv[1] = rho*cos(theta);
+  } else {
+    uv[0] = rho*cos(theta);
+    uv[1] = rho*sin(theta);
+  }
+}
+
+
+/* Edges are isocurves of the first Face -- so that Face and Edge
+ *   evaluations agree bit-for-bit */
+void
+mock_evalEdge(mockBody *mb, int edge, double t, double *xyz)
+{
+  int    ax, o1, o2;
+  double p[3], uv[2];
+
+  if (mb->type == MOCK_BOX) {
+    ax    = (edge-1)/4;
+    o1    = (ax == 0) ? 1 : 0;
+    o2    = (ax == 2) ? 1 : 2;
+    p[ax] = t;
+    p[o1] = ( (edge-1)       & 1)*mb->size[o1];
+    p[o2] = (((edge-1) >> 1) & 1)*mb->size[o2];
+    mock_xform(mb->xform, p, xyz);
+    return;
+  }
+
+  uv[0] = uv[1] = 0.0;
+  if (mb->type == MOCK_PLANE) {
+    if (edge == 1) {
+      uv[0] = t;
+    } else if (edge == 2) {
+      uv[0] = mb->size[0];
+      uv[1] = t;
+    } else if (edge == 3) {
+      uv[0] = t;
+      uv[1] = mb->size[1];
+    } else {
+      uv[1] = t;
+    }
+  } else if (mb->type == MOCK_CYLINDER) {
+    if (edge == 3) {
+      uv[1] = t;
+    } else {
+      uv[0] = t;
+      if (edge == 2) uv[1] = mb->size[1];
+    }
+  } else if (mb->type == MOCK_SPHERE) {
+    uv[1] = t;
+  } else if (mb->type == MOCK_TORUS) {
+    uv[edge-1] = t;
+  }
+  mock_evalFace(mb, 1, uv, xyz);
+}
+
+
+/* the angle about z in [0,2pi) */
+static double
+mock_angle(double y, double x)
+{
+  double a;
+
+  if ((x == 0.0) && (y == 0.0)) return 0.0;
+  a = atan2(y, x);
+  if (a < 0.0) a += TWOPI;
+  return a;
+}
+
+
+void
+mock_invEvalFace(mockBody *mb, int face, double *xyz, double *uv)
+{
+  int    d, s, a, b;
+  double p[3], rho;
+
+  mock_xform(mb->invXform, xyz, p);
+  if (mb->type == MOCK_BOX) {
+    mock_boxFace(face, &d, &s, &a, &b);
+    uv[0] = p[a];
+    uv[1] = p[b];
+  } else if (mb->type == MOCK_CYLINDER) {
+    if (face == 1) {
+      uv[0] = mock_angle(p[1], p[0]);
+      uv[1] = p[2];
+    } else if (face == 2) {
+      uv[0] = p[1];
+      uv[1] = p[0];
+    } else {
+      uv[0] = p[0];
+      uv[1] = p[1];
+    }
+  } else if (mb->type == MOCK_SPHERE) {
+    rho   = sqrt(p[0]*p[0] + p[1]*p[1]);
+    uv[0] = (rho == 0.0) ? MOCK_PI : mock_angle(p[1], p[0]);
+    uv[1] = atan2(p[2], rho);
+  } else if (mb->type == MOCK_TORUS) {
+    rho   = sqrt(p[0]*p[0] + p[1]*p[1]) - mb->size[0];
+    uv[0] = mock_angle(p[1], p[0]);
+    uv[1] = mock_angle(p[2], rho);
+  } else {
+    uv[0] = p[0];
+    uv[1] = p[1];
+  }
+}
+
+
+int
+mock_surface(mockBody *mb, int face, double *origin, double *axis,
+             double *radii)
+{
+  int    kind;
+  double p[3];
+
+  kind = MOCK_PLANE;
+  if ((mb->type == MOCK_CYLINDER) && (face == 1)) kind = MOCK_CYLINDER;
+  if ((mb->type == MOCK_SPHERE) || (mb->type == MOCK_TORUS))
+    kind = mb->type;
+
+  p[0] = p[1] = p[2] = 0.0;
+  mock_xform(mb->xform, p, origin);
+  p[2] = 1.0;
+  mock_rotate(mb->xform, p, axis);
+  radii[0] = mb->size[0];
+  radii[1] = (kind == MOCK_TORUS) ? mb->size[1] : 0.0;
+
+  return kind;
+}
@@ -0,0 +1,118 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Regenerate Function -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gem.h"
+#include "memory.h"
+#include "mock.h"
+
+
+  extern void gem_releaseBRep(/*@only@*/ gemBRep *brep);
+  extern int  gem_clrDReps(gemModel *model, int phase);
+  extern int  gem_refreshDReps(gemModel *model, int *keep);
+  extern int  gem_mockBReps(int nprim, mockPrim *prims,
+                            /*@null@*/ gemFeat *branches, gemID phandle,
+                            int *nBRep, gemBRep ***BReps);
+
+
+/*
+ * rebuilds the primitives from the Params & Branches -- the dimensions are
+ *   checked before anything is torn down. The BReps of the primitives before
+ *   the first change are not affected (the placement only depends on those
+ *   before) and are kept along with what the DReps have for them
+ */
+int
+gem_kernelRegen(gemModel *model)
+{
+  int       i, j, stat, ndim, nBRep, nold, first, nkeep, *keep;
+  double    size[3], *vals;
+  gemBRep   **BReps, **old;
+  mockModel *mm;
+
+  mm = (mockModel *) model->handle.ident.ptr;
+  if (mm == NULL) return GEM_NOTPARMTRIC;
+  if ((model->nParams != mm->nprim) || (model->nBranches != mm->nprim))
+    return GEM_BADOBJECT;
+
+  for (i = 0; i < model->nParams; i++) {
+    if (model->Params[i].changed == 0) continue;
+    if (model->Params[i].type != GEM_REAL) return GEM_BADTYPE;
+    mock_name(mm->prims[i].type, &ndim);
+    if (model->Params[i].len != ndim) return GEM_FIXEDLEN;
+    vals = &model->Params[i].vals.real;
+    if (ndim > 1) vals = model->Params[i].vals.reals;
+    size[0] = size[1] = size[2] = 0.0;
+    for (j = 0; j < ndim; j++) size[j] = vals[j];
+    stat = mock_checkSize(mm->prims[i].type, size);
+    if (stat != GEM_SUCCESS) return stat;
+  }
+
+  first = mm->nprim;
+  for (i = mm->nprim-1; i >= 0; i--)
+    if ((model->Params[i].changed != 0) ||
+        (model->Branches[i].changed != 0)) first = i;
+  for (nkeep = i = 0; i < first; i++)
+    if (model->Branches[i].sflag != GEM_SUPPRESSED)
+      nkeep += mm->prims[i].count;
+
+  for (i = 0; i < model->nParams; i++) {
+    if (model->Params[i].changed == 0) continue;
+    mock_name(mm->prims[i].type, &ndim);
+    vals = &model->Params[i].vals.real;
+    if (ndim > 1) vals = model->Params[i].vals.reals;
+    for (j = 0; j < ndim; j++) mm->prims[i].size[j] = vals[j];
+    model->Params[i].changed = 0;
+  }
+  for (i = 0; i < model->nBranches; i++) model->Branches[i].changed = 0;
+
+  /* rebuild, keep the unaffected BReps & remove the rest */
+
+  stat = gem_mockBReps(mm->nprim, mm->prims, model->Branches, model->handle,
+                       &nBRep, &BReps);
+  if (stat != GEM_SUCCESS) nkeep = 0;
+  nold = model->nBRep;
+  old  = model->BReps;
+  if (nkeep > nold) nkeep = nold;
+  for (i = 0; i < nold; i++) {
+    if (i < nkeep) {
+      if (BReps[i]->inumber == 0) gem_free(BReps[i]->body->handle.ident.ptr);
+      gem_releaseBRep(BReps[i]);
+      BReps[i] = old[i];
+      continue;
+    }
+    if (old[i]->inumber == 0) gem_free(old[i]->body->handle.ident.ptr);
+    gem_releaseBRep(old[i]);
+  }
+  gem_free(old);
+  
+  /* the DReps are only refilled if the number of BReps changed */
+  keep = NULL;
+  if ((nBRep == nold) && (nBRep != 0)) {
+    keep = (int *) gem_allocate(nBRep*sizeof(int));
+    if (keep != NULL)
+      for (i = 0; i < nBRep; i++) keep[i] = (i < nkeep) ? 1 : 0;
+  }
+  if (keep == NULL) gem_clrDReps(model, 0);
+  for (i = 0; i < nBRep; i++) BReps[i]->omodel = model;
+  model->nBRep = nBRep;
+  model->mBRep = nBRep;
+  model->BReps = BReps;
+  if (keep == NULL) {
+    gem_clrDReps(model, 1);
+  } else {
+    gem_refreshDReps(model, keep);
+    gem_free(keep);
+  }
+
+  return stat;
+}
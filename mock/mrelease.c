@@ -0,0 +1,45 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Release Function -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "gem.h"
+#include "memory.h"
+#include "mock.h"
+
+
+int
+gem_kernelRelease(gemModel *model)
+{
+  int       i;
+  gemBody   *body;
+  mockModel *mm;
+
+  /* only Body owners hold a primitive -- instances share it */
+  for (i = 0; i < model->nBRep; i++) {
+    if (model->BReps[i]->inumber != 0) continue;
+    body = model->BReps[i]->body;
+    if (body == NULL) continue;
+    gem_free(body->handle.ident.ptr);
+    body->handle.ident.ptr = NULL;
+  }
+
+  /* the master model of a parametric model */
+  mm = (mockModel *) model->handle.ident.ptr;
+  if (mm != NULL) {
+    gem_free(mm->prims);
+    gem_free(mm);
+    model->handle.ident.ptr = NULL;
+  }
+
+  return GEM_SUCCESS;
+}
@@ -0,0 +1,464 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Kernel Tessellation Function -- Mock (Analytic)
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gem.h"
+#include "memory.h"
+#include "mock.h"
+
+
+static void
+gem_destroyTRep(gemTRep *trep)
+{
+  int i;
+
+  if (trep->Faces != NULL) {
+    for (i = 0; i < trep->nFaces; i++) {
+      gem_free(trep->Faces[i].xyzs);
+      gem_free(trep->Faces[i].tris);
+      gem_free(trep->Faces[i].tric);
+      gem_free(trep->Faces[i].uvs);
+      gem_free(trep->Faces[i].vid);
+    }
+    gem_free(trep->Faces);
+    trep->nFaces = 0;
+    trep->Faces  = NULL;
+  }
+
+  if (trep->Edges != NULL) {
+    for (i = 0; i < trep->nEdges; i++) {
+      gem_free(trep->Edges[i].xyzs);
+      gem_free(trep->Edges[i].ts);
+    }
+    gem_free(trep->Edges);
+    trep->nEdges = 0;
+    trep->Edges  = NULL;
+  }
+}
+
+
+/* the j-th of n uniform divisions of [0,len] -- exact at both ends so that
+ *   Face and Edge tessellations share their boundary vertices bit-for-bit */
+static double
+gem_mockGrid(double len, int j, int n)
+{
+  if (j == 0) return 0.0;
+  if (j == n) return len;
+  return (len*j)/n;
+}
+
+
+static int
+gem_mockAllocTri(gemTri *tri, int npts, int ntris)
+{
+  tri->npts  = npts;
+  tri->ntris = ntris;
+  tri->xyzs  = (double *) gem_allocate(3*npts*sizeof(double));
+  tri->uvs   = (double *) gem_allocate(2*npts*sizeof(double));
+  tri->vid   = (int *)    gem_allocate(2*npts*sizeof(int));
+  tri->tris  = (int *)    gem_allocate(3*ntris*sizeof(int));
+  tri->tric  = (int *)    gem_allocate(3*ntris*sizeof(int));
+  if ((tri->xyzs == NULL) || (tri->uvs  == NULL) || (tri->vid == NULL) ||
+      (tri->tris == NULL) || (tri->tric == NULL)) return GEM_ALLOC;
+
+  return GEM_SUCCESS;
+}
+
+
+static void
+gem_mockVid(gemTri *tri, int k, int type, int index)
+{
+  tri->vid[2*k  ] = type;
+  tri->vid[2*k+1] = index;
+}
+
+
+/* triangle sides keyed by their vertices -- for matching up neighbors */
+  typedef struct {
+    int v0;                     /* the smaller vertex */
+    int v1;                     /* the larger vertex */
+    int side;                   /* 3*triangle + opposite vertex */
+  } mockSide;
+
+
+static int
+gem_mockSideCmp(const void *a, const void *b)
+{
+  const mockSide *s0 = (const mockSide *) a;
+  const mockSide *s1 = (const mockSide *) b;
+
+  if (s0->v0 != s1->v0) return (s0->v0 < s1->v0) ? -1 : 1;
+  if (s0->v1 != s1->v1) return (s0->v1 < s1->v1) ? -1 : 1;
+  return 0;
+}
+
+
+/* neighbors by sorting the sides -- unmatched sides are on the Edge */
+static int
+gem_mockNeighbors(gemTri *tri, int edge)
+{
+  int      i, j, n, v0, v1;
+  mockSide *sides;
+
+  n     = 3*tri->ntris;
+  sides = (mockSide *) gem_allocate(n*sizeof(mockSide));
+  if (sides == NULL) return GEM_ALLOC;
+  for (i = 0; i < tri->ntris; i++)
+    for (j = 0; j < 3; j++) {
+      v0 = tri->tris[3*i+(j+1)%3];
+      v1 = tri->tris[3*i+(j+2)%3];
+      sides[3*i+j].v0   = (v0 < v1) ? v0 : v1;
+      sides[3*i+j].v1   = (v0 < v1) ? v1 : v0;
+      sides[3*i+j].side = 3*i + j;
+      tri->tric[3*i+j]  = -edge;
+    }
+  qsort(sides, n, sizeof(mockSide), gem_mockSideCmp);
+  for (i = 0; i < n-1; i++) {
+    if (gem_mockSideCmp(&sides[i], &sides[i+1]) != 0) continue;
+    tri->tric[sides[i  ].side] = sides[i+1].side/3 + 1;
+    tri->tric[sides[i+1].side] = sides[i  ].side/3 + 1;
+    i++;
+  }
+  gem_free(sides);
+
+  return GEM_SUCCESS;
+}
+
+
+static int
+gem_mockGridTess(mockBody *mb, int face, mockFace *mf, int *nseg,
+                 gemTri *tri)
+{
+  int    i, j, k, c, na, nb, stat, *sedge;
+  double uv[2], uvbox[4];
+
+  na    = nseg[mf->uslot];
+  nb    = nseg[mf->vslot];
+  sedge = mf->side;
+  mock_faceBox(mb, face, uvbox);
+  stat  = gem_mockAllocTri(tri, (na+1)*(nb+1), 2*na*nb);
+  if (stat != GEM_SUCCESS) return stat;
+
+  /* the vertices -- Nodes, then Edge vertices, then the interior */
+  for (k = j = 0; j <= nb; j++)
+    for (i = 0; i <= na; i++, k++) {
+      uv[0] = uvbox[0] + gem_mockGrid(uvbox[1]-uvbox[0], i, na);
+      uv[1] = uvbox[2] + gem_mockGrid(uvbox[3]-uvbox[2], j, nb);
+      tri->uvs[2*k  ] = uv[0];
+      tri->uvs[2*k+1] = uv[1];
+      mock_evalFace(mb, face, uv, &tri->xyzs[3*k]);
+      if ((i == 0) && (j == 0)) {
+        gem_mockVid(tri, k, 0, mf->corner[0]);
+      } else if ((i == na) && (j == 0)) {
+        gem_mockVid(tri, k, 0, mf->corner[1]);
+      } else if ((i == na) && (j == nb)) {
+        gem_mockVid(tri, k, 0, mf->corner[2]);
+      } else if ((i == 0) && (j == nb)) {
+        gem_mockVid(tri, k, 0, mf->corner[3]);
+      } else if (j == 0) {
+        gem_mockVid(tri, k, i+1, sedge[0]);
+      } else if (i == na) {
+        gem_mockVid(tri, k, j+1, sedge[1]);
+      } else if (j == nb) {
+        gem_mockVid(tri, k, i+1, sedge[2]);
+      } else if (i == 0) {
+        gem_mockVid(tri, k, j+1, sedge[3]);
+      } else {
+        gem_mockVid(tri, k, -1, -1);
+      }
+    }
+
+  /* two triangles per cell -- neighbors are opposite each vertex */
+  for (j = 0; j < nb; j++)
+    for (i = 0; i < na; i++) {
+      c = j*na + i;
+      k = j*(na+1) + i + 1;
+      tri->tris[6*c  ] = k;
+      tri->tris[6*c+1] = k + 1;
+      tri->tris[6*c+2] = k + na + 2;
+      tri->tric[6*c  ] = (i < na-1) ? 2*(c+1)+2    : -sedge[1];
+      tri->tric[6*c+1] = 2*c + 2;
+      tri->tric[6*c+2] = (j > 0)    ? 2*(c-na)+2   : -sedge[0];
+      tri->tris[6*c+3] = k;
+      tri->tris[6*c+4] = k + na + 2;
+      tri->tris[6*c+5] = k + na + 1;
+      tri->tric[6*c+3] = (j < nb-1) ? 2*(c+na)+1   : -sedge[2];
+      tri->tric[6*c+4] = (i > 0)    ? 2*(c-1)+1    : -sedge[3];
+      tri->tric[6*c+5] = 2*c + 1;
+    }
+
+  return GEM_SUCCESS;
+}
+
+
+/* a grid whose first & last rows are collapsed into the pole Nodes -- the
+ *   poles sit mid-way in u and take their coordinates from the seam */
+static int
+gem_mockPolesTess(mockBody *mb, int face, mockFace *mf, int *nseg,
+                  gemTri *tri)
+{
+  int    i, j, k, m, n, na, nb, stat, south, north;
+  double uv[2], uvbox[4];
+
+  na   = nseg[mf->uslot];
+  nb   = nseg[mf->vslot];
+  mock_faceBox(mb, face, uvbox);
+  stat = gem_mockAllocTri(tri, (nb-1)*(na+1)+2, 2*na*(nb-1));
+  if (stat != GEM_SUCCESS) return stat;
+
+  /* the vertices -- south pole, the rows, then the north pole */
+  for (k = j = 0; j <= nb; j++)
+    for (i = 0; i <= na; i++) {
+      if (((j == 0) || (j == nb)) && (i != 0)) continue;
+      uv[0] = uvbox[0] + gem_mockGrid(uvbox[1]-uvbox[0], i, na);
+      uv[1] = uvbox[2] + gem_mockGrid(uvbox[3]-uvbox[2], j, nb);
+      mock_evalFace(mb, face, uv, &tri->xyzs[3*k]);
+      if ((j == 0) || (j == nb)) {
+        uv[0] = 0.5*(uvbox[0] + uvbox[1]);
+        gem_mockVid(tri, k, 0, mf->corner[(j == 0) ? 0 : 2]);
+      } else if ((i == 0) || (i == na)) {
+        gem_mockVid(tri, k, j+1, mf->side[(i == 0) ? 3 : 1]);
+      } else {
+        gem_mockVid(tri, k, -1, -1);
+      }
+      tri->uvs[2*k  ] = uv[0];
+      tri->uvs[2*k+1] = uv[1];
+      k++;
+    }
+  south = 1;
+  north = k;
+
+  /* fans at the poles with 2 triangles per cell between the rows */
+  for (n = i = 0; i < na; i++, n++) {
+    tri->tris[3*n  ] = south;
+    tri->tris[3*n+1] = i + 3;
+    tri->tris[3*n+2] = i + 2;
+  }
+  for (j = 1; j < nb-1; j++)
+    for (i = 0; i < na; i++, n += 2) {
+      m = (j-1)*(na+1) + i + 2;
+      tri->tris[3*n  ] = m;
+      tri->tris[3*n+1] = m + 1;
+      tri->tris[3*n+2] = m + na + 2;
+      tri->tris[3*n+3] = m;
+      tri->tris[3*n+4] = m + na + 2;
+      tri->tris[3*n+5] = m + na + 1;
+    }
+  for (i = 0; i < na; i++, n++) {
+    m = (nb-2)*(na+1) + i + 2;
+    tri->tris[3*n  ] = north;
+    tri->tris[3*n+1] = m;
+    tri->tris[3*n+2] = m + 1;
+  }
+
+  return gem_mockNeighbors(tri, mf->side[1]);
+}
+
+
+/* the number of points on ring k of n about a disk center */
+static int
+gem_mockRing(int nround, int k, int n)
+{
+  int m;
+
+  if (k == n) return nround;
+  m = (nround*k + n-1)/n;
+  if (m < 3) m = 3;
+  return m;
+}
+
+
+/* rings about the center -- the points on each ring follow the outer one
+ *   and neighboring rings are merged by angle */
+static int
+gem_mockDiskTess(mockBody *mb, int face, mockFace *mf, int *nseg,
+                 gemTri *tri)
+{
+  int    i, j, k, m, n, ia, ib, ma, mb0, npts, ntris, stat, base, prev;
+  double rad, uv[2], uvbox[4], area;
+
+  n    = nseg[mf->uslot];
+  m    = nseg[mf->vslot];
+  mock_faceBox(mb, face, uvbox);
+  rad  = uvbox[1];
+  npts = 1;
+  for (k = 1; k <= m; k++) npts += gem_mockRing(n, k, m);
+  ntris = gem_mockRing(n, 1, m);
+  for (k = 2; k <= m; k++)
+    ntris += gem_mockRing(n, k-1, m) + gem_mockRing(n, k, m);
+  stat = gem_mockAllocTri(tri, npts, ntris);
+  if (stat != GEM_SUCCESS) return stat;
+
+  /* the center, then ring by ring -- the outer ring is the Edge */
+  uv[0] = uv[1] = 0.0;
+  tri->uvs[0] = tri->uvs[1] = 0.0;
+  mock_evalFace(mb, face, uv, tri->xyzs);
+  gem_mockVid(tri, 0, -1, -1);
+  for (j = k = 1; k <= m; k++) {
+    ma = gem_mockRing(n, k, m);
+    for (i = 0; i < ma; i++, j++) {
+      mock_diskUV(mb, face, gem_mockGrid(rad, k, m),
+                  gem_mockGrid(2.0*MOCK_PI, i, ma), uv);
+      tri->uvs[2*j  ] = uv[0];
+      tri->uvs[2*j+1] = uv[1];
+      mock_evalFace(mb, face, uv, &tri->xyzs[3*j]);
+      if (k != m) {
+        gem_mockVid(tri, j, -1, -1);
+      } else if (i == 0) {
+        gem_mockVid(tri, j, 0, mf->corner[0]);
+      } else {
+        gem_mockVid(tri, j, i+1, mf->side[0]);
+      }
+    }
+  }
+
+  /* the fan about the center */
+  ma = gem_mockRing(n, 1, m);
+  for (n = i = 0; i < ma; i++, n++) {
+    tri->tris[3*n  ] = 1;
+    tri->tris[3*n+1] = i + 2;
+    tri->tris[3*n+2] = (i+1)%ma + 2;
+  }
+
+  /* zip the rings -- advance on the ring whose next point is first */
+  prev = 2;
+  for (k = 2; k <= m; k++) {
+    ma   = gem_mockRing(nseg[mf->uslot], k-1, m);
+    mb0  = gem_mockRing(nseg[mf->uslot], k,   m);
+    base = prev + ma;
+    ia   = ib = 0;
+    while ((ia < ma) || (ib < mb0)) {
+      tri->tris[3*n  ] = prev + ia%ma;
+      tri->tris[3*n+1] = base + ib%mb0;
+      if ((ib < mb0) && ((ia == ma) || ((ib+1)*ma <= (ia+1)*mb0))) {
+        ib++;
+        tri->tris[3*n+2] = base + ib%mb0;
+      } else {
+        ia++;
+        tri->tris[3*n+2] = prev + ia%ma;
+      }
+      n++;
+    }
+    prev = base;
+  }
+
+  /* keep the triangles counterclockwise in uv */
+  area = (tri->uvs[2*tri->tris[1]-2] - tri->uvs[0])*
+         (tri->uvs[2*tri->tris[2]-1] - tri->uvs[1]) -
+         (tri->uvs[2*tri->tris[1]-1] - tri->uvs[1])*
+         (tri->uvs[2*tri->tris[2]-2] - tri->uvs[0]);
+  if (area < 0.0)
+    for (i = 0; i < ntris; i++) {
+      j               = tri->tris[3*i+1];
+      tri->tris[3*i+1] = tri->tris[3*i+2];
+      tri->tris[3*i+2] = j;
+    }
+
+  return gem_mockNeighbors(tri, mf->side[0]);
+}
+
+
+/*
+ * structured tessellation -- mxside sets the density along straight sides,
+ *   the finest of the angle, mxside & sag sets it around the circles
+ */
+int
+gem_kernelTessel(gemBody *body, double angle, double mxside, double sag,
+                 gemDRep *drep, int brep)
+{
+  int      i, j, n, stat, nfaces, nedges, nseg[3];
+  double   tlimit[2];
+  mockBody *mb;
+  mockTopo topo;
+  gemTRep  *trep;
+
+  trep = &drep->TReps[brep-1];
+  if (trep == NULL) return GEM_NULLVALUE;
+  if (trep->Faces != NULL) gem_destroyTRep(trep);
+
+  mb = (mockBody *) body->handle.ident.ptr;
+  if (mb == NULL) return GEM_NULLOBJ;
+  nfaces = body->nface;
+  nedges = body->nedge;
+  if (nfaces == 0) return GEM_SUCCESS;
+  stat = mock_topology(mb->type, &topo);
+  if (stat != GEM_SUCCESS) return stat;
+  mock_segments(mb, angle, mxside, sag, nseg);
+
+  /* get the GEM storage */
+  trep->Faces = (gemTri *) gem_allocate(nfaces*sizeof(gemTri));
+  if (trep->Faces == NULL) return GEM_ALLOC;
+  for (i = 0; i < nfaces; i++) {
+    trep->Faces[i].ntris = 0;
+    trep->Faces[i].npts  = 0;
+    trep->Faces[i].tris  = NULL;
+    trep->Faces[i].tric  = NULL;
+    trep->Faces[i].xyzs  = NULL;
+    trep->Faces[i].uvs   = NULL;
+    trep->Faces[i].vid   = NULL;
+  }
+  trep->Edges = (gemDEdge *) gem_allocate(nedges*sizeof(gemDEdge));
+  if (trep->Edges == NULL) {
+    gem_free(trep->Faces);
+    trep->Faces = NULL;
+    return GEM_ALLOC;
+  }
+  for (i = 0; i < nedges; i++) {
+    trep->Edges[i].npts = 0;
+    trep->Edges[i].xyzs = NULL;
+    trep->Edges[i].ts   = NULL;
+  }
+  trep->nFaces = nfaces;
+  trep->nEdges = nedges;
+
+  /* fill in Faces */
+  for (i = 0; i < nfaces; i++) {
+    if (topo.faces[i].kind == MOCK_POLES) {
+      stat = gem_mockPolesTess(mb, i+1, &topo.faces[i], nseg,
+                               &trep->Faces[i]);
+    } else if (topo.faces[i].kind == MOCK_DISK) {
+      stat = gem_mockDiskTess(mb, i+1, &topo.faces[i], nseg,
+                              &trep->Faces[i]);
+    } else {
+      stat = gem_mockGridTess(mb, i+1, &topo.faces[i], nseg,
+                              &trep->Faces[i]);
+    }
+    if (stat != GEM_SUCCESS) {
+      gem_destroyTRep(trep);
+      return stat;
+    }
+  }
+
+  /* fill in Edges */
+  for (i = 0; i < nedges; i++) {
+    n = nseg[topo.edges[i].slot];
+    mock_edgeRange(mb, i+1, tlimit);
+    trep->Edges[i].npts = n + 1;
+    trep->Edges[i].xyzs = (double *)
+                          gem_allocate(3*trep->Edges[i].npts*sizeof(double));
+    trep->Edges[i].ts   = (double *)
+                          gem_allocate(  trep->Edges[i].npts*sizeof(double));
+    if ((trep->Edges[i].xyzs == NULL) || (trep->Edges[i].ts == NULL)) {
+      gem_destroyTRep(trep);
+      return GEM_ALLOC;
+    }
+    for (j = 0; j <= n; j++) {
+      trep->Edges[i].ts[j] = tlimit[0] +
+                             gem_mockGrid(tlimit[1]-tlimit[0], j, n);
+      mock_evalEdge(mb, i+1, trep->Edges[i].ts[j], &trep->Edges[i].xyzs[3*j]);
+    }
+  }
+
+  return GEM_SUCCESS;
+}
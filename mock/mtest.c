@@ -0,0 +1,265 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Mock Kernel Test Code -- tessellation & parametric regen
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "gem.h"
+
+#define PI 3.1415926535897931159979635
+
+
+static int
+sameArray(void *a, void *b, int len)
+{
+  if ((a == NULL) || (b == NULL)) return a == b;
+  return memcmp(a, b, len) == 0;
+}
+
+
+/* are the 2 tessellations bit-for-bit the same? */
+static int
+compareTReps(gemDRep *drep1, gemDRep *drep2)
+{
+  int     i, j, nerr = 0;
+  gemTri  *f1, *f2;
+  gemDEdge *e1, *e2;
+
+  for (i = 0; i < drep1->nBReps; i++) {
+    if ((drep1->TReps[i].nFaces != drep2->TReps[i].nFaces) ||
+        (drep1->TReps[i].nEdges != drep2->TReps[i].nEdges)) {
+      printf(" BRep %d: Face/Edge counts differ!\n", i+1);
+      nerr++;
+      continue;
+    }
+    for (j = 0; j < drep1->TReps[i].nFaces; j++) {
+      f1 = &drep1->TReps[i].Faces[j];
+      f2 = &drep2->TReps[i].Faces[j];
+      if ((f1->npts != f2->npts) || (f1->ntris != f2->ntris) ||
+          !sameArray(f1->xyzs, f2->xyzs, 3*f1->npts *sizeof(double)) ||
+          !sameArray(f1->uvs,  f2->uvs,  2*f1->npts *sizeof(double)) ||
+          !sameArray(f1->vid,  f2->vid,  2*f1->npts *sizeof(int))    ||
+          !sameArray(f1->tris, f2->tris, 3*f1->ntris*sizeof(int))    ||
+          !sameArray(f1->tric, f2->tric, 3*f1->ntris*sizeof(int))) {
+        printf(" BRep %d: Face %d differs!\n", i+1, j+1);
+        nerr++;
+      }
+    }
+    for (j = 0; j < drep1->TReps[i].nEdges; j++) {
+      e1 = &drep1->TReps[i].Edges[j];
+      e2 = &drep2->TReps[i].Edges[j];
+      if ((e1->npts != e2->npts) ||
+          !sameArray(e1->xyzs, e2->xyzs, 3*e1->npts*sizeof(double)) ||
+          !sameArray(e1->ts,   e2->ts,     e1->npts*sizeof(double))) {
+        printf(" BRep %d: Edge %d differs!\n", i+1, j+1);
+        nerr++;
+      }
+    }
+  }
+
+  return nerr;
+}
+
+
+/* Edge & Node points in the Faces must be the Edge points exactly */
+static int
+checkFaces(gemModel *model, gemDRep *drep)
+{
+  int      i, j, k, m, t, ix, nerr = 0;
+  double   *xyz, *ref;
+  gemBody  *body;
+  gemTRep  *trep;
+  gemDEdge *edge;
+
+  for (i = 0; i < drep->nBReps; i++) {
+    trep = &drep->TReps[i];
+    body = model->BReps[i]->body;
+    for (j = 0; j < trep->nFaces; j++)
+      for (k = 0; k < trep->Faces[j].npts; k++) {
+        t   = trep->Faces[j].vid[2*k  ];
+        ix  = trep->Faces[j].vid[2*k+1];
+        xyz = &trep->Faces[j].xyzs[3*k];
+        ref = NULL;
+        if (t > 0) {
+          ref = &trep->Edges[ix-1].xyzs[3*t-3];
+        } else if (t == 0) {
+          for (m = 0; m < body->nedge; m++) {
+            edge = &trep->Edges[m];
+            if (body->edges[m].nodes[0] == ix) ref = edge->xyzs;
+            if (body->edges[m].nodes[1] == ix)
+              ref = &edge->xyzs[3*edge->npts-3];
+            if (ref != NULL) break;
+          }
+        }
+        if (ref == NULL) continue;
+        if (memcmp(xyz, ref, 3*sizeof(double)) != 0) {
+          printf(" BRep %d: Face %d point %d is off its Edge/Node!\n",
+                 i+1, j+1, k+1);
+          nerr++;
+          break;
+        }
+      }
+  }
+
+  return nerr;
+}
+
+
+/* the profile is only there when built with GEM_PROFILE */
+static int
+checkProfile(gemCntxt *context)
+{
+  int        stat;
+  gemProfile profile;
+
+  stat = gem_getProfile(context, 1, &profile);
+#ifdef GEM_PROFILE
+  printf(" gem_getProfile = %d  (%lld tessellations in %lf secs)\n", stat,
+         profile.calls[GEM_PTESSEL], profile.seconds[GEM_PTESSEL]);
+  if (stat != GEM_SUCCESS) return 1;
+  if (profile.calls[GEM_PTESSEL] == 0) return 1;
+  stat = gem_getProfile(context, 0, &profile);
+  if ((stat != GEM_SUCCESS) || (profile.calls[GEM_PTESSEL] != 0)) return 1;
+  return 0;
+#else
+  return (stat == GEM_UNSUPPORTED) ? 0 : 1;
+#endif
+}
+
+
+/* change the dimensions of a parametric model and regenerate */
+static int
+checkRegen(gemCntxt *context, double mxside)
+{
+  int      i, stat, nerr = 0;
+  double   size[3] = {2.0, 1.0, 3.0}, radius = 0.25, props[14];
+  gemModel *model;
+  gemDRep  *drep;
+
+  stat = gem_loadModel(context, NULL,
+                       "param box(1,2,0.5)*3 sphere(1) torus(2,0.5)", &model);
+  printf(" parametric gem_loadModel = %d\n", stat);
+  if (stat != GEM_SUCCESS) return 1;
+  stat = gem_newDRep(model, &drep);
+  if (stat == GEM_SUCCESS) stat = gem_tesselDRep(drep, 0, 0.0, mxside, 0.0);
+  if (stat == GEM_SUCCESS) stat = gem_setParam(model, 1, 3, NULL, size,
+                                               NULL, NULL);
+  if (stat == GEM_SUCCESS) stat = gem_setParam(model, 2, 1, NULL, &radius,
+                                               NULL, NULL);
+  if (stat == GEM_SUCCESS) stat = gem_setSuppress(model, 3, GEM_SUPPRESSED);
+  if (stat == GEM_SUCCESS) stat = gem_regenModel(model);
+  printf(" gem_regenModel = %d  (%d BReps)\n", stat, model->nBRep);
+  if (stat != GEM_SUCCESS) {
+    gem_releaseModel(model);
+    return 1;
+  }
+  if (model->nBRep != 4) nerr++;
+
+  /* the DRep is retessellated against the new geometry */
+  stat = gem_tesselDRep(drep, 0, 0.0, mxside, 0.0);
+  if (stat != GEM_SUCCESS) {
+    printf(" regen gem_tesselDRep = %d\n", stat);
+    nerr++;
+  } else {
+    nerr += checkFaces(model, drep);
+  }
+  for (i = 0; i < model->nBRep; i++) {
+    gem_getMassProps(model->BReps[i], GEM_BREP, 0, props);
+    if (i < 3) {
+      if (fabs(props[0]-6.0) > 1.e-12) nerr++;
+    } else {
+      if (fabs(props[0]-4.0*PI*radius*radius*radius/3.0) > 1.e-12) nerr++;
+    }
+  }
+  if (nerr == 0) printf(" regenerated geometry is consistent\n");
+
+  gem_releaseModel(model);
+  return nerr;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int      i, n, stat, nThread, nerr;
+  double   mxside;
+  char     *location;
+  gemCntxt *context;
+  gemModel *model;
+  gemDRep  *serial, *threaded, *single;
+
+  location = "box(1,2,0.5)*40 box*25 plane(2,1)*4 cylinder(0.5,2)*8 sphere*6 torus(2,0.5)*6";
+  nThread  = 4;
+  mxside   = 0.05;
+  if (argc > 1) location = argv[1];
+  if (argc > 2) nThread  = atoi(argv[2]);
+  if (argc > 3) mxside   = atof(argv[3]);
+
+  stat = gem_initialize(&context);
+  printf(" gem_initialize = %d\n", stat);
+  if (stat != GEM_SUCCESS) return 1;
+  stat = gem_loadModel(context, NULL, location, &model);
+  printf(" gem_loadModel  = %d\n", stat);
+  if (stat != GEM_SUCCESS) {
+    gem_terminate(context);
+    return 1;
+  }
+
+  stat = gem_newDRep(model, &serial);
+  if (stat == GEM_SUCCESS) stat = gem_newDRep(model, &threaded);
+  if (stat == GEM_SUCCESS) stat = gem_newDRep(model, &single);
+  if (stat != GEM_SUCCESS) {
+    printf(" gem_newDRep = %d\n", stat);
+    gem_terminate(context);
+    return 1;
+  }
+
+  /* all BReps serially, all BReps threaded and each BRep by itself */
+  gem_setThreads(context, 1);
+  stat = gem_tesselDRep(serial, 0, 0.0, mxside, 0.0);
+  printf(" serial   gem_tesselDRep = %d  (%d BReps)\n", stat, serial->nBReps);
+  gem_setThreads(context, nThread);
+  stat = gem_tesselDRep(threaded, 0, 0.0, mxside, 0.0);
+  printf(" threaded gem_tesselDRep = %d  (%d threads)\n", stat, nThread);
+  for (i = 1; i <= single->nBReps; i++) {
+    stat = gem_tesselDRep(single, i, 0.0, mxside, 0.0);
+    if (stat != GEM_SUCCESS) printf(" BRep %d: gem_tesselDRep = %d\n", i, stat);
+  }
+
+  nerr  = compareTReps(serial, threaded);
+  nerr += compareTReps(serial, single);
+  nerr += checkFaces(model, serial);
+
+  /* instances only hold their own coordinates */
+  for (n = i = 0; i < threaded->nBReps; i++) {
+    if (threaded->TReps[i].owner == 0) continue;
+    if (threaded->TReps[i].Faces[0].tris !=
+        threaded->TReps[threaded->TReps[i].owner-1].Faces[0].tris) nerr++;
+    n++;
+  }
+  printf(" %d of %d BReps share a tessellation\n", n, threaded->nBReps);
+  nerr += checkProfile(context);
+
+  /* redo an owner by itself -- the instances must stay intact */
+  stat = gem_tesselDRep(threaded, 1, 0.0, mxside, 0.0);
+  if (stat != GEM_SUCCESS) printf(" BRep 1: gem_tesselDRep = %d\n", stat);
+  nerr += compareTReps(serial, threaded);
+  if (nerr == 0) {
+    printf(" threaded tessellations are identical to the serial one\n");
+  } else {
+    printf(" %d mismatches!\n", nerr);
+  }
+  nerr += checkRegen(context, mxside);
+
+  gem_terminate(context);
+  return nerr == 0 ? 0 : 1;
+}
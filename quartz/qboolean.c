@@ -155,6 +155,7 @@ gem_kernelSBO(gemID src, gemID tool, /*@null@*/ double *xform, int type,
   mdl->location  = NULL;
   mdl->modeler   = gem_strdup(modeler);
   mdl->nBRep     = vn - v1 + 1;
+  mdl->mBRep     = vn - v1 + 1;
   mdl->BReps     = BReps;
   mdl->nParams   = 0;
   mdl->Params    = NULL;
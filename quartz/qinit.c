@@ -42,6 +42,14 @@ gem_kernelInit()
 }
 
 
+int
+gem_kernelThreadSafe()
+{
+  /* CAPRI is not reentrant -- keep all calls serial */
+  return 0;
+}
+
+
 /*@null@*/ const char *
 gem_kernelError(int code)
 {
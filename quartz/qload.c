@@ -757,6 +757,7 @@ gem_kernelLoad(gemCntxt *gem_cntxt, /*@null@*/ char *server, char *name,
   mdl->location  = gem_strdup(name);
   mdl->modeler   = gem_strdup(modeler);
   mdl->nBRep     = vn - v1 + 1;
+  mdl->mBRep     = vn - v1 + 1;
   mdl->BReps     = BReps;
   mdl->nParams   = 0;
   mdl->Params    = NULL;
@@ -303,6 +303,7 @@ gem_kernelRegen(gemModel *model)
   }
   for (i = 0; i < vn-v1+1; i++) BReps[i]->omodel = model;
   model->nBRep = vn - v1 + 1;
+  model->mBRep = vn - v1 + 1;
   model->BReps = BReps;
 
   mm = gi_fMasterModel(cmdl, 0);
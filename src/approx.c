@@ -18,6 +18,7 @@
 #include "gem.h"
 #include "memory.h"
 #include "connect.h"
+#include "profile.h"
 
 
 #define TOLCOPO         1.e-8   /* Tolerance for coincident points in
@@ -389,6 +390,112 @@ int gem_fillCoeff2D(int nrank, int nux, int nvx, double *fit, double *coeff,
 }
 
 
+/* the cell (lower left knot) holding uv and the local coordinates in it */
+static int gem_cell2D(int nu, int nv, double *uv, double *u, double *v)
+{
+  int l0, l1;
+
+  l0 = (int) uv[0];
+  if (l0 <     0) l0 = 0;
+  if (l0 >= nu-1) l0 = nu-2;
+  *u = uv[0] - (double) l0;
+  l1 = (int) uv[1];
+  if (l1 <     0) l1 = 0;
+  if (l1 >= nv-1) l1 = nv-2;
+  *v = uv[1] - (double) l1;
+
+  return l0 + nu*l1;
+}
+
+
+/*
+ * the power basis coefficients of member i over the cell at knot l0 -- 
+ *   a[4*q+p] multiplies u^p v^q so each power of v is 4 contiguous values
+ *   (the arithmetic is that of gem_eval2D so the results are identical)
+ */
+static void gem_power2D(int nrank, int nu, double *coeff, int l0, int i,
+                        double *a)
+{
+  int    l1, l2, l3;
+  double s0, s1, s2, s3, t0, t1, t2, t3;
+
+  l1 = l0 + 1;
+  l2 = l0 + nu;
+  l3 = l2 + 1;
+
+  s0 = -3.0*coeff[4*nrank*l0        +i]  + 3.0*coeff[4*nrank*l2        +i] -
+        2.0*coeff[4*nrank*l0+2*nrank+i]  -     coeff[4*nrank*l2+2*nrank+i];
+  s1 = -3.0*coeff[4*nrank*l1        +i]  + 3.0*coeff[4*nrank*l3        +i] -
+        2.0*coeff[4*nrank*l1+2*nrank+i]  -     coeff[4*nrank*l3+2*nrank+i];
+  s2 = -3.0*coeff[4*nrank*l0+  nrank+i]  + 3.0*coeff[4*nrank*l2+  nrank+i] -
+        2.0*coeff[4*nrank*l0+3*nrank+i]  -     coeff[4*nrank*l2+3*nrank+i];
+  s3 = -3.0*coeff[4*nrank*l1+  nrank+i]  + 3.0*coeff[4*nrank*l3+  nrank+i] -
+        2.0*coeff[4*nrank*l1+3*nrank+i]  -     coeff[4*nrank*l3+3*nrank+i];
+  t0 =  2.0*coeff[4*nrank*l0        +i]  - 2.0*coeff[4*nrank*l2        +i] +
+            coeff[4*nrank*l0+2*nrank+i]  +     coeff[4*nrank*l2+2*nrank+i];
+  t1 =  2.0*coeff[4*nrank*l1        +i]  - 2.0*coeff[4*nrank*l3        +i] +
+            coeff[4*nrank*l1+2*nrank+i]  +     coeff[4*nrank*l3+2*nrank+i];
+  t2 =  2.0*coeff[4*nrank*l0+  nrank+i]  - 2.0*coeff[4*nrank*l2+  nrank+i] +
+            coeff[4*nrank*l0+3*nrank+i]  +     coeff[4*nrank*l2+3*nrank+i];
+  t3 =  2.0*coeff[4*nrank*l1+  nrank+i]  - 2.0*coeff[4*nrank*l3+  nrank+i] +
+            coeff[4*nrank*l1+3*nrank+i]  +     coeff[4*nrank*l3+3*nrank+i];
+
+  a[ 0] = coeff[4*nrank*l0        +i];
+  a[ 4] = coeff[4*nrank*l0+2*nrank+i];
+  a[ 8] = s0;
+  a[12] = t0;
+  a[ 1] = coeff[4*nrank*l0+  nrank+i];
+  a[ 5] = coeff[4*nrank*l0+3*nrank+i];
+  a[ 9] = s2;
+  a[13] = t2;
+  a[ 2] = -3.0*coeff[4*nrank*l0        +i]  + 3.0*coeff[4*nrank*l1        +i] -
+           2.0*coeff[4*nrank*l0+  nrank+i]  -     coeff[4*nrank*l1+  nrank+i];
+  a[ 6] = -3.0*coeff[4*nrank*l0+2*nrank+i]  + 3.0*coeff[4*nrank*l1+2*nrank+i] -
+           2.0*coeff[4*nrank*l0+3*nrank+i]  -     coeff[4*nrank*l1+3*nrank+i];
+  a[10] = -3.0*s0 + 3.0*s1 - 2.0*s2 - s3;
+  a[14] = -3.0*t0 + 3.0*t1 - 2.0*t2 - t3;
+  a[ 3] =  2.0*coeff[4*nrank*l0        +i]  - 2.0*coeff[4*nrank*l1        +i] +
+               coeff[4*nrank*l0+  nrank+i]  +     coeff[4*nrank*l1+  nrank+i];
+  a[ 7] =  2.0*coeff[4*nrank*l0+2*nrank+i]  - 2.0*coeff[4*nrank*l1+2*nrank+i] +
+               coeff[4*nrank*l0+3*nrank+i]  +     coeff[4*nrank*l1+3*nrank+i];
+  a[11] =  2.0*s0 - 2.0*s1 + s2 + s3;
+  a[15] =  2.0*t0 - 2.0*t1 + t2 + t3;
+}
+
+
+/*
+ * evaluates a power basis block -- the 4 rows in u are done together
+ *   (a 4-wide vector operation over contiguous data)
+ */
+static void gem_horner2D(const double *a, double u, double v, double *sv,
+                         /*@null@*/ double *du,  /*@null@*/ double *dv,
+                         /*@null@*/ double *duu, /*@null@*/ double *duv,
+                         /*@null@*/ double *dvv)
+{
+  int    p;
+  double s[4];
+
+  for (p = 0; p < 4; p++)
+    s[p] = a[p] + v*(a[4+p] + v*(a[8+p] + v*a[12+p]));
+  *sv = s[0] + u*(s[1] + u*(s[2] + u*s[3]));
+  if (du  != NULL) *du  = s[1] + u*(2.0*s[2] + 3.0*u*s[3]);
+  if (duu != NULL) *duu =          2.0*s[2] + 6.0*u*s[3];
+
+  if ((dv != NULL) || (duv != NULL)) {
+    for (p = 0; p < 4; p++)
+      s[p] = a[4+p] + v*(2.0*a[8+p] + 3.0*v*a[12+p]);
+    if (dv  != NULL) *dv  = s[0] + u*(s[1] + u*(s[2] +u*s[3]));
+    if (duv != NULL) *duv = s[1] + u*(2.0*s[2] + 3.0*u*s[3]);
+  }
+
+  if (dvv != NULL) {
+    for (p = 0; p < 4; p++)
+      s[p] = 2.0*a[8+p] + 6.0*v*a[12+p];
+    *dvv = s[0] + u*(s[1] + u*(s[2] + u*s[3]));
+  }
+}
+
+
 static void gem_eval2D(int nrank, int nu, int nv, double *coeff, 
                        double *uv, double *sv, /*@null@*/ double *du,  
                        /*@null@*/ double *dv,  /*@null@*/ double *duu, 
@@ -484,6 +591,7 @@ static void gem_eval2D(int nrank, int nu, int nv, double *coeff,
 }
 
 
+
 static int gem_newton2D(int nrank, int nu, int nv, double *coeff, double *sv, 
                         double *uv, double *tmp)
 {
@@ -528,8 +636,212 @@ static int gem_newton2D(int nrank, int nu, int nv, double *coeff, double *sv,
 }
 
 
+static void gem_freeKnotHash(/*@null@*/ /*@only@*/ gemKnotHash *hash)
+{
+  if (hash == NULL) return;
+  if (hash->start != NULL) gem_free(hash->start);
+  if (hash->knots != NULL) gem_free(hash->knots);
+  gem_free(hash);
+}
+
+
+static int gem_knotCell(gemKnotHash *hash, int d, double x)
+{
+  double t;
+
+  if (hash->del[d] <= 0.0) return 0;
+  t = (x - hash->lo[d])/hash->del[d];
+  if (!(t > 0.0)) return 0;
+  if (t >= (double) hash->ncell[d]) return hash->ncell[d]-1;
+  return (int) t;
+}
+
+
+/*
+ * bins the knot positions (the first 3 members of the state-vector) into
+ *   uniform cells -- twice as many cells as knots since the knots of a 
+ *   surface only fill a thin layer of the box
+ */
+static /*@null@*/ gemKnotHash *gem_knotHash(int nrank, int nu, int nv,
+                                            double *coeff)
+{
+  int         i, d, m, n, nk, ncells, c[3], *count;
+  double      x, h, emax, target, hi[3], ext[3];
+  gemKnotHash *hash;
+
+  nk   = nu*nv;
+  hash = (gemKnotHash *) gem_allocate(sizeof(gemKnotHash));
+  if (hash == NULL) return NULL;
+  hash->ndim  = nrank;
+  if (hash->ndim > 3) hash->ndim = 3;
+  hash->start = NULL;
+  hash->knots = NULL;
+
+  for (d = 0; d < 3; d++) {
+    hash->ncell[d] = 1;
+    hash->lo[d]    = hash->del[d] = hi[d] = ext[d] = 0.0;
+  }
+  for (d = 0; d < hash->ndim; d++) {
+    hash->lo[d] = hi[d] = coeff[d];
+    for (i = 1; i < nk; i++) {
+      x = coeff[4*nrank*i+d];
+      if (x < hash->lo[d]) hash->lo[d] = x;
+      if (x > hi[d])       hi[d]       = x;
+    }
+  }
+
+  /* flat directions get a single cell */
+  emax = 0.0;
+  for (d = 0; d < hash->ndim; d++) 
+    if (hi[d]-hash->lo[d] > emax) emax = hi[d]-hash->lo[d];
+  for (m = d = 0; d < hash->ndim; d++)
+    if (hi[d]-hash->lo[d] > 1.e-3*emax) {
+      ext[d] = hi[d]-hash->lo[d];
+      m++;
+    }
+
+  if (m != 0) {
+    target = 2.0*nk;
+    for (h = 1.0, d = 0; d < 3; d++)
+      if (ext[d] > 0.0) h *= ext[d];
+    h = pow(h/target, 1.0/m);
+    do {
+      for (ncells = 1, d = 0; d < 3; d++) {
+        hash->ncell[d] = 1;
+        if (ext[d] > 0.0) {
+          x = ext[d]/h + 0.5;
+          if (x > 4.0*nk) x = 4.0*nk;
+          if (x > 1.0) hash->ncell[d] = (int) x;
+        }
+        ncells *= hash->ncell[d];
+      }
+      h *= 1.5;
+    } while (ncells > 4*nk+1);
+    for (d = 0; d < 3; d++)
+      if (ext[d] > 0.0) hash->del[d] = ext[d]/hash->ncell[d];
+  }
+  ncells = hash->ncell[0]*hash->ncell[1]*hash->ncell[2];
+
+  /* counting sort of the knots -- stable so each cell is in knot order */
+  hash->start = (int *) gem_allocate((ncells+1)*sizeof(int));
+  hash->knots = (int *) gem_allocate(nk*sizeof(int));
+  count       = (int *) gem_allocate(nk*sizeof(int));
+  if ((hash->start == NULL) || (hash->knots == NULL) || (count == NULL)) {
+    if (count != NULL) gem_free(count);
+    gem_freeKnotHash(hash);
+    return NULL;
+  }
+  for (i = 0; i <= ncells; i++) hash->start[i] = 0;
+  for (i = 0; i < nk; i++) {
+    for (d = 0; d < 3; d++) c[d] = 0;
+    for (d = 0; d < hash->ndim; d++) 
+      c[d] = gem_knotCell(hash, d, coeff[4*nrank*i+d]);
+    n        = c[0] + hash->ncell[0]*(c[1] + hash->ncell[1]*c[2]);
+    count[i] = n;
+    hash->start[n+1]++;
+  }
+  for (i = 0; i < ncells; i++) hash->start[i+1] += hash->start[i];
+  for (i = 0; i < nk; i++) {
+    n = count[i];
+    hash->knots[hash->start[n]] = i;
+    hash->start[n]++;
+  }
+  for (i = ncells; i > 0; i--) hash->start[i] = hash->start[i-1];
+  hash->start[0] = 0;
+  gem_free(count);
+
+  return hash;
+}
+
+
+/*
+ * finds the closest knot by searching rings of cells about the one holding 
+ *   sv -- the same knot (lowest index on ties) as a full scan
+ */
+static void gem_closeKnot(gemKnotHash *hash, int nrank, int nu, double *coeff,
+                          double *sv, double *cu, double *cv, double *dis0)
+{
+  int    i, j, k, l, d, r, n, best, c[3], lo[3], hi[3], ic[3];
+  double dis, gap, lb;
+
+  for (d = 0; d < 3; d++) c[d] = 0;
+  for (d = 0; d < hash->ndim; d++) c[d] = gem_knotCell(hash, d, sv[d]);
+  best  = -1;
+  *dis0 = DBL_MAX;
+
+  for (r = 0; ; r++) {
+    for (d = 0; d < 3; d++) {
+      lo[d] = c[d] - r;
+      hi[d] = c[d] + r;
+      if (lo[d] < 0)              lo[d] = 0;
+      if (hi[d] >= hash->ncell[d]) hi[d] = hash->ncell[d]-1;
+    }
+    for (ic[2] = lo[2]; ic[2] <= hi[2]; ic[2]++)
+      for (ic[1] = lo[1]; ic[1] <= hi[1]; ic[1]++)
+        for (ic[0] = lo[0]; ic[0] <= hi[0]; ic[0]++) {
+          /* only the shell -- the inside was done on earlier rings */
+          if ((abs(ic[0]-c[0]) < r) && (abs(ic[1]-c[1]) < r) &&
+              (abs(ic[2]-c[2]) < r)) continue;
+          n = ic[0] + hash->ncell[0]*(ic[1] + hash->ncell[1]*ic[2]);
+          for (l = hash->start[n]; l < hash->start[n+1]; l++) {
+            i   = hash->knots[l];
+            dis = 0.0;
+            for (k = 0; k < nrank; k++)
+              dis += (coeff[4*nrank*i+k]-sv[k])*(coeff[4*nrank*i+k]-sv[k]);
+            if ((dis < *dis0) || ((dis == *dis0) && (i < best))) {
+              *dis0 = dis;
+              best  = i;
+            }
+          }
+        }
+
+    /* any knot not yet seen is at least lb away */
+    lb = DBL_MAX;
+    for (d = 0; d < hash->ndim; d++) {
+      if (c[d]-r > 0) {
+        gap = sv[d] - (hash->lo[d] + (c[d]-r)*hash->del[d]);
+        if (gap < lb) lb = gap;
+      }
+      if (c[d]+r < hash->ncell[d]-1) {
+        gap = hash->lo[d] + (c[d]+r+1)*hash->del[d] - sv[d];
+        if (gap < lb) lb = gap;
+      }
+    }
+    if (lb == DBL_MAX) break;
+    if ((lb > 0.0) && (*dis0 < lb*lb)) break;
+  }
+
+  if (best < 0) return;
+  j   = best/nu;
+  *cu = (double) (best - j*nu);
+  *cv = (double) j;
+}
+
+
+/*
+ * hashes the spline (and mapping) knots for the inverse evaluations -- 
+ *   called once the coefficients are filled
+ */
+int gem_Aprx2DHash(gemAprx2D *approx)
+{
+  gem_freeKnotHash(approx->khash);
+  gem_freeKnotHash(approx->mhash);
+  approx->khash = approx->mhash = NULL;
+
+  approx->khash = gem_knotHash(approx->nrank, approx->nus, approx->nvs,
+                               approx->interp);
+  if (approx->khash == NULL) return GEM_ALLOC;
+  if (approx->uvmap == NULL) return GEM_SUCCESS;
+  approx->mhash = gem_knotHash(2, approx->num, approx->nvm, approx->uvmap);
+  if (approx->mhash == NULL) return GEM_ALLOC;
+
+  return GEM_SUCCESS;
+}
+
+
 static void gem_invEval2D(int nrank, int nux, int nvx, double *coeff, 
-                          double *sv, double *uv, double *tmp)
+                          /*@null@*/ gemKnotHash *hash, double *sv, double *uv,
+                          double *tmp)
 {
   /* NOTE: tmp must be at least 6*nrank in length */
   int    i, j, k, l, ik, jk, nu, nv;
@@ -542,18 +854,22 @@ static void gem_invEval2D(int nrank, int nux, int nvx, double *coeff,
   cu   = cv = 0.0;
   dis0 = DBL_MAX;
 
-  for (j = 0; j < nv; j++)
-    for (i = 0; i < nu; i++) {
-      dis = 0.0;
-      for (k = 0; k < nrank; k++)
-        dis += (coeff[4*nrank*(j*nu+i)+k]-sv[k])*
-               (coeff[4*nrank*(j*nu+i)+k]-sv[k]);
-      if (dis < dis0) {
-         dis0 = dis;
-         cu   = (double) i;
-         cv   = (double) j;
+  if (hash != NULL) {
+    gem_closeKnot(hash, nrank, nu, coeff, sv, &cu, &cv, &dis0);
+  } else {
+    for (j = 0; j < nv; j++)
+      for (i = 0; i < nu; i++) {
+        dis = 0.0;
+        for (k = 0; k < nrank; k++)
+          dis += (coeff[4*nrank*(j*nu+i)+k]-sv[k])*
+                 (coeff[4*nrank*(j*nu+i)+k]-sv[k]);
+        if (dis < dis0) {
+           dis0 = dis;
+           cu   = (double) i;
+           cv   = (double) j;
+        }
       }
-    }
+  }
 
   stepu = stepv = 1.0;
   for (l = 0; l < 20; l++) {
@@ -814,52 +1130,17 @@ int gem_Interp1DFit(int nrank, int npts, /*@null@*/ double *tx, double *values,
 static int
 gem_triFill(int npts, int ntris, int *tris, prmTri *vtris)
 {
-  int      i, j, *vtab, nside;
-  gemNeigh *etab;
-  
-  vtab = (int *) gem_allocate(npts*sizeof(int));
-  if (vtab == NULL) {
-    printf(" GEM Error: Vert Table Malloc (gem_triFill)!\n");
-    return GEM_ALLOC;    
-  }
-  etab = (gemNeigh *) gem_allocate(ntris*3*sizeof(gemNeigh));
-  if (etab == NULL) {
-    printf(" GEM Error: Side Table Malloc (gem_triFill)!\n");
-    gem_free(vtab);
-    return GEM_ALLOC;    
-  }
+  int i;
 
   for (i = 0; i < ntris; i++) {
     vtris[i].indices[0] = tris[3*i  ];
     vtris[i].indices[1] = tris[3*i+1];
     vtris[i].indices[2] = tris[3*i+2];
-    vtris[i].neigh[0]   = i+1;
-    vtris[i].neigh[1]   = i+1;
-    vtris[i].neigh[2]   = i+1;
     vtris[i].own        = 1;
   }
-  nside = NOTFILLED;
-  for (j = 0; j < npts; j++) vtab[j] = NOTFILLED;
-  for (i = 0; i < ntris;  i++) {
-    gem_fillNeighbor( vtris[i].indices[1], vtris[i].indices[2],
-                     &vtris[i].neigh[0], &nside, vtab, etab);
-    gem_fillNeighbor( vtris[i].indices[0], vtris[i].indices[2], 
-                     &vtris[i].neigh[1], &nside, vtab, etab);
-    gem_fillNeighbor( vtris[i].indices[0], vtris[i].indices[1],
-                     &vtris[i].neigh[2], &nside, vtab, etab);
-  }
-                   
-  /* find any unconnected triangle sides */
-  for (j = 0; j <= nside; j++) {
-    if (etab[j].tri == NULL) continue;
-/*  printf(" GEM Info: Unconnected Side %d %d = %d\n",
-           etab[j].node1+1, etab[j].node2+1, *etab[j].tri); */
-    *etab[j].tri = 0;
-  }
-
-  gem_free(etab);
-  gem_free(vtab);
-  return GEM_SUCCESS;
+
+  /* unconnected triangle sides are zeroed */
+  return gem_triNeighbors(1, npts, ntris, vtris);
 }
 
 
@@ -921,7 +1202,9 @@ int gem_Interp2DFit(int nrank, int npts, double *uvx, double *values,
   /* make the fit */
 
   periodic = 0;
+  GEM_PROFBEG(GEM_PSMOOTHUV);
   stat = prm_SmoothUV(2, periodic, NULL, ntris, vtris, npts, nrank, uvs, values);
+  GEM_PROFEND(GEM_PSMOOTHUV);
   gem_free(vtris);
   if ((stat != GEM_SUCCESS) && (stat != PRM_NOTCONVERGED)) {
     printf(" gem_Interp2DFit: prm_SmoothUV = %d!\n", stat);
@@ -940,8 +1223,10 @@ int gem_Interp2DFit(int nrank, int npts, double *uvx, double *values,
     return GEM_NOTFOUND;
   }
   nu   = npts;
-  stat = prm_BestGrid(npts, nrank, uvs, values, 0, NULL, tol, periodic, NULL,
+  GEM_PROFBEG(GEM_PBESTGRID);
+  stat = prm_BestGrid(npts, nrank, uvs, values, 0, NULL, tol, periodic, NULL, 1,
                       &nu, &nv, &fit, &rmserr, &maxerr, &dotmin);
+  GEM_PROFEND(GEM_PBESTGRID);
 #ifdef DEBUG
   printf(" gem_Interp2DFit: prm_BestGrid Values errors = %d  %d %d  %lf %lf\n",
          stat, nu, nv, rmserr, maxerr);
@@ -958,8 +1243,10 @@ int gem_Interp2DFit(int nrank, int npts, double *uvx, double *values,
     return GEM_NULLOBJ;
   }
   num  = 1.5*npts;
-  stat = prm_BestGrid(npts, 2, uvs, uvx, 0, NULL, tol, periodic,  NULL,
+  GEM_PROFBEG(GEM_PBESTGRID);
+  stat = prm_BestGrid(npts, 2, uvs, uvx, 0, NULL, tol, periodic,  NULL, 1,
                       &num, &nvm, &uvfit, &rmserr, &maxerr, &dotmin);
+  GEM_PROFEND(GEM_PBESTGRID);
 #ifdef DEBUG
   printf(" gem_Interp2DFit: prm_BestGrid UVs    errors = %d  %d %d  %lf %lf\n",
          stat, num, nvm, rmserr, maxerr);
@@ -1056,9 +1343,11 @@ int gem_Interp2DFit(int nrank, int npts, double *uvx, double *values,
   interp->num       = num;
   interp->nvm       = nvm;
   interp->uvmap     = uvmap;
+  interp->khash     = NULL;
+  interp->mhash     = NULL;
   
   gem_free(uvs);
-  return GEM_SUCCESS;
+  return gem_Aprx2DHash(interp);
 }
 
 
@@ -1090,13 +1379,17 @@ int gem_Interpolate1D(gemAprx1D *interp, double tx, double *sv,
 }
 
 
-int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
-                      /*@null@*/ double *du,  /*@null@*/ double *dv,
-                      /*@null@*/ double *duu, /*@null@*/ double *duv,
-                      /*@null@*/ double *dvv)
+/*
+ * a single (mapped) evaluation -- store must be 5*nrank in length when any
+ *   derivative is requested
+ */
+static void gem_interp2DPoint(gemAprx2D *interp, double *uvx, double *sv,
+                              /*@null@*/ double *du,  /*@null@*/ double *dv,
+                              /*@null@*/ double *duu, /*@null@*/ double *duv,
+                              /*@null@*/ double *dvv, /*@null@*/ double *store)
 {
   int    i, nrank;
-  double uvn[2], uv[2], tmp[12], *store;
+  double uvn[2], uv[2], tmp[12];
 #ifdef DIFFERENCE
   double step = 1.e-5;
 #else
@@ -1107,21 +1400,20 @@ int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
   if (interp->uvmap == NULL) {
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uvx, sv,
                du, dv, duu, duv, dvv);
-    return GEM_SUCCESS;
+    return;
   }
 
-  gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, uvx, uvn, tmp);
-  uv[0] = (interp->nus-1)*uvn[0]/(interp->num-1);
-  uv[1] = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
+  gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, interp->mhash,
+                uvx, uvn, tmp);
+  uv[0]   = (interp->nus-1)*uvn[0]/(interp->num-1);
+  uv[1]   = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
   if ((du == NULL) && (dv == NULL) && (duu == NULL) && 
                                       (duv == NULL) && (dvv == NULL)) {
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uv, sv,
                NULL, NULL, NULL, NULL, NULL);
-    return GEM_SUCCESS;
+    return;
   }
-
-  store = (double *) gem_allocate(nrank*5*sizeof(double));
-  if (store == NULL) return GEM_ALLOC;
+  if (store == NULL) return;
 
 #ifndef DIFFERENCE
 
@@ -1175,14 +1467,16 @@ int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
   if ((du != NULL) || (duu != NULL) || (duv != NULL)) {
     uv[0] = uvx[0] - step;
     uv[1] = uvx[1];
-    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, uv, uvn, tmp);
+    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, interp->mhash,
+                  uv, uvn, tmp);
     uv[0] = (interp->nus-1)*uvn[0]/(interp->num-1);
     uv[1] = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uv, &store[0],
                NULL, NULL, NULL, NULL, NULL);
     uv[0] = uvx[0] + step;
     uv[1] = uvx[1];
-    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, uv, uvn, tmp);
+    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, interp->mhash,
+                  uv, uvn, tmp);
     uv[0] = (interp->nus-1)*uvn[0]/(interp->num-1);
     uv[1] = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uv,
@@ -1201,14 +1495,16 @@ int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
   if ((dv != NULL) || (duv != NULL) || (dvv != NULL)) {
     uv[0] = uvx[0];
     uv[1] = uvx[1] - step;
-    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, uv, uvn, tmp);
+    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, interp->mhash,
+                  uv, uvn, tmp);
     uv[0] = (interp->nus-1)*uvn[0]/(interp->num-1);
     uv[1] = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uv,
                &store[2*nrank], NULL, NULL, NULL, NULL, NULL);
     uv[0] = uvx[0];
     uv[1] = uvx[1] + step;
-    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, uv, uvn, tmp);
+    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, interp->mhash,
+                  uv, uvn, tmp);
     uv[0] = (interp->nus-1)*uvn[0]/(interp->num-1);
     uv[1] = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uv,
@@ -1227,7 +1523,8 @@ int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
   if (duv != NULL) {
     uv[0] = uvx[0] + step;
     uv[1] = uvx[1] + step;
-    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, uv, uvn, tmp);
+    gem_invEval2D(2, interp->num, interp->nvm, interp->uvmap, interp->mhash,
+                  uv, uvn, tmp);
     uv[0] = (interp->nus-1)*uvn[0]/(interp->num-1);
     uv[1] = (interp->nvs-1)*uvn[1]/(interp->nvm-1);
     gem_eval2D(nrank, interp->nus, interp->nvs, interp->interp, uv,
@@ -1237,12 +1534,88 @@ int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
                                                 store[3*nrank+i]) / step;
   }
 #endif
+}
+
+
+/*
+ * evaluates a list of uvs -- point i is written to sv[stride*i] (and the
+ *   same place in each non-NULL derivative array) so the results can go 
+ *   straight into interleaved storage; stride must be at least nrank
+ *
+ * the power basis of a cell is kept while the points stay in it, so
+ *   ordered (tessellation) input mostly costs the Horner step alone; every
+ *   point goes through Horner (and the mapping inverse is cold started) so
+ *   a point's value does not depend on how the list is split up
+ */
+int gem_Interpolate2DBatch(gemAprx2D *interp, int npts, double *uvx,
+                           int stride, double *sv,
+                           /*@null@*/ double *du,  /*@null@*/ double *dv,
+                           /*@null@*/ double *duu, /*@null@*/ double *duv,
+                           /*@null@*/ double *dvv)
+{
+  int    i, j, k, l0, cell, nrank;
+  double u, v, local[64], *blk, *store = NULL;
+
+  nrank = interp->nrank;
+  if (stride < nrank) return GEM_BADVALUE;
+
+  if (interp->uvmap == NULL) {
+    blk = local;
+    if (nrank > 4) {
+      blk = (double *) gem_allocate(16*nrank*sizeof(double));
+      if (blk == NULL) return GEM_ALLOC;
+    }
+    for (cell = -1, i = 0; i < npts; i++) {
+      j  = stride*i;
+      l0 = gem_cell2D(interp->nus, interp->nvs, &uvx[2*i], &u, &v);
+      if (l0 != cell) {
+        for (k = 0; k < nrank; k++)
+          gem_power2D(nrank, interp->nus, interp->interp, l0, k, &blk[16*k]);
+        cell = l0;
+      }
+      for (k = 0; k < nrank; k++, j++)
+        gem_horner2D(&blk[16*k], u, v, &sv[j], (du  == NULL) ? NULL : &du[j],
+                                               (dv  == NULL) ? NULL : &dv[j],
+                                               (duu == NULL) ? NULL : &duu[j],
+                                               (duv == NULL) ? NULL : &duv[j],
+                                               (dvv == NULL) ? NULL : &dvv[j]);
+    }
+    if (blk != local) gem_free(blk);
+    return GEM_SUCCESS;
+  }
+
+  if ((interp->uvmap != NULL) && ((du  != NULL) || (dv  != NULL) || 
+                                  (duu != NULL) || (duv != NULL) ||
+                                  (dvv != NULL))) {
+    store = (double *) gem_allocate(nrank*5*sizeof(double));
+    if (store == NULL) return GEM_ALLOC;
+  }
+
+  for (i = 0; i < npts; i++) {
+    j = stride*i;
+    gem_interp2DPoint(interp, &uvx[2*i], &sv[j],
+                      (du  == NULL) ? NULL : &du[j],
+                      (dv  == NULL) ? NULL : &dv[j],
+                      (duu == NULL) ? NULL : &duu[j],
+                      (duv == NULL) ? NULL : &duv[j],
+                      (dvv == NULL) ? NULL : &dvv[j], store);
+  }
 
-  gem_free(store);
+  if (store != NULL) gem_free(store);
   return GEM_SUCCESS;
 }
 
 
+int gem_Interpolate2D(gemAprx2D *interp, double *uvx, double *sv,
+                      /*@null@*/ double *du,  /*@null@*/ double *dv,
+                      /*@null@*/ double *duu, /*@null@*/ double *duv,
+                      /*@null@*/ double *dvv)
+{
+  return gem_Interpolate2DBatch(interp, 1, uvx, interp->nrank, sv,
+                                du, dv, duu, duv, dvv);
+}
+
+
 int gem_Aprx1DFree(gemAprx1D *approx)
 {
   if (approx->interp != NULL) gem_free(approx->interp);
@@ -1258,8 +1631,12 @@ int gem_Aprx2DFree(gemAprx2D *approx)
 {
   if (approx->interp != NULL) gem_free(approx->interp);
   if (approx->uvmap  != NULL) gem_free(approx->uvmap);
+  gem_freeKnotHash(approx->khash);
+  gem_freeKnotHash(approx->mhash);
   approx->interp = NULL;
   approx->uvmap  = NULL;
+  approx->khash  = NULL;
+  approx->mhash  = NULL;
 
   return GEM_SUCCESS;
 }
@@ -1281,9 +1658,14 @@ int gem_invInterpolate1D(gemAprx1D *interp, double *sv, double *t)
 }
 
 
-int gem_invInterpolate2D(gemAprx2D *interp, double *sv, double *uv)
+/*
+ * inverse evaluates a list of points -- each starts from its own closest
+ *   knot so the result does not depend on its neighbors in the list
+ */
+int gem_invInterpolate2DBatch(gemAprx2D *interp, int npts, double *sv,
+                              double *uv)
 {
-  int    nrank, nux, nvx;
+  int    i, nrank, nux, nvx;
   double uvx[2], *tmp;
 
   nrank = interp->nrank;
@@ -1293,15 +1675,27 @@ int gem_invInterpolate2D(gemAprx2D *interp, double *sv, double *uv)
   nvx   = interp->nvs;
   if ((interp->periodic & 1) != 0) nux = -nux;
   if ((interp->periodic & 2) != 0) nvx = -nvx;
-  gem_invEval2D(nrank, nux, nvx, interp->interp, sv, uv, tmp);
-  gem_free(tmp);
-  if (interp->uvmap != NULL) {
-    uvx[0]  = uv[0]*(interp->num-1);
-    uvx[0] /=        interp->nus-1;
-    uvx[1]  = uv[1]*(interp->nvm-1);
-    uvx[1] /=        interp->nvs-1;
-    gem_eval2D(2, interp->num, interp->nvm, interp->uvmap, uvx, uv, NULL, NULL,
-               NULL, NULL, NULL);
+
+  for (i = 0; i < npts; i++) {
+    gem_invEval2D(nrank, nux, nvx, interp->interp, interp->khash,
+                  &sv[nrank*i], &uv[2*i], tmp);
+    if (interp->uvmap != NULL) {
+      uvx[0]  = uv[2*i  ]*(interp->num-1);
+      uvx[0] /=           interp->nus-1;
+      uvx[1]  = uv[2*i+1]*(interp->nvm-1);
+      uvx[1] /=           interp->nvs-1;
+      gem_eval2D(2, interp->num, interp->nvm, interp->uvmap, uvx, &uv[2*i],
+                 NULL, NULL, NULL, NULL, NULL);
+    }
   }
-  return gem_Interpolate2D(interp, uv, sv, NULL, NULL, NULL, NULL, NULL);
+  gem_free(tmp);
+
+  return gem_Interpolate2DBatch(interp, npts, uv, nrank, sv,
+                                NULL, NULL, NULL, NULL, NULL);
+}
+
+
+int gem_invInterpolate2D(gemAprx2D *interp, double *sv, double *uv)
+{
+  return gem_invInterpolate2DBatch(interp, 1, sv, uv);
 }
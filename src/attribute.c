@@ -17,6 +17,10 @@
 #include "memory.h"
 
 
+  extern void gem_memCount(gemMemReport *report, int cat, 
+                           /*@null@*/ const void *ptr);
+
+
 int
 gem_getAttrib(/*@null@*/ gemAttrs *attr, int aindex, char **name, int *atype,
               int *alen, int **integers, double **reals, char **string)
@@ -239,6 +243,25 @@ gem_clrAttribs(gemAttrs **attrx)
 }
 
 
+void
+gem_memAttribs(/*@null@*/ gemAttrs *attr, int cat, gemMemReport *report)
+{
+  int i;
+
+  if (attr == NULL) return;
+
+  for (i = 0; i < attr->nattrs; i++) {
+    gem_memCount(report, cat, attr->attrs[i].name);
+    gem_memCount(report, cat, attr->attrs[i].integers);
+    gem_memCount(report, cat, attr->attrs[i].reals);
+    if (attr->attrs[i].type != GEM_POINTER)
+      gem_memCount(report, cat, attr->attrs[i].string);
+  }
+  gem_memCount(report, cat, attr->attrs);
+  gem_memCount(report, cat, attr);
+}
+
+
 void
 gem_cpyAttribs(gemAttrs *attrs, gemAttrs **attrx)
 {
@@ -22,6 +22,17 @@
 
   extern void gem_drepManagerClose();
   extern void gem_exactInit();
+  extern int  gem_nProcessors();
+  extern int  gem_memAllocator(/*@null@*/ gemAllocator *alloc);
+  extern int  gem_memActive();
+  extern void gem_memStats(int reset, gemMemStats *stats);
+  extern void gem_memCount(gemMemReport *report, int cat,
+                           /*@null@*/ const void *ptr);
+  extern void gem_memModel(gemModel *model, gemMemReport *report);
+  extern void gem_memBRep(gemBRep *brep, gemMemReport *report);
+  extern void gem_memDRep(gemDRep *drep, int bound, gemMemReport *report);
+  extern void gem_profInit(gemCntxt *cntxt);
+  extern void gem_profFree(gemCntxt *cntxt);
 
 
 int 
@@ -41,16 +52,61 @@ gem_initialize(gemCntxt **context)
   cntxt = (gemCntxt *) gem_allocate(sizeof(gemCntxt));
   if (cntxt == NULL) return GEM_ALLOC;
 
-  cntxt->magic = GEM_MCONTEXT;
-  cntxt->model = NULL;
-  cntxt->drep  = NULL;
-  cntxt->attr  = NULL;
+  cntxt->magic   = GEM_MCONTEXT;
+  cntxt->model   = NULL;
+  cntxt->drep    = NULL;
+  cntxt->attr    = NULL;
+  cntxt->nThread = 1;
+  cntxt->alloc   = 0;
+  gem_profInit(cntxt);
 
   *context = cntxt;
   return GEM_SUCCESS;
 }
 
 
+int
+gem_setThreads(gemCntxt *cntxt, int nThread)
+{
+  if (cntxt == NULL) return GEM_NULLOBJ;
+  if (cntxt->magic != GEM_MCONTEXT) return GEM_BADCONTEXT;
+  if (nThread < 0) return GEM_BADVALUE;
+  
+  if (nThread == 0) nThread = gem_nProcessors();
+  cntxt->nThread = nThread;
+  
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_setAllocator(gemCntxt *cntxt, /*@null@*/ gemAllocator *alloc)
+{
+  int slot;
+
+  if (cntxt == NULL) return GEM_NULLOBJ;
+  if (cntxt->magic != GEM_MCONTEXT) return GEM_BADCONTEXT;
+
+  slot = gem_memAllocator(alloc);
+  if (slot < 0) return slot;
+  cntxt->alloc = slot;
+
+  return GEM_SUCCESS;
+}
+
+
+int
+gem_getMemStats(gemCntxt *cntxt, int reset, gemMemStats *stats)
+{
+  if (cntxt == NULL) return GEM_NULLOBJ;
+  if (cntxt->magic != GEM_MCONTEXT) return GEM_BADCONTEXT;
+  if (stats == NULL) return GEM_NULLVALUE;
+
+  gem_memStats(reset, stats);
+  return GEM_SUCCESS;
+}
+
+
 int
 gem_staticModel(gemCntxt *cntxt, gemModel **model)
 {
@@ -74,6 +130,7 @@ gem_staticModel(gemCntxt *cntxt, gemModel **model)
   mdl->location  = NULL;
   mdl->modeler   = NULL;
   mdl->nBRep     = 0;
+  mdl->mBRep     = 0;
   mdl->BReps     = NULL;
   mdl->nParams   = 0;
   mdl->Params    = NULL;
@@ -120,6 +177,10 @@ gem_terminate(gemCntxt *cntxt)
   while (cntxt->model != NULL) gem_releaseModel(cntxt->model);
   gem_clrAttribs(&cntxt->attr);
 
+  /* done with its allocator -- back to malloc unless another took over */
+  if ((cntxt->alloc != 0) && (cntxt->alloc == gem_memActive()))
+    gem_memAllocator(NULL);
+  gem_profFree(cntxt);
   cntxt->magic = 0;
   gem_free(cntxt);
   gem_nContext--;
@@ -404,6 +465,51 @@ gem_getObject(void *obj, int *otype, int *nattr)
 }
 
 
+int
+gem_memoryReport(void *obj, int ibound, gemMemReport *report)
+{
+  int      i;
+  gemCntxt *cntxt;
+  gemModel *model;
+  gemBRep  *brep;
+  gemDRep  *drep;
+
+  if (obj == NULL) return GEM_NULLOBJ;
+  if (report == NULL) return GEM_NULLVALUE;
+  for (i = 0; i < GEM_NMEMCAT; i++) {
+    report->bytes[i] = 0;
+    report->count[i] = 0;
+  }
+  cntxt = (gemCntxt *) obj;
+  model = (gemModel *) obj;
+  brep  = (gemBRep *)  obj;
+  drep  = (gemDRep *)  obj;
+
+  if (cntxt->magic == GEM_MCONTEXT) {
+    for (model = cntxt->model; model != NULL; model = model->next)
+      gem_memModel(model, report);
+    for (drep = cntxt->drep; drep != NULL; drep = drep->next)
+      gem_memDRep(drep, 0, report);
+    gem_memAttribs(cntxt->attr, GEM_MEMOTHER, report);
+    gem_memCount(report, GEM_MEMOTHER, cntxt);
+    
+  } else if (drep->magic == GEM_MDREP) {
+    if ((ibound < 0) || (ibound > drep->nBound)) return GEM_BADBOUNDINDEX;
+    gem_memDRep(drep, ibound, report);
+    
+  } else if (brep->magic == GEM_MBREP) {
+    gem_memBRep(brep, report);
+    
+  } else if (model->magic == GEM_MMODEL) {
+    gem_memModel(model, report);
+  } else {
+    return GEM_BADOBJECT;
+  }
+
+  return GEM_SUCCESS;
+}
+
+
 /*@observer@*/ const char *
 gem_errorString(int code)
 {
@@ -14,6 +14,7 @@
 #include <math.h>
 
 #include "gem.h"
+#include "profile.h"
 
 #define  MAX(A,B)     (((A) < (B)) ? (B) : (A))
 #define  SIGN(A)      (((A) < 0) ? -1 : (((A) > 0) ? +1 : 0))
@@ -262,6 +263,8 @@ gem_conjGrad(int    (*func)(int, double[], void *, double *, /*@null@*/ double[]
 
     /* default returns */
     *fopt = 0;
+    iter  = 0;
+    GEM_PROFBEG(GEM_PCONJGRAD);
 
     /* allocate storage */
     g    = (double*) malloc(n*sizeof(double));
@@ -351,6 +354,363 @@ cleanup:
     if (g    != NULL) free(g   );
     if (h    != NULL) free(h   );
     if (grad != NULL) free(grad);
+    GEM_PROFEND(GEM_PCONJGRAD);
+    GEM_PROFCOUNT(GEM_CCGITER, (iter > ITMAX) ? ITMAX : iter);
+
+    return(status);
+}
+
+
+/*
+ * gem_solveSPD - Jacobi preconditioned conjugate gradient for a symmetric
+ *                positive definite matrix in compressed row form, with any
+ *                number of right hand sides (interleaved: x[nrhs*i+k])
+ */
+
+int
+gem_solveSPD(int    n,                 /* (in)  number of rows */
+             int    nrhs,              /* (in)  number of right hand sides */
+             int    rowp[],            /* (in)  row pointers (n+1 in length) */
+             int    cols[],            /* (in)  column indices (bias 0) */
+             double vals[],            /* (in)  matrix values */
+             double rhs[],             /* (in)  right hand sides (nrhs*n) */
+             double x[],               /* (in)  initial guess */
+                                       /* (out) solution */
+             double tol,               /* (in)  relative residual tolerance */
+             int    maxit,             /* (in)  maximum number of iterations */
+             /*@null@*/
+             int    *iters)            /* (out) iterations taken (or NULL) */
+{
+    int    status = GEM_SUCCESS;
+
+    int    i, j, k, iter, nconv;
+    double *dinv = NULL, *r = NULL, *z = NULL, *p = NULL, *q = NULL;
+    double *rz = NULL, *rnrm = NULL, *stop = NULL, alpha, beta, pq, rzn;
+
+    if (iters != NULL) *iters = 0;
+    if ((n <= 0) || (nrhs <= 0)) return GEM_SUCCESS;
+
+    /* allocate storage */
+    dinv = (double*) malloc(n*sizeof(double));
+    if (dinv == NULL) {status = GEM_ALLOC; goto cleanup;}
+    r    = (double*) malloc(4*n*nrhs*sizeof(double));
+    if (r    == NULL) {status = GEM_ALLOC; goto cleanup;}
+    z    = r + n*nrhs;
+    p    = z + n*nrhs;
+    q    = p + n*nrhs;
+    rz   = (double*) malloc(3*nrhs*sizeof(double));
+    if (rz   == NULL) {status = GEM_ALLOC; goto cleanup;}
+    rnrm = rz   + nrhs;
+    stop = rnrm + nrhs;
+
+    /* Jacobi preconditioner */
+    for (i = 0; i < n; i++) {
+        dinv[i] = 1.0;
+        for (j = rowp[i]; j < rowp[i+1]; j++)
+            if ((cols[j] == i) && (vals[j] > 0.0)) dinv[i] = 1.0/vals[j];
+    }
+
+    /* initial residuals */
+    for (k = 0; k < nrhs; k++) rz[k] = rnrm[k] = stop[k] = 0.0;
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < nrhs; k++) q[nrhs*i+k] = 0.0;
+        for (j = rowp[i]; j < rowp[i+1]; j++)
+            for (k = 0; k < nrhs; k++)
+                q[nrhs*i+k] += vals[j]*x[nrhs*cols[j]+k];
+        for (k = 0; k < nrhs; k++) {
+            r[nrhs*i+k] = rhs[nrhs*i+k] - q[nrhs*i+k];
+            z[nrhs*i+k] = dinv[i]*r[nrhs*i+k];
+            p[nrhs*i+k] = z[nrhs*i+k];
+            rz[k]      += r[nrhs*i+k]*z[nrhs*i+k];
+            stop[k]    += rhs[nrhs*i+k]*rhs[nrhs*i+k];
+            rnrm[k]    += r[nrhs*i+k]*r[nrhs*i+k];
+        }
+    }
+    for (nconv = k = 0; k < nrhs; k++) {
+        stop[k] = tol*tol*stop[k];
+        if (rnrm[k] <= stop[k]) {
+            rz[k] = 0.0;
+            nconv++;
+        }
+    }
+
+    /* all right hand sides share the matrix-vector products */
+    for (iter = 0; (iter < maxit) && (nconv < nrhs); iter++) {
+        for (i = 0; i < n; i++) {
+            for (k = 0; k < nrhs; k++) q[nrhs*i+k] = 0.0;
+            for (j = rowp[i]; j < rowp[i+1]; j++)
+                for (k = 0; k < nrhs; k++)
+                    q[nrhs*i+k] += vals[j]*p[nrhs*cols[j]+k];
+        }
+        for (k = 0; k < nrhs; k++) {
+            if (rz[k] == 0.0) continue;
+            pq = 0.0;
+            for (i = 0; i < n; i++) pq += p[nrhs*i+k]*q[nrhs*i+k];
+            if (pq <= 0.0) {
+                status = GEM_DEGENERATE;
+                goto cleanup;
+            }
+            alpha   = rz[k]/pq;
+            rnrm[k] = rzn = 0.0;
+            for (i = 0; i < n; i++) {
+                x[nrhs*i+k] += alpha*p[nrhs*i+k];
+                r[nrhs*i+k] -= alpha*q[nrhs*i+k];
+                z[nrhs*i+k]  = dinv[i]*r[nrhs*i+k];
+                rnrm[k]     += r[nrhs*i+k]*r[nrhs*i+k];
+                rzn         += r[nrhs*i+k]*z[nrhs*i+k];
+            }
+            if (rnrm[k] <= stop[k]) {
+                rz[k] = 0.0;
+                nconv++;
+                continue;
+            }
+            beta  = rzn/rz[k];
+            rz[k] = rzn;
+            for (i = 0; i < n; i++)
+                p[nrhs*i+k] = z[nrhs*i+k] + beta*p[nrhs*i+k];
+        }
+    }
+    if (iters != NULL) *iters = iter;
+    if (nconv < nrhs) status = GEM_DEGENERATE;
+
+cleanup:
+    if (rz   != NULL) free(rz  );
+    if (r    != NULL) free(r   );
+    if (dinv != NULL) free(dinv);
+
+    return(status);
+}
+
+
+/* y = A x for interleaved right hand sides */
+static void
+gem_csrMult(int n, int nrhs, int rowp[], int cols[], double vals[],
+            double x[], double y[])
+{
+    int i, j, k;
+
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < nrhs; k++) y[nrhs*i+k] = 0.0;
+        for (j = rowp[i]; j < rowp[i+1]; j++)
+            for (k = 0; k < nrhs; k++)
+                y[nrhs*i+k] += vals[j]*x[nrhs*cols[j]+k];
+    }
+}
+
+
+/* x = (LU)^-1 b with the ILU(0) factors (L has a unit diagonal) */
+static void
+gem_iluSolve(int n, int nrhs, int rowp[], int cols[], double lu[], 
+             int diag[], double b[], double x[])
+{
+    int i, j, k;
+
+    for (i = 0; i < n; i++) {
+        for (k = 0; k < nrhs; k++) x[nrhs*i+k] = b[nrhs*i+k];
+        for (j = rowp[i]; j < diag[i]; j++)
+            for (k = 0; k < nrhs; k++)
+                x[nrhs*i+k] -= lu[j]*x[nrhs*cols[j]+k];
+    }
+    for (i = n-1; i >= 0; i--) {
+        for (j = diag[i]+1; j < rowp[i+1]; j++)
+            for (k = 0; k < nrhs; k++)
+                x[nrhs*i+k] -= lu[j]*x[nrhs*cols[j]+k];
+        for (k = 0; k < nrhs; k++) x[nrhs*i+k] /= lu[diag[i]];
+    }
+}
+
+
+/*
+ * gem_solveILU - ILU(0) preconditioned BiCGStab for a general (nonsymmetric)
+ *                matrix in compressed row form with sorted columns and
+ *                every diagonal present, with any number of right hand
+ *                sides (interleaved: x[nrhs*i+k]) sharing the factorization
+ */
+
+int
+gem_solveILU(int    n,                 /* (in)  number of rows */
+             int    nrhs,              /* (in)  number of right hand sides */
+             int    rowp[],            /* (in)  row pointers (n+1 in length) */
+             int    cols[],            /* (in)  column indices (bias 0) */
+             double vals[],            /* (in)  matrix values */
+             double rhs[],             /* (in)  right hand sides (nrhs*n) */
+             double x[],               /* (in)  initial guess */
+                                       /* (out) solution */
+             double tol,               /* (in)  relative residual tolerance */
+             int    maxit,             /* (in)  maximum number of iterations */
+             /*@null@*/
+             int    *iters,            /* (out) iterations taken (or NULL) */
+             /*@null@*/
+             double resid[])           /* (out) relative residuals (nrhs) */
+{
+    int    status = GEM_SUCCESS;
+
+    int    i, j, k, m, iter, nconv, nnz;
+    int    *diag = NULL, *iw = NULL, *act = NULL;
+    double *lu = NULL, *r = NULL, *rh = NULL, *p = NULL, *v = NULL;
+    double *ph = NULL, *s = NULL, *sh = NULL, *t = NULL, *w = NULL;
+    double *rho, *alpha, *omega, *bnrm, *rnrm, *dot1, *dot2, beta;
+
+    if (iters != NULL) *iters = 0;
+    if ((n <= 0) || (nrhs <= 0)) return GEM_SUCCESS;
+    nnz = rowp[n];
+
+    /* allocate storage */
+    diag = (int*)    malloc(2*n*sizeof(int));
+    if (diag == NULL) {status = GEM_ALLOC; goto cleanup;}
+    iw   = diag + n;
+    act  = (int*)    malloc(nrhs*sizeof(int));
+    if (act  == NULL) {status = GEM_ALLOC; goto cleanup;}
+    lu   = (double*) malloc(nnz*sizeof(double));
+    if (lu   == NULL) {status = GEM_ALLOC; goto cleanup;}
+    r    = (double*) malloc(8*n*nrhs*sizeof(double));
+    if (r    == NULL) {status = GEM_ALLOC; goto cleanup;}
+    rh   = r  + n*nrhs;
+    p    = rh + n*nrhs;
+    v    = p  + n*nrhs;
+    ph   = v  + n*nrhs;
+    s    = ph + n*nrhs;
+    sh   = s  + n*nrhs;
+    t    = sh + n*nrhs;
+    w    = (double*) malloc(7*nrhs*sizeof(double));
+    if (w    == NULL) {status = GEM_ALLOC; goto cleanup;}
+    rho   = w;
+    alpha = rho   + nrhs;
+    omega = alpha + nrhs;
+    bnrm  = omega + nrhs;
+    rnrm  = bnrm  + nrhs;
+    dot1  = rnrm  + nrhs;
+    dot2  = dot1  + nrhs;
+    iter  = 0;
+    for (k = 0; k < nrhs; k++) {
+        bnrm[k] = 1.0;
+        rnrm[k] = 0.0;
+    }
+
+    /* ILU(0) -- the factors overwrite a copy of the matrix */
+    for (i = 0; i < n; i++) {
+        diag[i] = -1;
+        iw[i]   = -1;
+        for (j = rowp[i]; j < rowp[i+1]; j++)
+            if (cols[j] == i) diag[i] = j;
+        if (diag[i] < 0) {status = GEM_DEGENERATE; goto cleanup;}
+    }
+    for (j = 0; j < nnz; j++) lu[j] = vals[j];
+    for (i = 0; i < n; i++) {
+        for (j = rowp[i]; j < rowp[i+1]; j++) iw[cols[j]] = j;
+        for (j = rowp[i]; j < diag[i]; j++) {
+            k      = cols[j];
+            lu[j] /= lu[diag[k]];
+            for (m = diag[k]+1; m < rowp[k+1]; m++)
+                if (iw[cols[m]] >= 0) lu[iw[cols[m]]] -= lu[j]*lu[m];
+        }
+        for (j = rowp[i]; j < rowp[i+1]; j++) iw[cols[j]] = -1;
+        if (lu[diag[i]] == 0.0) {status = GEM_DEGENERATE; goto cleanup;}
+    }
+
+    /* initial residuals */
+    gem_csrMult(n, nrhs, rowp, cols, vals, x, t);
+    for (k = 0; k < nrhs; k++) bnrm[k] = 0.0;
+    for (i = 0; i < n*nrhs; i++) {
+        k       = i%nrhs;
+        r[i]    = rh[i] = rhs[i] - t[i];
+        p[i]    = v[i]  = 0.0;
+        bnrm[k] += rhs[i]*rhs[i];
+        rnrm[k] += r[i]*r[i];
+    }
+    for (nconv = k = 0; k < nrhs; k++) {
+        bnrm[k]  = sqrt(bnrm[k]);
+        rnrm[k]  = sqrt(rnrm[k]);
+        if (bnrm[k] == 0.0) bnrm[k] = 1.0;
+        rho[k]   = alpha[k] = omega[k] = 1.0;
+        act[k]   = 1;
+        if (rnrm[k] <= tol*bnrm[k]) {
+            act[k] = 0;
+            nconv++;
+        }
+    }
+
+    /* all right hand sides share the products and the preconditioner */
+    for (iter = 0; (iter < maxit) && (nconv < nrhs); iter++) {
+        for (k = 0; k < nrhs; k++) dot1[k] = 0.0;
+        for (i = 0; i < n*nrhs; i++) dot1[i%nrhs] += rh[i]*r[i];
+        for (k = 0; k < nrhs; k++) {
+            if (act[k] == 0) continue;
+            if (dot1[k] == 0.0) {status = GEM_DEGENERATE; goto cleanup;}
+            beta   = (dot1[k]/rho[k])*(alpha[k]/omega[k]);
+            rho[k] = dot1[k];
+            for (i = 0; i < n; i++)
+                p[nrhs*i+k] = r[nrhs*i+k] + 
+                              beta*(p[nrhs*i+k] - omega[k]*v[nrhs*i+k]);
+        }
+        gem_iluSolve(n, nrhs, rowp, cols, lu, diag, p, ph);
+        gem_csrMult(n, nrhs, rowp, cols, vals, ph, v);
+
+        for (k = 0; k < nrhs; k++) dot1[k] = 0.0;
+        for (i = 0; i < n*nrhs; i++) dot1[i%nrhs] += rh[i]*v[i];
+        for (k = 0; k < nrhs; k++) {
+            if (act[k] == 0) continue;
+            if (dot1[k] == 0.0) {status = GEM_DEGENERATE; goto cleanup;}
+            alpha[k] = rho[k]/dot1[k];
+            for (rnrm[k] = 0.0, i = 0; i < n; i++) {
+                s[nrhs*i+k] = r[nrhs*i+k] - alpha[k]*v[nrhs*i+k];
+                rnrm[k]    += s[nrhs*i+k]*s[nrhs*i+k];
+            }
+            rnrm[k] = sqrt(rnrm[k]);
+            if (rnrm[k] <= tol*bnrm[k]) {
+                for (i = 0; i < n; i++) {
+                    x[nrhs*i+k] += alpha[k]*ph[nrhs*i+k];
+                    r[nrhs*i+k]  = s[nrhs*i+k];
+                }
+                act[k] = 0;
+                nconv++;
+            }
+        }
+        if (nconv == nrhs) {
+            iter++;
+            break;
+        }
+        gem_iluSolve(n, nrhs, rowp, cols, lu, diag, s, sh);
+        gem_csrMult(n, nrhs, rowp, cols, vals, sh, t);
+
+        for (k = 0; k < nrhs; k++) dot1[k] = dot2[k] = 0.0;
+        for (i = 0; i < n*nrhs; i++) {
+            dot1[i%nrhs] += t[i]*s[i];
+            dot2[i%nrhs] += t[i]*t[i];
+        }
+        for (k = 0; k < nrhs; k++) {
+            if (act[k] == 0) continue;
+            if (dot2[k] == 0.0) {status = GEM_DEGENERATE; goto cleanup;}
+            omega[k] = dot1[k]/dot2[k];
+            for (rnrm[k] = 0.0, i = 0; i < n; i++) {
+                x[nrhs*i+k] += alpha[k]*ph[nrhs*i+k] + omega[k]*sh[nrhs*i+k];
+                r[nrhs*i+k]  = s[nrhs*i+k] - omega[k]*t[nrhs*i+k];
+                rnrm[k]     += r[nrhs*i+k]*r[nrhs*i+k];
+            }
+            rnrm[k] = sqrt(rnrm[k]);
+            if (rnrm[k] <= tol*bnrm[k]) {
+                act[k] = 0;
+                nconv++;
+            } else if (omega[k] == 0.0) {
+                status = GEM_DEGENERATE;
+                goto cleanup;
+            }
+        }
+    }
+    if (nconv < nrhs) status = GEM_DEGENERATE;
+
+cleanup:
+    if ((status != GEM_ALLOC) && (w != NULL)) {
+        if (iters != NULL) *iters = iter;
+        if (resid != NULL)
+            for (k = 0; k < nrhs; k++) resid[k] = rnrm[k]/bnrm[k];
+        GEM_PROFCOUNT(GEM_CBCGITER, iter);
+    }
+    if (w    != NULL) free(w   );
+    if (r    != NULL) free(r   );
+    if (lu   != NULL) free(lu  );
+    if (act  != NULL) free(act );
+    if (diag != NULL) free(diag);
 
     return(status);
 }
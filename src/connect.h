@@ -23,3 +23,6 @@
 
   extern void gem_fillNeighbor( int k1, int k2, int *tri, int *kside, 
                                 int *vtable, gemNeigh *stable );
+
+  extern int  gem_triNeighbors( int nThread, int npts, int ntris,
+                                prmTri *tris );
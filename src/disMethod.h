@@ -21,3 +21,7 @@ typedef int  (*bInterp) (gemQuilt *, int, int, double *, int, double *,
                          double *);
 typedef int  (*gIntegr) (gemQuilt *, int, int, int, double *, double *);
 typedef int  (*bIntegr) (gemQuilt *, int, int, int, double *, double *);
+typedef int  (*gInterpB)(gemQuilt *, int, int, gemTarget *, int, double *,
+                         double *);
+typedef int  (*gIntegrB)(gemQuilt *, int, int, int *, int, double *,
+                         double *);
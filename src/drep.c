@@ -27,6 +27,7 @@
 #include "kernel.h"
 #include "disMethod.h"
 #include "connect.h"
+#include "profile.h"
 
 
 #define CROSS(a,b,c)      a[0] = (b[1]*c[2]) - (b[2]*c[1]);\
@@ -51,17 +52,58 @@ static gInterp Interpolate[MAXMETHOD];
 static bInterp Interpol_bar[MAXMETHOD];
 static gIntegr Integrate[MAXMETHOD];
 static bIntegr Integr_bar[MAXMETHOD];
+static gInterpB InterpBatch[MAXMETHOD];     /* optional -- may be NULL */
+static gIntegrB IntegrBatch[MAXMETHOD];     /* optional -- may be NULL */
 
 static int     met_nDiscr = 0;
 
 extern int  gem_fillCoeff2D(int nrank, int nu, int nv, double *grid,
                             double *coeff, double *r);
-extern int  gem_invInterpolate2D(gemAprx2D *interp, double *sv, double *uv);
+extern int  gem_Aprx2DHash(gemAprx2D *approx);
+extern int  gem_invInterpolate2DBatch(gemAprx2D *interp, int npts, double *sv,
+                                      double *uv);
 extern int  gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc,
                              int vs, int meth, int *iset,
                              gInterp *Interpolatf, bInterp *Interpol_bf,
                              gIntegr *Integratf,   bIntegr *Integr_bf,
+                             gInterpB *InterpBf,   gIntegrB *IntegrBf,
                              invEval *invEvalf);
+extern void gem_clrLocate(gemVSet *vset);
+extern void gem_freeCSys(gemCSys *csys);
+extern void gem_memCount(gemMemReport *report, int cat,
+                         /*@null@*/ const void *ptr);
+extern void gem_memArena(gemMemReport *report, int cat,
+                         /*@null@*/ gemArena *arena);
+extern int  gem_threadRun(int nThread, int n,
+                          int (*func)(void *data, int beg, int end),
+                          void *data);
+extern int  gem_threadTasks(int nThread, int n,
+                            int (*func)(void *data, int beg, int end),
+                            void *data);
+
+
+  typedef struct {
+    gemDRep   *drep;
+    gemPair   pair;
+    gemAprx2D *surface;         /* not NULL -- use the approximation */
+    int       inverse;          /* 0 - xyz from uv, 1 - uv from xyz */
+    double    *in;
+    double    *out;
+  } gemEvalRun;
+
+  typedef struct {
+    gemDRep   *drep;
+    double    angle;
+    double    mxside;
+    double    sag;
+    int       *stats;           /* the tessellation status for each BRep */
+    int       *list;            /* the BReps that own their tessellation */
+  } gemTessRun;
+
+  typedef struct {
+    gemBody   *body;
+    int       index;
+  } gemBodyRef;
 
 
 
@@ -137,6 +179,17 @@ static DLLFunc metDLget(DLL dll, const char *symname, const char *name)
 }
 
 
+/* like metDLget but for optional symbols -- no message */
+static DLLFunc metDLoptional(DLL dll, const char *symname)
+{
+#ifdef WIN32
+  return (DLLFunc) GetProcAddress(dll, symname);
+#else
+  return (DLLFunc) dlsym(dll, symname);
+#endif
+}
+
+
 int gem_metDLoaded(const char *name)
 {
   int i;
@@ -168,6 +221,8 @@ static int metDYNload(const char *name)
   Interpol_bar[ret] = (bInterp) metDLget(dll, "gemInterpolate_bar", name);
   Integrate[ret]    = (gIntegr) metDLget(dll, "gemIntegration",     name);
   Integr_bar[ret]   = (bIntegr) metDLget(dll, "gemIntegrate_bar",   name);
+  InterpBatch[ret]  = (gInterpB) metDLoptional(dll, "gemInterpolationBatch");
+  IntegrBatch[ret]  = (gIntegrB) metDLoptional(dll, "gemIntegrationBatch");
   if ((freeQuilt[ret]    == NULL) || (defQuilt[ret]   == NULL) ||
       (Interpolate[ret]  == NULL) || (Integrate[ret]  == NULL) ||
       (Interpol_bar[ret] == NULL) || (Integr_bar[ret] == NULL) ||
@@ -177,7 +232,7 @@ static int metDYNload(const char *name)
   }
   
   len  = strlen(name) + 1;
-  metName[ret] = (char *) malloc(len*sizeof(char));
+  metName[ret] = (char *) gem_allocate(len*sizeof(char));
   if (metName[ret] == NULL) {
     metDLclose(dll);
     return GEM_ALLOC;
@@ -228,6 +283,27 @@ gem_freeAprx2D(/*@null@*/ /*@only@*/ gemAprx2D *approx)
 }
 
 
+/* the disMethod frees the quilt contents and GEM its packed copy */
+static void
+gem_freeQuilt(int mindex, /*@only@*/ gemQuilt *quilt)
+{
+  gemPacked *packed = quilt->packed;
+
+  if (packed != NULL) {
+    gem_free(packed->xyz);
+    gem_free(packed->fptr);
+    gem_free(packed->fown);
+    gem_free(packed->uv);
+    gem_free(packed->eptr);
+    gem_free(packed->conn);
+    gem_free(packed);
+    quilt->packed = NULL;
+  }
+  freeQuilt[mindex](quilt);
+  gem_free(quilt);
+}
+
+
 static void
 gem_freeVsets(gemBound bound)
 {
@@ -238,12 +314,12 @@ gem_freeVsets(gemBound bound)
     if (bound.VSet[i].quilt != NULL) {
       n = gem_metDLoaded(bound.VSet[i].disMethod);
       if (n >= 0) {
-        freeQuilt[n](bound.VSet[i].quilt);
-        gem_free(bound.VSet[i].quilt);
+        gem_freeQuilt(n, bound.VSet[i].quilt);
       }
       if (bound.VSet[i].tris != NULL) gem_free(bound.VSet[i].tris);
-      gem_free(bound.VSet[i].disMethod);
+      gem_clrLocate(&bound.VSet[i]);
     }
+    gem_free(bound.VSet[i].disMethod);
     
     if (bound.VSet[i].nonconn != NULL) {
       gem_free(bound.VSet[i].nonconn->data);
@@ -265,25 +341,292 @@ static void
 gem_xform(gemBRep *brep, int npts, double *pts)
 {
   int    i;
-  double *xform, xyz[3];
+  double x, y, z, m00, m01, m02, m03, m10, m11, m12, m13;
+  double m20, m21, m22, m23;
   
   if (brep->ibranch == 0) return;
-  xform = brep->xform;
-  
-  for (i = 0; i < npts; i++) {
-    xyz[0]     = pts[3*i  ];
-    xyz[1]     = pts[3*i+1];
-    xyz[2]     = pts[3*i+2];
-    pts[3*i  ] = xform[ 0]*xyz[0] + xform[ 1]*xyz[1] +
-                 xform[ 2]*xyz[2] + xform[ 3];
-    pts[3*i+1] = xform[ 4]*xyz[0] + xform[ 5]*xyz[1] +
-                 xform[ 6]*xyz[2] + xform[ 7];
-    pts[3*i+2] = xform[ 8]*xyz[0] + xform[ 9]*xyz[1] +
-                 xform[10]*xyz[2] + xform[11];
+
+  /* held locally so the loop need not reload them after each store */
+  m00 = brep->xform[ 0];
+  m01 = brep->xform[ 1];
+  m02 = brep->xform[ 2];
+  m03 = brep->xform[ 3];
+  m10 = brep->xform[ 4];
+  m11 = brep->xform[ 5];
+  m12 = brep->xform[ 6];
+  m13 = brep->xform[ 7];
+  m20 = brep->xform[ 8];
+  m21 = brep->xform[ 9];
+  m22 = brep->xform[10];
+  m23 = brep->xform[11];
+  
+  for (i = 0; i < 3*npts; i += 3) {
+    x        = pts[i  ];
+    y        = pts[i+1];
+    z        = pts[i+2];
+    pts[i  ] = m00*x + m01*y + m02*z + m03;
+    pts[i+1] = m10*x + m11*y + m12*z + m13;
+    pts[i+2] = m20*x + m21*y + m22*z + m23;
   }
 }
 
 
+/*
+ * the Context that holds the DRep
+ */
+static /*@null@*/ gemCntxt *
+gem_drepContext(gemDRep *drep)
+{
+  gemDRep *prev;
+  
+  prev = drep->prev;
+  while (prev != NULL) {
+    if (prev->magic == GEM_MCONTEXT) return (gemCntxt *) prev;
+    if (prev->magic != GEM_MDREP) break;
+    prev = prev->prev;
+  }
+  return NULL;
+}
+
+
+/*
+ * the number of threads set for the DRep's Context
+ */
+int
+gem_drepThreads(gemDRep *drep)
+{
+  gemCntxt *cntxt;
+  
+  cntxt = gem_drepContext(drep);
+  if (cntxt == NULL) return 1;
+  return cntxt->nThread;
+}
+
+
+/*
+ * frees a tessellation -- the shared parts are left for their owner
+ */
+static void
+gem_freeTRep(gemTRep *trep)
+{
+  int i;
+  
+  if (trep->Faces != NULL) {
+    for (i = 0; i < trep->nFaces; i++) {
+      gem_free(trep->Faces[i].xyzs);
+      if (trep->owner != 0) continue;
+      gem_free(trep->Faces[i].tris);
+      gem_free(trep->Faces[i].tric);
+      gem_free(trep->Faces[i].uvs);
+      gem_free(trep->Faces[i].vid);
+    }
+    gem_free(trep->Faces);
+  }
+  if (trep->Edges != NULL) {
+    for (i = 0; i < trep->nEdges; i++) {
+      gem_free(trep->Edges[i].xyzs);
+      if (trep->owner != 0) continue;
+      gem_free(trep->Edges[i].ts);
+    }
+    gem_free(trep->Edges);
+  }
+  trep->nFaces = 0;
+  trep->Faces  = NULL;
+  trep->nEdges = 0;
+  trep->Edges  = NULL;
+  trep->owner  = 0;
+}
+
+
+/*
+ * empties the tessellation of a single BRep -- if others share its data
+ *   the first of those takes over the ownership
+ */
+static void
+gem_unshareTRep(gemDRep *drep, int brep)
+{
+  int i, owner;
+  
+  if (drep->TReps[brep-1].owner == 0) {
+    for (owner = 0, i = brep; i < drep->nBReps; i++) {
+      if (drep->TReps[i].owner != brep) continue;
+      if (owner == 0) {
+        owner                = i+1;
+        drep->TReps[i].owner = 0;
+      } else {
+        drep->TReps[i].owner = owner;
+      }
+    }
+    drep->TReps[brep-1].owner = owner;
+  }
+  gem_freeTRep(&drep->TReps[brep-1]);
+}
+
+
+static int
+gem_cmpBody(const void *a, const void *b)
+{
+  const gemBodyRef *ra = (const gemBodyRef *) a;
+  const gemBodyRef *rb = (const gemBodyRef *) b;
+  
+  if (ra->body  < rb->body)  return -1;
+  if (ra->body  > rb->body)  return  1;
+  if (ra->index < rb->index) return -1;
+  if (ra->index > rb->index) return  1;
+  return 0;
+}
+
+
+/*
+ * marks BReps that are instances of an earlier BRep's Body as sharing its
+ *   tessellation & fills the list of the BReps to tessellate
+ */
+static int
+gem_shareBodies(gemDRep *drep, int *list)
+{
+  int        i, j, n;
+  gemBodyRef *refs;
+  gemModel   *model = drep->model;
+  
+  refs = (gemBodyRef *) gem_allocate(drep->nBReps*sizeof(gemBodyRef));
+  if (refs == NULL) {
+    for (i = 0; i < drep->nBReps; i++) list[i] = i;
+    return drep->nBReps;
+  }
+  for (i = 0; i < drep->nBReps; i++) {
+    refs[i].body  = model->BReps[i]->body;
+    refs[i].index = i;
+  }
+  qsort(refs, drep->nBReps, sizeof(gemBodyRef), gem_cmpBody);
+  
+  for (j = i = 0; i < drep->nBReps; i++) {
+    if ((i == 0) || (refs[i].body != refs[j].body)) j = i;
+    if (j == i) continue;
+    drep->TReps[refs[i].index].owner = refs[j].index+1;
+  }
+  gem_free(refs);
+  
+  for (n = i = 0; i < drep->nBReps; i++)
+    if (drep->TReps[i].owner == 0) {
+      list[n] = i;
+      n++;
+    }
+  return n;
+}
+
+
+static int
+gem_tesselRange(void *data, int beg, int end)
+{
+  int        i, j;
+  gemTessRun *run   = (gemTessRun *) data;
+  gemModel   *model = run->drep->model;
+  
+  for (i = beg; i < end; i++) {
+    j = run->list[i];
+    GEM_PROFBEG(GEM_PTESSEL);
+    run->stats[j] = gem_kernelTessel(model->BReps[j]->body, run->angle,
+                                     run->mxside, run->sag, run->drep, j+1);
+    GEM_PROFEND(GEM_PTESSEL);
+  }
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * instances get the owner's untransformed coordinates and point at the rest
+ */
+static int
+gem_shareRange(void *data, int beg, int end)
+{
+  int        i, k, n;
+  gemTessRun *run = (gemTessRun *) data;
+  gemTRep    *trep, *otrep;
+  
+  for (i = beg; i < end; i++) {
+    trep = &run->drep->TReps[i];
+    if (trep->owner == 0) continue;
+    otrep         = &run->drep->TReps[trep->owner-1];
+    run->stats[i] = run->stats[trep->owner-1];
+    if (run->stats[i] != GEM_SUCCESS) {
+      trep->owner = 0;
+      continue;
+    }
+    
+    run->stats[i] = GEM_ALLOC;
+    if (otrep->nFaces != 0) {
+      trep->Faces = (gemTri *) gem_allocate(otrep->nFaces*sizeof(gemTri));
+      if (trep->Faces == NULL) {
+        gem_freeTRep(trep);
+        continue;
+      }
+      for (k = 0; k < otrep->nFaces; k++) {
+        trep->Faces[k]      = otrep->Faces[k];
+        trep->Faces[k].xyzs = NULL;
+      }
+      trep->nFaces = otrep->nFaces;
+    }
+    if (otrep->nEdges != 0) {
+      trep->Edges = (gemDEdge *) gem_allocate(otrep->nEdges*sizeof(gemDEdge));
+      if (trep->Edges == NULL) {
+        gem_freeTRep(trep);
+        continue;
+      }
+      for (k = 0; k < otrep->nEdges; k++) {
+        trep->Edges[k]      = otrep->Edges[k];
+        trep->Edges[k].xyzs = NULL;
+      }
+      trep->nEdges = otrep->nEdges;
+    }
+    
+    for (k = 0; k < trep->nFaces; k++) {
+      n = trep->Faces[k].npts;
+      if (otrep->Faces[k].xyzs == NULL) continue;
+      trep->Faces[k].xyzs = (double *) gem_allocate(3*n*sizeof(double));
+      if (trep->Faces[k].xyzs == NULL) break;
+      memcpy(trep->Faces[k].xyzs, otrep->Faces[k].xyzs, 3*n*sizeof(double));
+    }
+    if (k != trep->nFaces) {
+      gem_freeTRep(trep);
+      continue;
+    }
+    for (k = 0; k < trep->nEdges; k++) {
+      n = trep->Edges[k].npts;
+      if (otrep->Edges[k].xyzs == NULL) continue;
+      trep->Edges[k].xyzs = (double *) gem_allocate(3*n*sizeof(double));
+      if (trep->Edges[k].xyzs == NULL) break;
+      memcpy(trep->Edges[k].xyzs, otrep->Edges[k].xyzs, 3*n*sizeof(double));
+    }
+    if (k != trep->nEdges) {
+      gem_freeTRep(trep);
+      continue;
+    }
+    run->stats[i] = GEM_SUCCESS;
+  }
+  return GEM_SUCCESS;
+}
+
+
+static int
+gem_xformRange(void *data, int beg, int end)
+{
+  int        i, k;
+  gemTessRun *run   = (gemTessRun *) data;
+  gemModel   *model = run->drep->model;
+  gemTRep    *trep;
+  
+  for (i = beg; i < end; i++) {
+    if (run->stats[i] != GEM_SUCCESS) continue;
+    trep = &run->drep->TReps[i];
+    for (k = 0; k < trep->nFaces; k++)
+      gem_xform(model->BReps[i], trep->Faces[k].npts, trep->Faces[k].xyzs);
+    for (k = 0; k < trep->nEdges; k++)
+      gem_xform(model->BReps[i], trep->Edges[k].npts, trep->Edges[k].xyzs);
+  }
+  return GEM_SUCCESS;
+}
+
+
 int
 gem_newDRep(gemModel *model, gemDRep **drep)
 {
@@ -318,6 +661,7 @@ gem_newDRep(gemModel *model, gemDRep **drep)
     trep[i].Faces  = NULL;
     trep[i].nEdges = 0;
     trep[i].Edges  = NULL;
+    trep[i].owner  = 0;
   }
   drp = (gemDRep *) gem_allocate(sizeof(gemDRep));
   if (drp == NULL) {
@@ -331,6 +675,7 @@ gem_newDRep(gemModel *model, gemDRep **drep)
   drp->IDs    = NULL;
   drp->nBReps = model->nBRep;
   drp->TReps  = trep;
+  drp->mTReps = model->nBRep;
   drp->nBound = 0;
   drp->bound  = NULL;
   drp->attr   = NULL;
@@ -353,17 +698,22 @@ int
 gem_tesselDRep(gemDRep *drep, int brep, double angle, double mxside,
                double sag)
 {
-  int      i, j, k, stat;
-  gemModel *model;
+  int        i, k, n, stat, nThread, *stats;
+  gemModel   *model;
+  gemTessRun run;
   
   if (drep == NULL) return GEM_NULLOBJ;
   if (drep->magic != GEM_MDREP) return GEM_BADDREP;
   if ((brep < 0) || (brep > drep->nBReps)) return GEM_BADINDEX;
 
   model = drep->model;
+  GEM_PROFSELECT(gem_drepContext(drep));
   if (brep != 0) {
+    gem_unshareTRep(drep, brep);
+    GEM_PROFBEG(GEM_PTESSEL);
     stat = gem_kernelTessel(model->BReps[brep-1]->body, angle, mxside, sag,
                             drep, brep);
+    GEM_PROFEND(GEM_PTESSEL);
     if (stat == GEM_SUCCESS) {
       for (k = 0; k < drep->TReps[brep-1].nFaces; k++)
         gem_xform(model->BReps[brep-1], drep->TReps[brep-1].Faces[k].npts,
@@ -373,20 +723,28 @@ gem_tesselDRep(gemDRep *drep, int brep, double angle, double mxside,
                   drep->TReps[brep-1].Edges[k].xyzs);
     }
   } else {
+    /* the BReps are independent -- tessellate them concurrently if the
+       kernel allows it, the copies & transformations always can be. each
+       Body is only tessellated once, its instances share that */
+    stats = (int *) gem_allocate(2*drep->nBReps*sizeof(int));
+    if ((stats == NULL) && (drep->nBReps != 0)) return GEM_ALLOC;
+    for (i = 0; i < drep->nBReps; i++) gem_freeTRep(&drep->TReps[i]);
+    run.drep   = drep;
+    run.angle  = angle;
+    run.mxside = mxside;
+    run.sag    = sag;
+    run.stats  = stats;
+    run.list   = &stats[drep->nBReps];
+    n          = gem_shareBodies(drep, run.list);
+    nThread    = gem_drepThreads(drep);
+    gem_threadTasks((gem_kernelThreadSafe() == 1) ? nThread : 1,
+                    n, gem_tesselRange, &run);
+    gem_threadTasks(nThread, drep->nBReps, gem_shareRange, &run);
+    gem_threadTasks(nThread, drep->nBReps, gem_xformRange, &run);
     stat = -9999;
-    for (i = 0; i < drep->nBReps; i++) {
-      j = gem_kernelTessel(model->BReps[i]->body, angle, mxside, sag,
-                           drep, i+1);
-      if (j == GEM_SUCCESS) {
-        for (k = 0; k < drep->TReps[i].nFaces; k++)
-          gem_xform(model->BReps[i], drep->TReps[i].Faces[k].npts,
-                    drep->TReps[i].Faces[k].xyzs);
-        for (k = 0; k < drep->TReps[i].nEdges; k++)
-          gem_xform(model->BReps[i], drep->TReps[i].Edges[k].npts,
-                    drep->TReps[i].Edges[k].xyzs);
-      }
-      if (j > stat) stat = j;
-    }
+    for (i = 0; i < drep->nBReps; i++)
+      if (stats[i] > stat) stat = stats[i];
+    gem_free(stats);
   }
 
   return stat;
@@ -445,14 +803,209 @@ gem_freeXfer(gemXfer *xfer)
 {
   if (xfer->position != NULL) gem_free(xfer->position);
   if (xfer->match    != NULL) gem_free(xfer->match);
+  if (xfer->csys     != NULL) gem_freeCSys(xfer->csys);
+  if (xfer->scratch  != NULL) {
+    gem_arenaFree(xfer->scratch);
+    gem_free(xfer->scratch);
+  }
   gem_free(xfer);
 }
 
 
+/*
+ * memory reports -- these follow what the frees above release
+ */
+static void
+gem_memKnotHash(/*@null@*/ gemKnotHash *hash, gemMemReport *report)
+{
+  if (hash == NULL) return;
+  gem_memCount(report, GEM_MEMAPPROX, hash->start);
+  gem_memCount(report, GEM_MEMAPPROX, hash->knots);
+  gem_memCount(report, GEM_MEMAPPROX, hash);
+}
+
+
+/* the disMethod allocates the quilt contents -- sized from the lengths */
+static void
+gem_memQuiltArray(/*@null@*/ void *ptr, size_t nbytes, gemMemReport *report)
+{
+  if (ptr == NULL) return;
+  report->bytes[GEM_MEMQUILT] += nbytes;
+  report->count[GEM_MEMQUILT]++;
+}
+
+
+static void
+gem_memQuilt(gemQuilt *quilt, gemMemReport *report)
+{
+  int        i, n;
+  gemEleType *type;
+
+  gem_memCount(report, GEM_MEMQUILT, quilt);
+  gem_memQuiltArray(quilt->bfaces,  quilt->nbface*sizeof(gemPair),    report);
+  gem_memQuiltArray(quilt->faceUVs, quilt->nFaceUVs*sizeof(gemFaceUV), report);
+  gem_memQuiltArray(quilt->points,  quilt->nPoints*sizeof(gemPoints),  report);
+  for (i = 0; i < quilt->nPoints; i++)
+    if (quilt->points[i].nFaces > 2)
+      gem_memQuiltArray(quilt->points[i].findices.multi,
+                        quilt->points[i].nFaces*sizeof(int), report);
+  gem_memQuiltArray(quilt->verts,   quilt->nVerts*sizeof(gemFaceUV),   report);
+  gem_memQuiltArray(quilt->types,   quilt->nTypes*sizeof(gemEleType),  report);
+  for (i = 0; i < quilt->nTypes; i++) {
+    type = &quilt->types[i];
+    gem_memQuiltArray(type->gst,   2*type->nref*sizeof(double),  report);
+    gem_memQuiltArray(type->dst,   2*type->ndata*sizeof(double), report);
+    gem_memQuiltArray(type->matst, 2*type->nmat*sizeof(double),  report);
+    gem_memQuiltArray(type->tris,  3*type->ntri*sizeof(int),     report);
+  }
+  gem_memQuiltArray(quilt->elems,   quilt->nElems*sizeof(gemElement),  report);
+  
+  /* the element indices are usually one block (in ptrm) */
+  if (quilt->ptrm != NULL) report->count[GEM_MEMQUILT]++;
+  for (i = 0; i < quilt->nElems; i++) {
+    n = quilt->elems[i].tIndex-1;
+    if ((n < 0) || (n >= quilt->nTypes)) continue;
+    report->bytes[GEM_MEMQUILT] += quilt->types[n].nref*sizeof(int);
+    if (quilt->elems[i].dIndices != NULL)
+      report->bytes[GEM_MEMQUILT] += quilt->types[n].ndata*sizeof(int);
+  }
+  
+  /* GEM's packed copy */
+  if (quilt->packed == NULL) return;
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed->xyz);
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed->fptr);
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed->fown);
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed->uv);
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed->eptr);
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed->conn);
+  gem_memCount(report, GEM_MEMQUILT, quilt->packed);
+}
+
+
+static void
+gem_memBound(gemBound *bound, gemMemReport *report)
+{
+  int       i, j;
+  gemVSet   *vset;
+  gemXfer   *xfer;
+  gemCSys   *csys;
+  gemUVGrid *grid;
+
+  gem_memCount(report, GEM_MEMOTHER, bound->IDs);
+  gem_memCount(report, GEM_MEMOTHER, bound->indices);
+  if (bound->surface != NULL) {
+    gem_memCount(report, GEM_MEMAPPROX, bound->surface->interp);
+    gem_memCount(report, GEM_MEMAPPROX, bound->surface->uvmap);
+    gem_memKnotHash(bound->surface->khash, report);
+    gem_memKnotHash(bound->surface->mhash, report);
+    gem_memCount(report, GEM_MEMAPPROX, bound->surface);
+  }
+
+  for (i = 0; i < bound->nVSet; i++) {
+    vset = &bound->VSet[i];
+    if (vset->quilt != NULL) gem_memQuilt(vset->quilt, report);
+    gem_memCount(report, GEM_MEMQUILT, vset->tris);
+    grid = vset->locate;
+    if (grid != NULL) {
+      gem_memCount(report, GEM_MEMQUILT, grid->tris);
+      gem_memCount(report, GEM_MEMQUILT, grid->start);
+      gem_memCount(report, GEM_MEMQUILT, grid->cells);
+      gem_memCount(report, GEM_MEMQUILT, grid);
+    }
+    gem_memCount(report, GEM_MEMOTHER, vset->disMethod);
+    if (vset->nonconn != NULL) {
+      gem_memCount(report, GEM_MEMDSET, vset->nonconn->data);
+      gem_memCount(report, GEM_MEMDSET, vset->nonconn);
+    }
+    for (j = 0; j < vset->nSets; j++) {
+      gem_memCount(report, GEM_MEMDSET, vset->sets[j].name);
+      gem_memCount(report, GEM_MEMDSET, vset->sets[j].dset.data);
+    }
+    gem_memCount(report, GEM_MEMDSET, vset->sets);
+  }
+  gem_memCount(report, GEM_MEMOTHER, bound->VSet);
+
+  for (xfer = bound->xferList; xfer != NULL; xfer = xfer->next) {
+    gem_memCount(report, GEM_MEMXFER, xfer->position);
+    gem_memCount(report, GEM_MEMXFER, xfer->match);
+    csys = xfer->csys;
+    if (csys != NULL) {
+      gem_memCount(report, GEM_MEMXFER, csys->imat);
+      gem_memCount(report, GEM_MEMXFER, csys->wptr);
+      gem_memCount(report, GEM_MEMXFER, csys->wcol);
+      gem_memCount(report, GEM_MEMXFER, csys->wval);
+      gem_memCount(report, GEM_MEMXFER, csys->sptr);
+      gem_memCount(report, GEM_MEMXFER, csys->scol);
+      gem_memCount(report, GEM_MEMXFER, csys->sval);
+      gem_memCount(report, GEM_MEMXFER, csys->pin);
+      gem_memCount(report, GEM_MEMXFER, csys->area);
+      gem_memCount(report, GEM_MEMXFER, csys->y);
+      gem_memCount(report, GEM_MEMXFER, csys);
+    }
+    gem_memArena(report, GEM_MEMXFER, xfer->scratch);
+    gem_memCount(report, GEM_MEMXFER, xfer->scratch);
+    gem_memCount(report, GEM_MEMXFER, xfer);
+  }
+}
+
+
+/*
+ * the storage of a DRep (or only one of its Bounds) -- instances hold only
+ *   their own coordinates
+ */
+void
+gem_memDRep(gemDRep *drep, int bound, gemMemReport *report)
+{
+  int     i, j;
+  gemTRep *trep;
+
+  if (bound > 0) {
+    gem_memBound(&drep->bound[bound-1], report);
+    return;
+  }
+
+  for (i = 0; i < drep->nIDs; i++)
+    gem_memCount(report, GEM_MEMOTHER, drep->IDs[i]);
+  gem_memCount(report, GEM_MEMOTHER, drep->IDs);
+
+  for (i = 0; i < drep->nBReps; i++) {
+    trep = &drep->TReps[i];
+    if (trep->Faces != NULL) {
+      for (j = 0; j < trep->nFaces; j++) {
+        gem_memCount(report, GEM_MEMTREP, trep->Faces[j].xyzs);
+        if (trep->owner != 0) continue;
+        gem_memCount(report, GEM_MEMTREP, trep->Faces[j].tris);
+        gem_memCount(report, GEM_MEMTREP, trep->Faces[j].tric);
+        gem_memCount(report, GEM_MEMTREP, trep->Faces[j].uvs);
+        gem_memCount(report, GEM_MEMTREP, trep->Faces[j].vid);
+      }
+      gem_memCount(report, GEM_MEMTREP, trep->Faces);
+    }
+    if (trep->Edges != NULL) {
+      for (j = 0; j < trep->nEdges; j++) {
+        gem_memCount(report, GEM_MEMTREP, trep->Edges[j].xyzs);
+        if (trep->owner != 0) continue;
+        gem_memCount(report, GEM_MEMTREP, trep->Edges[j].ts);
+      }
+      gem_memCount(report, GEM_MEMTREP, trep->Edges);
+    }
+  }
+  gem_memCount(report, GEM_MEMTREP, drep->TReps);
+
+  if (drep->bound != NULL) {
+    for (i = 0; i < drep->nBound; i++) gem_memBound(&drep->bound[i], report);
+    gem_memCount(report, GEM_MEMOTHER, drep->bound);
+  }
+
+  gem_memAttribs(drep->attr, GEM_MEMOTHER, report);
+  gem_memCount(report, GEM_MEMOTHER, drep);
+}
+
+
 int
 gem_destroyDRep(gemDRep *drep)
 {
-  int      i, j;
+  int      i;
   gemCntxt *cntxt;
   gemDRep  *prev, *next;
   gemXfer  *xfer, *last;
@@ -488,25 +1041,7 @@ gem_destroyDRep(gemDRep *drep)
   for (i = 0; i < drep->nIDs; i++) gem_free(drep->IDs[i]);
   gem_free(drep->IDs);
 
-  for (i = 0; i < drep->nBReps; i++) {
-    if (drep->TReps[i].Faces != NULL) {
-      for (j = 0; j < drep->TReps[i].nFaces; j++) {
-        gem_free(drep->TReps[i].Faces[j].xyzs);
-        gem_free(drep->TReps[i].Faces[j].tris);
-        gem_free(drep->TReps[i].Faces[j].tric);
-        gem_free(drep->TReps[i].Faces[j].uvs);
-        gem_free(drep->TReps[i].Faces[j].vid);
-      }
-      gem_free(drep->TReps[i].Faces);
-    }
-    if (drep->TReps[i].Edges != NULL) {
-      for (j = 0; j < drep->TReps[i].nEdges; j++) {
-        gem_free(drep->TReps[i].Edges[j].xyzs);
-        gem_free(drep->TReps[i].Edges[j].ts);
-      }
-      gem_free(drep->TReps[i].Edges);
-    }
-  }
+  for (i = 0; i < drep->nBReps; i++) gem_freeTRep(&drep->TReps[i]);
   gem_free(drep->TReps);
 
   if (drep->bound != NULL) {
@@ -538,7 +1073,7 @@ gem_destroyDRep(gemDRep *drep)
 int
 gem_clrDReps(gemModel *model, int phase)
 {
-  int      i, j;
+  int      i;
   gemModel *prev;
   gemDRep  *drep;
   gemCntxt *cntxt;
@@ -568,28 +1103,11 @@ gem_clrDReps(gemModel *model, int phase)
       if (phase == 0) {
         
         /* cleanup */
-        for (i = 0; i < drep->nBReps; i++) {
-          if (drep->TReps[i].Faces != NULL) {
-            for (j = 0; j < drep->TReps[i].nFaces; j++) {
-              gem_free(drep->TReps[i].Faces[j].xyzs);
-              gem_free(drep->TReps[i].Faces[j].tris);
-              gem_free(drep->TReps[i].Faces[j].tric);
-              gem_free(drep->TReps[i].Faces[j].uvs);
-              gem_free(drep->TReps[i].Faces[j].vid);
-            }
-            gem_free(drep->TReps[i].Faces);
-          }
-          if (drep->TReps[i].Edges != NULL) {
-            for (j = 0; j < drep->TReps[i].nEdges; j++) {
-              gem_free(drep->TReps[i].Edges[j].xyzs);
-              gem_free(drep->TReps[i].Edges[j].ts);
-            }
-            gem_free(drep->TReps[i].Edges);
-          }
-        }
+        for (i = 0; i < drep->nBReps; i++) gem_freeTRep(&drep->TReps[i]);
         gem_free(drep->TReps);
         drep->nBReps = 0;
         drep->TReps  = NULL;
+        drep->mTReps = 0;
 
         if (drep->bound != NULL) {
           for (i = 0; i < drep->nBound; i++) {
@@ -620,9 +1138,11 @@ gem_clrDReps(gemModel *model, int phase)
             trep[i].Faces  = NULL;
             trep[i].nEdges = 0;
             trep[i].Edges  = NULL;
+            trep[i].owner  = 0;
           }
           drep->nBReps = model->nBRep;
           drep->TReps  = trep;  
+          drep->mTReps = model->nBRep;
         }
       }
     }
@@ -633,6 +1153,198 @@ gem_clrDReps(gemModel *model, int phase)
 }
 
 
+/*
+ * looks for the inactive IDs of a Bound on BReps beg through end-1 (skipping
+ *   those with keep set) -- returns the number found
+ */
+static int
+gem_findBoundIDs(gemDRep *drep, gemBound *bound, int beg, int end,
+                 /*@null@*/ int *keep)
+{
+  int      j, k, m, n;
+  char     *ID;
+  gemBody  *body;
+  gemModel *model = drep->model;
+
+  for (n = j = 0; j < bound->nIDs; j++) {
+    if (bound->indices[j].BRep != 0) continue;
+    ID = drep->IDs[bound->IDs[j]-1];
+    for (m = beg; m < end; m++) {
+      if ((keep != NULL) && (keep[m] != 0)) continue;
+      body = model->BReps[m]->body;
+      for (k = 0; k < body->nface; k++)
+        if (strcmp(ID, body->faces[k].ID) == 0) {
+          bound->indices[j].BRep  = m+1;
+          bound->indices[j].index = k+1;
+          break;
+        }
+      if (bound->indices[j].BRep != 0) break;
+    }
+    if (bound->indices[j].BRep != 0) n++;
+  }
+
+  return n;
+}
+
+
+/*
+ * a Bound starts over -- the IDs are kept but not the VertexSets, the
+ *   parameterization or the transfers
+ */
+static void
+gem_resetBound(gemBound *bound)
+{
+  gemXfer *xfer, *last;
+
+  if (bound->surface != NULL) gem_freeAprx2D(bound->surface);
+  gem_freeVsets(*bound);
+  xfer = bound->xferList;
+  while (xfer != NULL) {
+    last = xfer;
+    xfer = xfer->next;
+    gem_freeXfer(last);
+  }
+  bound->single.BRep  = 0;
+  bound->single.index = 0;
+  bound->surface      = NULL;
+  bound->uvbox[0]     = 0.0;
+  bound->uvbox[1]     = 0.0;
+  bound->uvbox[2]     = 0.0;
+  bound->uvbox[3]     = 0.0;
+  bound->nVSet        = 0;
+  bound->VSet         = NULL;
+  bound->xferList     = NULL;
+}
+
+
+/*
+ * extend the DReps of a Model getting more BReps -- phase 0 makes room for
+ *   nBRep TReps (nothing is changed on failure) & phase 1 (once the Model
+ *   holds the BReps) uses the room and finds any Bound IDs on the new BReps
+ */
+int
+gem_growDReps(gemModel *model, int nBRep, int phase)
+{
+  int      i, m, nold;
+  gemModel *prev;
+  gemDRep  *drep;
+  gemCntxt *cntxt;
+  gemTRep  *trep;
+  
+  if (model == NULL) return GEM_NULLOBJ;
+  if (model->magic != GEM_MMODEL) return GEM_BADMODEL;
+
+  /* find the context */
+
+  cntxt = NULL;
+  prev  = model->prev;
+  while (cntxt == NULL) {
+    if  (prev  == NULL) return GEM_BADCONTEXT;
+    if ((prev->magic != GEM_MMODEL) &&
+        (prev->magic != GEM_MCONTEXT)) return GEM_BADOBJECT;
+    if  (prev->magic == GEM_MCONTEXT)  cntxt = (gemCntxt *) prev;
+    if  (prev->magic == GEM_MMODEL)    prev  = prev->prev;
+  }
+
+  drep = cntxt->drep;
+  while (drep != NULL) {
+    if (drep->model == model) {
+      if (phase == 0) {
+      
+        /* make room (doubling, as for the BReps) -- the new TReps are
+           empty */
+        if (nBRep > drep->mTReps) {
+          m = 2*drep->mTReps;
+          if (m < nBRep) m = nBRep;
+          trep = (gemTRep *) gem_reallocate(drep->TReps, m*sizeof(gemTRep));
+          if (trep == NULL) return GEM_ALLOC;
+          for (i = drep->nBReps; i < m; i++) {
+            trep[i].nFaces = 0;
+            trep[i].Faces  = NULL;
+            trep[i].nEdges = 0;
+            trep[i].Edges  = NULL;
+            trep[i].owner  = 0;
+          }
+          drep->TReps  = trep;
+          drep->mTReps = m;
+        }
+        
+      } else {
+      
+        nold         = drep->nBReps;
+        drep->nBReps = model->nBRep;
+        
+        /* IDs not found before may be on the new BReps -- those Bounds
+           start over (the other Bounds keep their parameterizations) */
+        for (i = 0; i < drep->nBound; i++)
+          if (gem_findBoundIDs(drep, &drep->bound[i], nold, model->nBRep,
+                               NULL) != 0) gem_resetBound(&drep->bound[i]);
+      }
+    }
+    drep = drep->next;
+  }
+
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * the Model was regenerated with the same number of BReps -- keep[i] is set
+ *   where BRep i+1 is the one from before. The TReps of the others are 
+ *   emptied and only the Bounds that touch them (or that now find an ID on
+ *   them) start over
+ */
+int
+gem_refreshDReps(gemModel *model, int *keep)
+{
+  int      i, j, n, ib;
+  gemModel *prev;
+  gemDRep  *drep;
+  gemCntxt *cntxt;
+  gemBound *bound;
+  
+  if (model == NULL) return GEM_NULLOBJ;
+  if (model->magic != GEM_MMODEL) return GEM_BADMODEL;
+
+  /* find the context */
+
+  cntxt = NULL;
+  prev  = model->prev;
+  while (cntxt == NULL) {
+    if  (prev  == NULL) return GEM_BADCONTEXT;
+    if ((prev->magic != GEM_MMODEL) &&
+        (prev->magic != GEM_MCONTEXT)) return GEM_BADOBJECT;
+    if  (prev->magic == GEM_MCONTEXT)  cntxt = (gemCntxt *) prev;
+    if  (prev->magic == GEM_MMODEL)    prev  = prev->prev;
+  }
+
+  drep = cntxt->drep;
+  while (drep != NULL) {
+    if (drep->model == model) {
+      if (drep->nBReps != model->nBRep) return GEM_BADVALUE;
+      for (i = 0; i < drep->nBReps; i++)
+        if (keep[i] == 0) gem_unshareTRep(drep, i+1);
+
+      for (ib = 0; ib < drep->nBound; ib++) {
+        bound = &drep->bound[ib];
+        for (n = j = 0; j < bound->nIDs; j++) {
+          if (bound->indices[j].BRep == 0) continue;
+          if (keep[bound->indices[j].BRep-1] != 0) continue;
+          bound->indices[j].BRep  = 0;
+          bound->indices[j].index = 0;
+          n++;
+        }
+        n += gem_findBoundIDs(drep, bound, 0, model->nBRep, keep);
+        if (n != 0) gem_resetBound(bound);
+      }
+    }
+    drep = drep->next;
+  }
+
+  return GEM_SUCCESS;
+}
+
+
 int
 gem_createBound(gemDRep *drep, int nIDs, char **IDs, int *bound)
 {
@@ -913,6 +1625,9 @@ gem_copyDRep(gemDRep *src, gemModel *model, gemDRep **drep, int *nIDx,
   for (i = 0; i < model->nBRep; i++) {
     trep[i].nFaces = 0;
     trep[i].Faces  = NULL;
+    trep[i].nEdges = 0;
+    trep[i].Edges  = NULL;
+    trep[i].owner  = 0;
   }
   drp = (gemDRep *) gem_allocate(sizeof(gemDRep));
   if (drp == NULL) {
@@ -933,6 +1648,7 @@ gem_copyDRep(gemDRep *src, gemModel *model, gemDRep **drep, int *nIDx,
   drp->IDs    = IDs;
   drp->nBReps = model->nBRep;
   drp->TReps  = trep;
+  drp->mTReps = model->nBRep;
   drp->nBound = 0;
   drp->bound  = NULL;
   drp->attr   = NULL;
@@ -1041,6 +1757,7 @@ gem_createVset(gemDRep *drep, int bound, char *disMethod, int *vs)
   drep->bound[bound-1].VSet[n].nonconn = NULL;
   drep->bound[bound-1].VSet[n].ntris   = 0;
   drep->bound[bound-1].VSet[n].tris    = NULL;
+  drep->bound[bound-1].VSet[n].locate  = NULL;
   drep->bound[bound-1].VSet[n].nSets   = 0;
   drep->bound[bound-1].VSet[n].sets    = NULL;
 
@@ -1055,7 +1772,7 @@ static int
 gem_fillNonConn(gemDRep *drep, gemBound *bound, int vsi)
 {
   int       i, stat;
-  double    coor[3], *xyzs, *uvs, *txyz, *xform;
+  double    *xyzs, *uvs, *txyz, *xform;
   gemCollct *collect;
   gemDSet   *sets;
   gemModel  *model;
@@ -1132,20 +1849,26 @@ gem_fillNonConn(gemDRep *drep, gemBound *bound, int vsi)
 
   } else {
     
-    /* reparameterized */
-    for (i = 0; i < collect->npts; i++) {
-      coor[0] = xyzs[3*i  ];
-      coor[1] = xyzs[3*i+1];
-      coor[2] = xyzs[3*i+2];
-      stat    = gem_invInterpolate2D(bound->surface, coor, &uvs[2*i]);
-      if (stat != GEM_SUCCESS) {
-        gem_free(sets[1].name);
-        gem_free(sets[0].name);
-        gem_free(sets);
-        gem_free(uvs);
-        gem_free(xyzs);
-        return stat;
-      }
+    /* reparameterized -- the inverse moves the points onto the surface */
+    txyz = (double *) gem_allocate(3*collect->npts*sizeof(double));
+    if (txyz == NULL) {
+      gem_free(sets[1].name);
+      gem_free(sets[0].name);
+      gem_free(sets);
+      gem_free(uvs);
+      gem_free(xyzs);
+      return GEM_ALLOC;
+    }
+    for (i = 0; i < 3*collect->npts; i++) txyz[i] = xyzs[i];
+    stat = gem_invInterpolate2DBatch(bound->surface, collect->npts, txyz, uvs);
+    gem_free(txyz);
+    if (stat != GEM_SUCCESS) {
+      gem_free(sets[1].name);
+      gem_free(sets[0].name);
+      gem_free(sets);
+      gem_free(uvs);
+      gem_free(xyzs);
+      return stat;
     }
 
   }
@@ -1210,6 +1933,7 @@ gem_makeVset(gemDRep *drep, int bound, int npts, double *xyz, int *vs)
   drep->bound[bound-1].VSet[n].nonconn   = collct;
   drep->bound[bound-1].VSet[n].ntris     = 0;
   drep->bound[bound-1].VSet[n].tris      = NULL;
+  drep->bound[bound-1].VSet[n].locate    = NULL;
   drep->bound[bound-1].VSet[n].nSets     = 0;
   drep->bound[bound-1].VSet[n].sets      = NULL;
   if ((drep->bound[bound-1].uvbox[0] != 0.0) ||
@@ -1232,51 +1956,87 @@ gem_makeVset(gemDRep *drep, int bound, int npts, double *xyz, int *vs)
 
 
 static int
-gem_makeNeighbors(int npts, int ntris, prmTri *tris)
+gem_makeNeighbors(int nThread, int npts, int ntris, prmTri *tris)
 {
-  int      i, nside, *vtab;
-  gemNeigh *stab;
-  
-  vtab = (int *) gem_allocate(npts*sizeof(int));
-  if (vtab == NULL) return GEM_ALLOC;
-  stab = (gemNeigh *) gem_allocate(ntris*3*sizeof(gemNeigh));
-  if (stab == NULL) {
-    gem_free(vtab);
-    return GEM_ALLOC;
-  }
+  int i;
   
-  nside = NOTFILLED;
-  for (i = 0; i < npts; i++) vtab[i] = NOTFILLED;
-  for (i = 0; i < ntris; i++) {
-    tris[i].neigh[0] = i + 1;
-    tris[i].neigh[1] = i + 1;
-    tris[i].neigh[2] = i + 1;
-  }
-  for (i = 0; i < ntris;  i++) {
+  for (i = 0; i < ntris;  i++)
     if ((tris[i].indices[0] < 1) || (tris[i].indices[1] < 1) ||
         (tris[i].indices[2] < 1))
       printf(" %d/%d:  %d %d %d\n", i, ntris, tris[i].indices[0],
              tris[i].indices[1], tris[i].indices[2]);
-    gem_fillNeighbor( tris[i].indices[1], tris[i].indices[2],
-                     &tris[i].neigh[0], &nside, vtab, stab);
-    gem_fillNeighbor( tris[i].indices[0], tris[i].indices[2],
-                     &tris[i].neigh[1], &nside, vtab, stab);
-    gem_fillNeighbor( tris[i].indices[0], tris[i].indices[1],
-                     &tris[i].neigh[2], &nside, vtab, stab);
-  }
-  
-  /* zero out sides with only one neighbor */
-  for (i = 0; i <= nside; i++)
-    if (stab[i].tri != NULL) *stab[i].tri = 0;
   
-  gem_free(stab);
-  gem_free(vtab);
+  /* sides with only one neighbor are zeroed */
+  return gem_triNeighbors(nThread, npts, ntris, tris);
+}
+
+
+/* build the packed copy of a (checked) quilt */
+static int
+gem_packQuilt(gemQuilt *quilt)
+{
+  int       i, j, n, t, *fuvs;
+  gemPacked *packed;
+
+  packed = (gemPacked *) gem_allocate(sizeof(gemPacked));
+  if (packed == NULL) return GEM_ALLOC;
+  packed->nPoints = quilt->nPoints;
+  packed->nElems  = quilt->nElems;
+  packed->fown    = NULL;
+  packed->uv      = NULL;
+  packed->conn    = NULL;
+  packed->xyz     = (double *) gem_allocate(3*quilt->nPoints*sizeof(double));
+  packed->fptr    = (int *)    gem_allocate((quilt->nPoints+1)*sizeof(int));
+  packed->eptr    = (int *)    gem_allocate((quilt->nElems+1)*sizeof(int));
+  quilt->packed   = packed;
+  if ((packed->xyz == NULL) || (packed->fptr == NULL) ||
+      (packed->eptr == NULL)) return GEM_ALLOC;
+
+  for (n = i = 0; i < quilt->nPoints; i++) {
+    packed->xyz[3*i  ] = quilt->points[i].xyz[0];
+    packed->xyz[3*i+1] = quilt->points[i].xyz[1];
+    packed->xyz[3*i+2] = quilt->points[i].xyz[2];
+    packed->fptr[i]    = n;
+    n += quilt->points[i].nFaces;
+  }
+  packed->fptr[quilt->nPoints] = n;
+  if (n == 0) n = 1;
+  packed->fown = (int *)    gem_allocate(n*sizeof(int));
+  packed->uv   = (double *) gem_allocate(2*n*sizeof(double));
+  if ((packed->fown == NULL) || (packed->uv == NULL)) return GEM_ALLOC;
+  for (n = i = 0; i < quilt->nPoints; i++) {
+    if (quilt->points[i].nFaces < 3) {
+      fuvs = quilt->points[i].findices.faces;
+    } else {
+      fuvs = quilt->points[i].findices.multi;
+    }
+    for (j = 0; j < quilt->points[i].nFaces; j++, n++) {
+      packed->fown[n]   = quilt->faceUVs[fuvs[j]-1].owner;
+      packed->uv[2*n  ] = quilt->faceUVs[fuvs[j]-1].uv[0];
+      packed->uv[2*n+1] = quilt->faceUVs[fuvs[j]-1].uv[1];
+    }
+  }
+
+  for (n = i = 0; i < quilt->nElems; i++) {
+    packed->eptr[i] = n;
+    n += quilt->types[quilt->elems[i].tIndex-1].nref;
+  }
+  packed->eptr[quilt->nElems] = n;
+  if (n == 0) n = 1;
+  packed->conn = (int *) gem_allocate(n*sizeof(int));
+  if (packed->conn == NULL) return GEM_ALLOC;
+  for (i = 0; i < quilt->nElems; i++) {
+    t = quilt->elems[i].tIndex - 1;
+    for (j = 0; j < quilt->types[t].nref; j++)
+      packed->conn[packed->eptr[i]+j] = quilt->elems[i].gIndices[j] - 1;
+  }
+
   return GEM_SUCCESS;
 }
 
 
 static int
-gem_checkQuilt(gemQuilt *quilt, int *ntri, prmTri **tri)
+gem_checkQuilt(int nThread, gemQuilt *quilt, int *ntri, prmTri **tri)
 {
   int    i, j, k, n, t, dref, ntris, own, stat, *fuvs, err = 0;
   prmTri *tris;
@@ -1368,6 +2128,10 @@ gem_checkQuilt(gemQuilt *quilt, int *ntri, prmTri **tri)
   }
   if (err != 0) return GEM_BADINDEX;
   
+  /* the kernels work from the packed copy */
+  stat = gem_packQuilt(quilt);
+  if (stat != GEM_SUCCESS) return stat;
+  
   /* make triangles and neighbors if possibly used for reparametrization */
   
   if (quilt->paramFlg == -1) return GEM_SUCCESS;
@@ -1393,7 +2157,7 @@ gem_checkQuilt(gemQuilt *quilt, int *ntri, prmTri **tri)
       tris[j].indices[2] = quilt->elems[i].gIndices[n];
     }
   }
-  stat = gem_makeNeighbors(quilt->nPoints, ntris, tris);
+  stat = gem_makeNeighbors(nThread, quilt->nPoints, ntris, tris);
   if (stat != GEM_SUCCESS) {
     gem_free(tris);
     return stat;
@@ -1408,17 +2172,13 @@ gem_checkQuilt(gemQuilt *quilt, int *ntri, prmTri **tri)
 static void
 gem_getUVs(gemQuilt *quilt, int iface, int ipt, double *uv)
 {
-  int i, *fuvs;
+  int       i;
+  gemPacked *packed = quilt->packed;
 
-  if (quilt->points[ipt].nFaces < 3) {
-    fuvs = quilt->points[ipt].findices.faces;
-  } else {
-    fuvs = quilt->points[ipt].findices.multi;
-  }
-  for (i = 0; i < quilt->points[ipt].nFaces; i++)
-    if (quilt->faceUVs[fuvs[i]-1].owner == iface) {
-      uv[0] = quilt->faceUVs[fuvs[i]-1].uv[0];
-      uv[1] = quilt->faceUVs[fuvs[i]-1].uv[1];
+  for (i = packed->fptr[ipt]; i < packed->fptr[ipt+1]; i++)
+    if (packed->fown[i] == iface) {
+      uv[0] = packed->uv[2*i  ];
+      uv[1] = packed->uv[2*i+1];
       return;
     }
   
@@ -1427,7 +2187,7 @@ gem_getUVs(gemQuilt *quilt, int iface, int ipt, double *uv)
 
 
 static int
-gem_paramQuilt(gemBound *bound, int ivs)
+gem_paramQuilt(int nThread, gemBound *bound, int ivs)
 {
   int       j, n, stat, npts, ntris, own, nu, nv, per, *ppnts;
   double    params[2], box[6], tol, rmserr, maxerr, dotmin;
@@ -1467,11 +2227,7 @@ gem_paramQuilt(gemBound *bound, int ivs)
     uvf[j].u2 = params[0];
     uvf[j].v2 = params[1];
   }
-  for (j = 0; j < quilt->nPoints; j++) {
-    xyz[3*j  ] = quilt->points[j].xyz[0];
-    xyz[3*j+1] = quilt->points[j].xyz[1];
-    xyz[3*j+2] = quilt->points[j].xyz[2];
-  }
+  memcpy(xyz, quilt->packed->xyz, 3*npts*sizeof(double));
 
   box[0] = box[3] = xyz[0];
   box[1] = box[4] = xyz[1];
@@ -1490,15 +2246,19 @@ gem_paramQuilt(gemBound *bound, int ivs)
   tol   = 1.e-7*sqrt((box[3]-box[0])*(box[3]-box[0]) +
                      (box[4]-box[1])*(box[4]-box[1]) +
                      (box[5]-box[2])*(box[5]-box[2]));
+  GEM_PROFBEG(GEM_PCREATEUV);
   stat  = prm_CreateUV(0, ntris, bound->VSet[ivs].tris, uvf, npts, NULL, NULL,
                        uv, (prmXYZ *) xyz, &per, &ppnts);
+  GEM_PROFEND(GEM_PCREATEUV);
 #ifdef DEBUG
   printf(" gem_paramBound: prm_CreateUV = %d  per = %d\n", stat, per);
 #endif
   if (stat > 0) {
     n    = 2;
+    GEM_PROFBEG(GEM_PSMOOTHUV);
     stat = prm_SmoothUV(3, per, ppnts, ntris, bound->VSet[ivs].tris,
                         npts, 3, uv, xyz);
+    GEM_PROFEND(GEM_PSMOOTHUV);
 #ifdef DEBUG
     printf(" gem_paraBound: prm_SmoothUV = %d\n", stat);
 #endif
@@ -1512,9 +2272,11 @@ gem_paramQuilt(gemBound *bound, int ivs)
         n    = 4;
         nu   = 2*npts;
         nv   = 0;
+        GEM_PROFBEG(GEM_PBESTGRID);
         stat = prm_BestGrid(npts, 3, uv, xyz, ntris, bound->VSet[ivs].tris, tol,
-                            per, ppnts, &nu, &nv, &grid,
+                            per, ppnts, nThread, &nu, &nv, &grid,
                             &rmserr, &maxerr, &dotmin);
+        GEM_PROFEND(GEM_PBESTGRID);
         if (stat == PRM_TOLERANCEUNMET) {
           printf(" gem_paramBound: Tolerance not met: %lf (%lf)!\n",
                  maxerr, tol);
@@ -1554,6 +2316,8 @@ gem_paramQuilt(gemBound *bound, int ivs)
   surface->num       = 0;
   surface->nvm       = 0;
   surface->uvmap     = NULL;
+  surface->khash     = NULL;
+  surface->mhash     = NULL;
   surface->interp    = (double *) gem_allocate(3*4*nu*nv*sizeof(double));
   if (surface->interp == NULL) {
     gem_free(surface);
@@ -1575,6 +2339,11 @@ gem_paramQuilt(gemBound *bound, int ivs)
     gem_freeAprx2D(surface);
     return GEM_DEGENERATE;
   }
+  stat = gem_Aprx2DHash(surface);
+  if (stat != GEM_SUCCESS) {
+    gem_freeAprx2D(surface);
+    return stat;
+  }
   bound->surface = surface;
 
   return ivs;
@@ -1582,10 +2351,10 @@ gem_paramQuilt(gemBound *bound, int ivs)
 
 
 static int
-gem_pickQuilt(gemBound *bound)
+gem_pickQuilt(int nThread, gemBound *bound)
 {
-  int      i, j, k, n, stat, t, in[3];
-  double   *areas, x1[3], x2[3], x3[3], big;
+  int      i, j, k, e, stat, t, in[3], *conn;
+  double   *areas, *xyz, x1[3], x2[3], x3[3], big;
   gemQuilt *quilt;
 
   /* look for "use" quilts */
@@ -1607,7 +2376,10 @@ gem_pickQuilt(gemBound *bound)
           return i;
         }
         if (bound->VSet[i].tris == NULL) return GEM_NOTESSEL;
-        return gem_paramQuilt(bound, i);
+        GEM_PROFBEG(GEM_PPARAMQUILT);
+        stat = gem_paramQuilt(nThread, bound, i);
+        GEM_PROFEND(GEM_PPARAMQUILT);
+        return stat;
       }
     }
   }
@@ -1622,21 +2394,21 @@ gem_pickQuilt(gemBound *bound)
     if (bound->VSet[i].nonconn != NULL) continue;
     quilt = bound->VSet[i].quilt;
     if (quilt->paramFlg == -1) continue;
+    xyz  = quilt->packed->xyz;
+    conn = quilt->packed->conn;
     for (j = 0; j < quilt->nElems; j++) {
       t = quilt->elems[j].tIndex - 1;
+      e = quilt->packed->eptr[j];
       for (k = 0; k < quilt->types[t].ntri; k++) {
-        n     = quilt->types[t].tris[3*k  ] - 1;
-        in[0] = quilt->elems[j].gIndices[n] - 1;
-        n     = quilt->types[t].tris[3*k+1] - 1;
-        in[1] = quilt->elems[j].gIndices[n] - 1;
-        n     = quilt->types[t].tris[3*k+2] - 1;
-        in[2] = quilt->elems[j].gIndices[n] - 1;
-        x1[0] = quilt->points[in[1]].xyz[0] - quilt->points[in[0]].xyz[0];
-        x2[0] = quilt->points[in[2]].xyz[0] - quilt->points[in[0]].xyz[0];
-        x1[1] = quilt->points[in[1]].xyz[1] - quilt->points[in[0]].xyz[1];
-        x2[1] = quilt->points[in[2]].xyz[1] - quilt->points[in[0]].xyz[1];
-        x1[2] = quilt->points[in[1]].xyz[2] - quilt->points[in[0]].xyz[2];
-        x2[2] = quilt->points[in[2]].xyz[2] - quilt->points[in[0]].xyz[2];
+        in[0] = 3*conn[e+quilt->types[t].tris[3*k  ]-1];
+        in[1] = 3*conn[e+quilt->types[t].tris[3*k+1]-1];
+        in[2] = 3*conn[e+quilt->types[t].tris[3*k+2]-1];
+        x1[0] = xyz[in[1]  ] - xyz[in[0]  ];
+        x2[0] = xyz[in[2]  ] - xyz[in[0]  ];
+        x1[1] = xyz[in[1]+1] - xyz[in[0]+1];
+        x2[1] = xyz[in[2]+1] - xyz[in[0]+1];
+        x1[2] = xyz[in[1]+2] - xyz[in[0]+2];
+        x2[2] = xyz[in[2]+2] - xyz[in[0]+2];
         CROSS(x3, x1, x2);
         areas[i] += sqrt(DOT(x3, x3))/2.0;
       }
@@ -1660,7 +2432,9 @@ gem_pickQuilt(gemBound *bound)
       return j;
     }
     if (bound->VSet[j].tris == NULL) continue;
-    stat = gem_paramQuilt(bound, j);
+    GEM_PROFBEG(GEM_PPARAMQUILT);
+    stat = gem_paramQuilt(nThread, bound, j);
+    GEM_PROFEND(GEM_PPARAMQUILT);
     if (stat >= GEM_SUCCESS) {
       gem_free(areas);
       return stat;
@@ -1674,6 +2448,46 @@ gem_pickQuilt(gemBound *bound)
 }
 
 
+static int
+gem_evalRange(void *data, int beg, int end)
+{
+  gemEvalRun *run = (gemEvalRun *) data;
+  
+  if (run->surface != NULL)
+    return gem_invInterpolate2DBatch(run->surface, end-beg, &run->in[3*beg],
+                                     &run->out[2*beg]);
+  if (run->inverse == 0)
+    return gem_kernelEval(run->drep, run->pair, end-beg, &run->in[2*beg],
+                          &run->out[3*beg]);
+  return gem_kernelInvEval(run->drep, run->pair, end-beg, &run->in[3*beg],
+                           &run->out[2*beg]);
+}
+
+
+/*
+ * batched (inverse) evaluations split over threads -- the kernel is only 
+ *   called concurrently if it says that is safe
+ */
+static int
+gem_evalPar(gemDRep *drep, gemPair pair, /*@null@*/ gemAprx2D *surface,
+            int inverse, int npts, double *in, double *out)
+{
+  int        nThread;
+  gemEvalRun run;
+  
+  nThread = gem_drepThreads(drep);
+  if ((surface == NULL) && (gem_kernelThreadSafe() != 1)) nThread = 1;
+  
+  run.drep    = drep;
+  run.pair    = pair;
+  run.surface = surface;
+  run.inverse = inverse;
+  run.in      = in;
+  run.out     = out;
+  return gem_threadRun(nThread, npts, gem_evalRange, &run);
+}
+
+
 int
 gem_paramBound(gemDRep *drep, int boundx)
 {
@@ -1690,6 +2504,7 @@ gem_paramBound(gemDRep *drep, int boundx)
   if ((bound < 1) || (bound > drep->nBound)) return GEM_BADBOUNDINDEX;
   if (drep->bound[bound-1].nVSet == 0) return GEM_NOTCONNECT;
   if (drep->bound[bound-1].nIDs  <= 0) return GEM_NULLOBJ;
+  GEM_PROFSELECT(gem_drepContext(drep));
   
   /* invalidate old parameterization, if any */
   drep->bound[bound-1].uvbox[0] = drep->bound[bound-1].uvbox[1] = 0.0;
@@ -1708,6 +2523,7 @@ gem_paramBound(gemDRep *drep, int boundx)
   
   /* remove any old Dsets from VSets in the bound */
   for (i = 0; i < drep->bound[bound-1].nVSet; i++) {
+    gem_clrLocate(&drep->bound[bound-1].VSet[i]);
     for (j = 0; j < drep->bound[bound-1].VSet[i].nSets; j++) {
       gem_free(drep->bound[bound-1].VSet[i].sets[j].name);
       gem_free(drep->bound[bound-1].VSet[i].sets[j].dset.data);
@@ -1724,8 +2540,7 @@ gem_paramBound(gemDRep *drep, int boundx)
     mindex = gem_metDLoaded(drep->bound[bound-1].VSet[i].disMethod);
     if (mindex < 0) return mindex;
     if (drep->bound[bound-1].VSet[i].quilt != NULL) {
-      freeQuilt[mindex](drep->bound[bound-1].VSet[i].quilt);
-      gem_free(drep->bound[bound-1].VSet[i].quilt);
+      gem_freeQuilt(mindex, drep->bound[bound-1].VSet[i].quilt);
       drep->bound[bound-1].VSet[i].quilt   = NULL;
     }
     if (drep->bound[bound-1].VSet[i].tris != NULL)
@@ -1742,42 +2557,44 @@ gem_paramBound(gemDRep *drep, int boundx)
     if (quilt == NULL) {
       for (j = 0; j < i; j++) {
         if (drep->bound[bound-1].VSet[j].nonconn != NULL) continue;
-        freeQuilt[mindex](drep->bound[bound-1].VSet[j].quilt);
-        gem_free(drep->bound[bound-1].VSet[j].quilt);
+        gem_freeQuilt(mindex, drep->bound[bound-1].VSet[j].quilt);
         drep->bound[bound-1].VSet[j].quilt = NULL;
       }
       return GEM_ALLOC;
     }
     quilt->nbface = i+1;
+    quilt->packed = NULL;
+    GEM_PROFBEG(GEM_PDEFQUILT);
     stat = defQuilt[mindex](drep, drep->bound[bound-1].nIDs,
                             drep->bound[bound-1].indices, quilt);
+    GEM_PROFEND(GEM_PDEFQUILT);
     if (stat != GEM_SUCCESS) {
       printf(" GEM Warning: %s returns %d!\n",
              drep->bound[bound-1].VSet[i].disMethod, stat);
       gem_free(quilt);
       for (j = 0; j < i; j++) {
         if (drep->bound[bound-1].VSet[j].nonconn != NULL) continue;
-        freeQuilt[mindex](drep->bound[bound-1].VSet[j].quilt);
-        gem_free(drep->bound[bound-1].VSet[j].quilt);
+        gem_freeQuilt(mindex, drep->bound[bound-1].VSet[j].quilt);
         drep->bound[bound-1].VSet[j].quilt = NULL;
       }
       return stat;
     }
-    stat = gem_checkQuilt(quilt, &drep->bound[bound-1].VSet[i].ntris,
-                                 &drep->bound[bound-1].VSet[i].tris);
+    GEM_PROFBEG(GEM_PCHECKQUILT);
+    stat = gem_checkQuilt(gem_drepThreads(drep), quilt,
+                          &drep->bound[bound-1].VSet[i].ntris,
+                          &drep->bound[bound-1].VSet[i].tris);
+    GEM_PROFEND(GEM_PCHECKQUILT);
     if (stat != GEM_SUCCESS) {
       printf(" GEM Warning: %s quilt check = %d!\n",
              drep->bound[bound-1].VSet[i].disMethod, stat);
-      freeQuilt[mindex](quilt);
+      gem_freeQuilt(mindex, quilt);
       if (drep->bound[bound-1].VSet[i].tris != NULL)
         gem_free(drep->bound[bound-1].VSet[i].tris);
       drep->bound[bound-1].VSet[i].ntris = 0;
       drep->bound[bound-1].VSet[i].tris  = NULL;
-      gem_free(quilt);
       for (j = 0; j < i; j++) {
         if (drep->bound[bound-1].VSet[j].nonconn != NULL) continue;
-        freeQuilt[mindex](drep->bound[bound-1].VSet[j].quilt);
-        gem_free(drep->bound[bound-1].VSet[j].quilt);
+        gem_freeQuilt(mindex, drep->bound[bound-1].VSet[j].quilt);
         if (drep->bound[bound-1].VSet[i].tris != NULL)
           gem_free(drep->bound[bound-1].VSet[i].tris);
         drep->bound[bound-1].VSet[j].quilt = NULL;
@@ -1875,12 +2692,12 @@ gem_paramBound(gemDRep *drep, int boundx)
       }
       
       for (j = 0; j < sets[0].dset.npts; j++) {
-        k = quilt->points[j].findices.faces[0] - 1;
-        sets[0].dset.data[3*j  ] = quilt->points[j].xyz[0];
-        sets[0].dset.data[3*j+1] = quilt->points[j].xyz[1];
-        sets[0].dset.data[3*j+2] = quilt->points[j].xyz[2];
-        sets[1].dset.data[2*j  ] = quilt->faceUVs[k].uv[0];
-        sets[1].dset.data[2*j+1] = quilt->faceUVs[k].uv[1];
+        k = quilt->packed->fptr[j];
+        sets[0].dset.data[3*j  ] = quilt->packed->xyz[3*j  ];
+        sets[0].dset.data[3*j+1] = quilt->packed->xyz[3*j+1];
+        sets[0].dset.data[3*j+2] = quilt->packed->xyz[3*j+2];
+        sets[1].dset.data[2*j  ] = quilt->packed->uv[2*k  ];
+        sets[1].dset.data[2*j+1] = quilt->packed->uv[2*k+1];
         if (j == 0) {
           uvbox[0] = uvbox[1] = sets[1].dset.data[2*j  ];
           uvbox[2] = uvbox[3] = sets[1].dset.data[2*j+1];
@@ -1908,8 +2725,8 @@ gem_paramBound(gemDRep *drep, int boundx)
           if (sets[3].dset.data[2*j+1] > uvbox[3])
             uvbox[3] = sets[3].dset.data[2*j+1];
         }
-        stat = gem_kernelEval(drep, quilt->bfaces[0], sets[3].dset.npts,
-                              sets[3].dset.data, sets[2].dset.data);
+        stat = gem_evalPar(drep, quilt->bfaces[0], NULL, 0, sets[3].dset.npts,
+                           sets[3].dset.data, sets[2].dset.data);
         if (stat != GEM_SUCCESS) {
           gem_free(sets[0].name);
           gem_free(sets[0].dset.data);
@@ -1943,7 +2760,7 @@ gem_paramBound(gemDRep *drep, int boundx)
 
   /* reparameterize -- select the basis quilt */
   
-  stat = gem_pickQuilt(&drep->bound[bound-1]);
+  stat = gem_pickQuilt(gem_drepThreads(drep), &drep->bound[bound-1]);
   if (stat < GEM_SUCCESS) return stat;
   ivs = stat;
   printf(" GEM Info: VSet %d selected for reParam (gem_paramBound)!\n", ivs+1);
@@ -2009,23 +2826,20 @@ gem_paramBound(gemDRep *drep, int boundx)
       return stat;
     }
 
-    for (j = 0; j < sets[0].dset.npts; j++) {
-      sets[0].dset.data[3*j  ] = quilt->points[j].xyz[0];
-      sets[0].dset.data[3*j+1] = quilt->points[j].xyz[1];
-      sets[0].dset.data[3*j+2] = quilt->points[j].xyz[2];
-    }
+    memcpy(sets[0].dset.data, quilt->packed->xyz,
+           3*sets[0].dset.npts*sizeof(double));
     if (drep->bound[bound-1].surface == NULL) {
       
       if (ivs == i) {
         for (j = 0; j < sets[1].dset.npts; j++) {
-          k = quilt->points[j].findices.faces[0] - 1;
-          sets[1].dset.data[2*j  ] = quilt->faceUVs[k].uv[0];
-          sets[1].dset.data[2*j+1] = quilt->faceUVs[k].uv[1];
+          k = quilt->packed->fptr[j];
+          sets[1].dset.data[2*j  ] = quilt->packed->uv[2*k  ];
+          sets[1].dset.data[2*j+1] = quilt->packed->uv[2*k+1];
         }
       } else {
-        stat = gem_kernelInvEval(drep, drep->bound[bound-1].single,
-                                 quilt->nPoints, sets[0].dset.data,
-                                                 sets[1].dset.data);
+        stat = gem_evalPar(drep, drep->bound[bound-1].single, NULL, 1,
+                           quilt->nPoints, sets[0].dset.data,
+                                           sets[1].dset.data);
         if (stat != GEM_SUCCESS) {
           gem_free(sets[0].name);
           gem_free(sets[0].dset.data);
@@ -2044,9 +2858,9 @@ gem_paramBound(gemDRep *drep, int boundx)
       
     } else {
   
-      for (j = 0; j < sets[0].dset.npts; j++)
-        gem_invInterpolate2D(drep->bound[bound-1].surface,
-                             &sets[0].dset.data[3*j], &sets[1].dset.data[2*j]);
+      gem_evalPar(drep, drep->bound[bound-1].single,
+                  drep->bound[bound-1].surface, 1, sets[0].dset.npts,
+                  sets[0].dset.data, sets[1].dset.data);
     }
     
     if (i == 0) {
@@ -2076,8 +2890,8 @@ gem_paramBound(gemDRep *drep, int boundx)
         for (k = j; k < quilt->nVerts; k++)
           if (quilt->verts[k].owner != owner) break;
 
-        stat = gem_kernelEval(drep, quilt->bfaces[owner-1], k-j,
-                              &sets[3].dset.data[2*j], &sets[2].dset.data[3*j]);
+        stat = gem_evalPar(drep, quilt->bfaces[owner-1], NULL, 0, k-j,
+                           &sets[3].dset.data[2*j], &sets[2].dset.data[3*j]);
         if (stat != GEM_SUCCESS) {
           gem_free(sets[0].name);
           gem_free(sets[0].dset.data);
@@ -2097,9 +2911,9 @@ gem_paramBound(gemDRep *drep, int boundx)
 
       if (drep->bound[bound-1].surface == NULL) {
         if (ivs != i) {
-          stat = gem_kernelInvEval(drep, drep->bound[bound-1].single,
-                                   quilt->nVerts, sets[2].dset.data,
-                                   sets[3].dset.data);
+          stat = gem_evalPar(drep, drep->bound[bound-1].single, NULL, 1,
+                             quilt->nVerts, sets[2].dset.data,
+                             sets[3].dset.data);
           if (stat != GEM_SUCCESS) {
             gem_free(sets[0].name);
             gem_free(sets[0].dset.data);
@@ -2116,9 +2930,9 @@ gem_paramBound(gemDRep *drep, int boundx)
         
       } else {
         
-        for (j = 0; j < sets[3].dset.npts; j++)
-          gem_invInterpolate2D(drep->bound[bound-1].surface,
-                               &sets[2].dset.data[3*j], &sets[3].dset.data[2*j]);
+        gem_evalPar(drep, drep->bound[bound-1].single,
+                    drep->bound[bound-1].surface, 1, sets[3].dset.npts,
+                    sets[2].dset.data, sets[3].dset.data);
       }
       for (j = 0; j < sets[3].dset.npts; j++) {
         if (sets[3].dset.data[2*j  ] < uvbox[0])
@@ -2276,6 +3090,7 @@ gem_getData(gemDRep *drep, int bound, int vs, char *name, int meth, int *npts,
   if ((drep->bound[bound-1].VSet[vs-1].nonconn == NULL) &&
       (drep->bound[bound-1].VSet[vs-1].nSets   == 0)) return GEM_NOTPARAMBND;
   if (name == NULL) return GEM_NULLNAME;
+  GEM_PROFSELECT(gem_drepContext(drep));
 
   /* does the data exist in the Vset? */
   ires = 0;
@@ -2323,7 +3138,8 @@ gem_getData(gemDRep *drep, int bound, int vs, char *name, int meth, int *npts,
       /* interpolate from source */
       stat = gem_dataTransfer(drep, bound, ivsrc, issrc, vs, meth, &iset,
                               Interpolate, Interpol_bar,
-                              Integrate,   Integr_bar,   iEval);
+                              Integrate,   Integr_bar,
+                              InterpBatch, IntegrBatch,  iEval);
       if (stat != GEM_SUCCESS) return stat;
       
     } else if (ires >= nGeomBased) {
@@ -2362,6 +3178,7 @@ gem_getData(gemDRep *drep, int bound, int vs, char *name, int meth, int *npts,
           gem_free(sdat1);
           return GEM_ALLOC;
         }
+        drep->bound[bound-1].VSet[vs-1].sets                   = sets;
         drep->bound[bound-1].VSet[vs-1].nSets                  = iset;
         drep->bound[bound-1].VSet[vs-1].sets[iset-2].ivsrc     = ivsrc;
         drep->bound[bound-1].VSet[vs-1].sets[iset-2].name      = gem_strdup(reserved[2]);
@@ -2391,6 +3208,7 @@ gem_getData(gemDRep *drep, int bound, int vs, char *name, int meth, int *npts,
           gem_free(sdat1);
           return GEM_ALLOC;
         }
+        drep->bound[bound-1].VSet[vs-1].sets                   = sets;
         drep->bound[bound-1].VSet[vs-1].nSets                  = iset;
         drep->bound[bound-1].VSet[vs-1].sets[iset-1].ivsrc     = ivsrc;
         drep->bound[bound-1].VSet[vs-1].sets[iset-1].name      = gem_strdup(name);
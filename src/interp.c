@@ -1014,7 +1014,7 @@ int gem_Interp2DFit(int nrank, int npts, double *uvx, double *values,
     return GEM_NOTFOUND;
   }
   nu   = npts;
-  stat = prm_BestGrid(npts, nrank, uvs, values, 0, NULL, tol, periodic, NULL,
+  stat = prm_BestGrid(npts, nrank, uvs, values, 0, NULL, tol, periodic, NULL, 1,
                       &nu, &nv, &fit, &rmserr, &maxerr, &dotmin);
 #ifdef DEBUG
   printf(" gem_Interp2DFit: prm_BestGrid Values errors = %d  %d %d  %lf %lf\n",
@@ -1032,7 +1032,7 @@ int gem_Interp2DFit(int nrank, int npts, double *uvx, double *values,
     return GEM_NULLOBJ;
   }
   num  = 1.5*npts;
-  stat = prm_BestGrid(npts, 2, uvs, uvx, 0, NULL, tol, periodic,  NULL,
+  stat = prm_BestGrid(npts, 2, uvs, uvx, 0, NULL, tol, periodic,  NULL, 1,
                       &num, &nvm, &uvfit, &rmserr, &maxerr, &dotmin);
 #ifdef DEBUG
   printf(" gem_Interp2DFit: prm_BestGrid UVs    errors = %d  %d %d  %lf %lf\n",
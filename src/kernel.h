@@ -14,6 +14,10 @@
 extern int
 gem_kernelInit(void);
 
+/* can the kernel evaluate/tessellate concurrently (1) or not (0)? */
+extern int
+gem_kernelThreadSafe(void);
+
 /* terminates the kernel */
 extern int
 gem_kernelClose(void);
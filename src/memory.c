@@ -12,33 +12,164 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include "gem.h"
+#include "memory.h"
+
+
+#define MAXALLOC    32          /* limit on the number of allocators */
+#define ARENABLOCK  65536       /* minimum arena block size in bytes */
+#define ARENAALIGN  16          /* alignment of arena pieces */
+
+#ifdef WIN32
+#define MEMADD(a, v)    InterlockedExchangeAdd64(&(a), (v))
+#define MEMCAS(a, o, n) InterlockedCompareExchange64(&(a), (n), (o))
+#else
+#define MEMADD(a, v)    __sync_fetch_and_add(&(a), (v))
+#define MEMCAS(a, o, n) __sync_val_compare_and_swap(&(a), (o), (n))
+#endif
+
+
+/* the header in front of each block -- sized to keep the alignment */
+  typedef union {
+    struct {
+      size_t nbytes;            /* the size requested */
+      int    slot;              /* the allocator that made the block */
+    } h;
+    double align[2];
+  } memHead;
+
+/* an arena block -- the pieces follow the (aligned) header */
+  typedef struct arenaBlk {
+    struct arenaBlk *prev;      /* the previous (older) block */
+    size_t          size;       /* usable bytes in the block */
+    size_t          base;       /* arena offset of the first usable byte */
+  } arenaBlk;
+
+#define ARENAHEAD   ((sizeof(arenaBlk)+ARENAALIGN-1)/ARENAALIGN*ARENAALIGN)
+
+
+static void *
+mem_malloc(/*@unused@*/ void *user, size_t nbytes)
+{
+  return malloc(nbytes);
+}
+
+
+static void *
+mem_realloc(/*@unused@*/ void *user, void *ptr, size_t nbytes)
+{
+  return realloc(ptr, nbytes);
+}
+
+
+static void
+mem_release(/*@unused@*/ void *user, void *ptr)
+{
+  free(ptr);
+}
+
+
+/* slots are never reused so that blocks always go back to their maker */
+  static gemAllocator memAllocs[MAXALLOC] = {
+                                      {mem_malloc, mem_realloc, mem_release,
+                                       NULL} };
+  static int          memNslot  = 1;
+  static int          memActive = 0;
+
+  static long long    memNalloc   = 0;
+  static long long    memNrealloc = 0;
+  static long long    memNfree    = 0;
+  static long long    memInUse    = 0;
+  static long long    memPeak     = 0;
+
+
+static void
+gem_memGrow(long long nbytes)
+{
+  long long cur, old, prev;
+
+  cur = MEMADD(memInUse, nbytes) + nbytes;
+  old = memPeak;
+  while (cur > old) {
+    prev = MEMCAS(memPeak, old, cur);
+    if (prev == old) break;
+    old = prev;
+  }
+}
 
 
 /*@null@*/ /*@out@*/ /*@only@*/ void *
 gem_allocate(size_t nbytes)
 {
-  return malloc(nbytes);
+  int          slot;
+  memHead      *head;
+  gemAllocator *alloc;
+
+  slot  = memActive;
+  alloc = &memAllocs[slot];
+  head  = (memHead *) alloc->allocate(alloc->user, nbytes+sizeof(memHead));
+  if (head == NULL) return NULL;
+  head->h.nbytes = nbytes;
+  head->h.slot   = slot;
+  MEMADD(memNalloc, 1);
+  gem_memGrow(nbytes);
+
+  return head + 1;
 }
 
 
 void
 gem_free(/*@null@*/ /*@only@*/ void *ptr)
 {
-  if (ptr != NULL) free(ptr);
+  memHead      *head;
+  gemAllocator *alloc;
+
+  if (ptr == NULL) return;
+
+  head  = (memHead *) ptr - 1;
+  alloc = &memAllocs[head->h.slot];
+  MEMADD(memNfree, 1);
+  MEMADD(memInUse, -(long long) head->h.nbytes);
+  alloc->release(alloc->user, head);
 }
 
 
 /*@null@*/ /*@only@*/ void *
 gem_callocate(size_t nele, size_t size)
 {
-  return calloc(nele, size);
+  void *ptr;
+
+  ptr = gem_allocate(nele*size);
+  if (ptr != NULL) memset(ptr, 0, nele*size);
+
+  return ptr;
 }
 
 
 /*@null@*/ /*@only@*/ void *
 gem_reallocate(/*@null@*/ /*@only@*/ /*@returned@*/ void *ptr, size_t nbytes)
 {
-  return realloc(ptr, nbytes);
+  size_t       old;
+  memHead      *head;
+  gemAllocator *alloc;
+
+  if (ptr == NULL) return gem_allocate(nbytes);
+
+  head  = (memHead *) ptr - 1;
+  old   = head->h.nbytes;
+  alloc = &memAllocs[head->h.slot];
+  head  = (memHead *) alloc->reallocate(alloc->user, head,
+                                        nbytes+sizeof(memHead));
+  if (head == NULL) return NULL;
+  head->h.nbytes = nbytes;
+  MEMADD(memNrealloc, 1);
+  gem_memGrow((long long) nbytes - (long long) old);
+
+  return head + 1;
 }
 
 
@@ -57,3 +188,202 @@ gem_strdup(/*@null@*/ const char *str)
 
   return dup;
 }
+
+
+/*
+ * makes alloc (NULL -- malloc) the active allocator and returns its slot --
+ *   not to be called while other threads are allocating
+ */
+int
+gem_memAllocator(/*@null@*/ gemAllocator *alloc)
+{
+  int i;
+
+  if (alloc == NULL) {
+    memActive = 0;
+    return 0;
+  }
+  if ((alloc->allocate == NULL) || (alloc->reallocate == NULL) ||
+      (alloc->release  == NULL)) return GEM_NULLVALUE;
+
+  for (i = 0; i < memNslot; i++)
+    if ((memAllocs[i].allocate   == alloc->allocate)   &&
+        (memAllocs[i].reallocate == alloc->reallocate) &&
+        (memAllocs[i].release    == alloc->release)    &&
+        (memAllocs[i].user       == alloc->user)) break;
+  if (i == memNslot) {
+    if (memNslot == MAXALLOC) return GEM_BADVALUE;
+    memAllocs[i] = *alloc;
+    memNslot++;
+  }
+  memActive = i;
+
+  return i;
+}
+
+
+/*
+ * the slot of the active allocator
+ */
+int
+gem_memActive()
+{
+  return memActive;
+}
+
+
+/*
+ * the allocation statistics -- reset restarts the counts and the peak
+ */
+void
+gem_memStats(int reset, gemMemStats *stats)
+{
+  stats->nAlloc   = memNalloc;
+  stats->nRealloc = memNrealloc;
+  stats->nFree    = memNfree;
+  stats->inUse    = memInUse;
+  stats->peak     = memPeak;
+  if (reset == 0) return;
+
+  memNalloc   = 0;
+  memNrealloc = 0;
+  memNfree    = 0;
+  memPeak     = memInUse;
+}
+
+
+/*
+ * scratch arenas -- pieces are taken in order from a chain of blocks and
+ *   given back by rewinding to a mark; the blocks are kept so that repeated
+ *   use settles into a single block with no allocator traffic
+ */
+void
+gem_arenaInit(gemArena *arena)
+{
+  arena->block = NULL;
+  arena->used  = 0;
+  arena->high  = 0;
+}
+
+
+size_t
+gem_arenaMark(gemArena *arena)
+{
+  arenaBlk *blk = (arenaBlk *) arena->block;
+
+  if (blk == NULL) return 0;
+  return blk->base + arena->used;
+}
+
+
+/*@null@*/ /*@out@*/ void *
+gem_arenaAlloc(gemArena *arena, size_t nbytes)
+{
+  size_t   size, base;
+  arenaBlk *blk, *last;
+
+  nbytes = (nbytes+ARENAALIGN-1)/ARENAALIGN*ARENAALIGN;
+  if (nbytes == 0) nbytes = ARENAALIGN;
+  last   = (arenaBlk *) arena->block;
+  if ((last != NULL) && (arena->used+nbytes <= last->size)) {
+    arena->used += nbytes;
+    return (char *) last + ARENAHEAD + arena->used - nbytes;
+  }
+
+  size = ARENABLOCK;
+  base = 0;
+  if (last != NULL) {
+    size = 2*last->size;
+    base = last->base + last->size;
+  }
+  if (size < nbytes) size = nbytes;
+  blk = (arenaBlk *) gem_allocate(ARENAHEAD+size);
+  if (blk == NULL) return NULL;
+  blk->prev    = last;
+  blk->size    = size;
+  blk->base    = base;
+  arena->block = blk;
+  arena->used  = nbytes;
+  if (base+size > arena->high) arena->high = base + size;
+
+  return (char *) blk + ARENAHEAD;
+}
+
+
+void
+gem_arenaRelease(gemArena *arena, size_t mark)
+{
+  size_t   size;
+  arenaBlk *blk, *prev;
+
+  blk = (arenaBlk *) arena->block;
+  if (blk == NULL) return;
+
+  /* empty -- fold the chain into one block that holds all it has held */
+  if ((mark == 0) && ((blk->prev != NULL) || (blk->size < arena->high))) {
+    size = arena->high;
+    gem_arenaFree(arena);
+    blk = (arenaBlk *) gem_allocate(ARENAHEAD+size);
+    if (blk == NULL) return;
+    blk->prev    = NULL;
+    blk->size    = size;
+    blk->base    = 0;
+    arena->block = blk;
+    arena->high  = size;
+    return;
+  }
+
+  while ((blk->prev != NULL) && (blk->base > mark)) {
+    prev = blk->prev;
+    gem_free(blk);
+    blk  = prev;
+  }
+  arena->block = blk;
+  arena->used  = (mark > blk->base) ? mark - blk->base : 0;
+}
+
+
+void
+gem_arenaFree(gemArena *arena)
+{
+  arenaBlk *blk, *prev;
+
+  blk = (arenaBlk *) arena->block;
+  while (blk != NULL) {
+    prev = blk->prev;
+    gem_free(blk);
+    blk  = prev;
+  }
+  arena->block = NULL;
+  arena->used  = 0;
+  arena->high  = 0;
+}
+
+
+/*
+ * memory reports -- the bytes come from the block headers
+ */
+void
+gem_memCount(gemMemReport *report, int cat, /*@null@*/ const void *ptr)
+{
+  const memHead *head;
+
+  if (ptr == NULL) return;
+
+  head = (const memHead *) ptr - 1;
+  report->bytes[cat] += head->h.nbytes;
+  report->count[cat]++;
+}
+
+
+/* the blocks of an arena (not the arena itself) */
+void
+gem_memArena(gemMemReport *report, int cat, /*@null@*/ gemArena *arena)
+{
+  arenaBlk *blk;
+
+  if (arena == NULL) return;
+
+  for (blk = (arenaBlk *) arena->block; blk != NULL; blk = blk->prev)
+    gem_memCount(report, cat, blk);
+}
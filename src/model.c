@@ -18,7 +18,9 @@
 #include "kernel.h"
 
 
-  extern int  gem_clrDReps(gemModel *model, int phase);
+  extern int  gem_growDReps(gemModel *model, int nBRep, int phase);
+  extern void gem_memCount(gemMemReport *report, int cat, 
+                           /*@null@*/ const void *ptr);
 
 
 void
@@ -116,6 +118,94 @@ gem_clrModel(/*@only@*/ gemModel *model)
 }
 
 
+/*
+ * the storage of a BRep -- instances share the Body of their owner
+ */
+void
+gem_memBRep(gemBRep *brep, gemMemReport *report)
+{
+  int     i, cat = GEM_MEMMODEL;
+  gemBody *body;
+
+  gem_memCount(report, cat, brep);
+  body = brep->body;
+  if ((body == NULL) || (brep->inumber != 0)) return;
+
+  for (i = 0; i < body->nnode; i++)
+    gem_memAttribs(body->nodes[i].attr, cat, report);
+  gem_memCount(report, cat, body->nodes);
+
+  for (i = 0; i < body->nedge; i++)
+    gem_memAttribs(body->edges[i].attr, cat, report);
+  gem_memCount(report, cat, body->edges);
+
+  for (i = 0; i < body->nloop; i++) {
+    gem_memCount(report, cat, body->loops[i].edges);
+    gem_memAttribs(body->loops[i].attr, cat, report);
+  }
+  gem_memCount(report, cat, body->loops);
+
+  for (i = 0; i < body->nface; i++) {
+    gem_memCount(report, cat, body->faces[i].loops);
+    gem_memCount(report, cat, body->faces[i].ID);
+    gem_memAttribs(body->faces[i].attr, cat, report);
+  }
+  gem_memCount(report, cat, body->faces);
+
+  for (i = 0; i < body->nshell; i++) {
+    gem_memCount(report, cat, body->shells[i].faces);
+    gem_memAttribs(body->shells[i].attr, cat, report);
+  }
+  gem_memCount(report, cat, body->shells);
+
+  gem_memAttribs(body->attr, cat, report);
+  gem_memCount(report, cat, body);
+}
+
+
+/*
+ * the storage of a Model -- as released by gem_clrModel
+ */
+void
+gem_memModel(gemModel *model, gemMemReport *report)
+{
+  int i, cat = GEM_MEMMODEL;
+
+  gem_memCount(report, cat, model->server);
+  gem_memCount(report, cat, model->location);
+  gem_memCount(report, cat, model->modeler);
+  for (i = 0; i < model->nBRep; i++) gem_memBRep(model->BReps[i], report);
+  gem_memCount(report, cat, model->BReps);
+
+  for (i = 0; i < model->nParams; i++) {
+    gem_memCount(report, cat, model->Params[i].name);
+    if (model->Params[i].type == GEM_SPLINE) {
+      gem_memCount(report, cat, model->Params[i].vals.splpnts);
+    } else if (model->Params[i].type == GEM_STRING) {
+      gem_memCount(report, cat, model->Params[i].vals.string);
+    } else if (model->Params[i].len > 1) {
+      gem_memCount(report, cat, model->Params[i].vals.reals);
+    }
+    gem_memAttribs(model->Params[i].attr, cat, report);
+  }
+  gem_memCount(report, cat, model->Params);
+
+  for (i = 0; i < model->nBranches; i++) {
+    gem_memCount(report, cat, model->Branches[i].name);
+    if (model->Branches[i].nParents > 1)
+      gem_memCount(report, cat, model->Branches[i].parents.pnodes);
+    if (model->Branches[i].nChildren > 1)
+      gem_memCount(report, cat, model->Branches[i].children.nodes);
+    gem_memCount(report, cat, model->Branches[i].branchType);
+    gem_memAttribs(model->Branches[i].attr, cat, report);
+  }
+  gem_memCount(report, cat, model->Branches);
+
+  gem_memAttribs(model->attr, GEM_MEMOTHER, report);
+  gem_memCount(report, GEM_MEMOTHER, model);
+}
+
+
 int
 gem_releaseModel(/*@only@*/ gemModel *model)
 {
@@ -656,6 +746,7 @@ gem_copyModel(gemModel *model, gemModel **newModel)
   mdl->location  = gem_strdup(model->location);
   mdl->modeler   = gem_strdup(model->modeler);
   mdl->nBRep     = model->nBRep;
+  mdl->mBRep     = model->nBRep;
   mdl->BReps     = BReps;
   mdl->nParams   = 0;
   mdl->Params    = NULL;
@@ -688,48 +779,87 @@ gem_copyModel(gemModel *model, gemModel **newModel)
 
 
 int
-gem_add2Model(gemModel *model, gemBRep *brep, /*@null@*/ double *xform)
+gem_addBReps2Model(gemModel *model, int nBRep, gemBRep **BReps,
+                   /*@null@*/ double *xforms)
 {
-  int     stat;
-  gemBRep *added, **BReps;
+  int     i, j, m, stat;
+  gemBRep **added, **slots;
 
   if (model == NULL) return GEM_NULLOBJ;
   if (model->magic != GEM_MMODEL) return GEM_BADMODEL;
-  if (brep == NULL)  return GEM_NULLOBJ;
-  if (brep->magic  != GEM_MBREP)  return GEM_BADBREP;
+  if (nBRep <= 0) return GEM_BADVALUE;
+  if (BReps == NULL) return GEM_NULLOBJ;
+  for (i = 0; i < nBRep; i++) {
+    if (BReps[i] == NULL) return GEM_NULLOBJ;
+    if (BReps[i]->magic != GEM_MBREP) return GEM_BADBREP;
+  }
   if (model->nonparam == 0) return GEM_NOTPARMTRIC;
   /* make sure we have been initiated by staticModel */
   if (model->handle.index     != 0)    return GEM_BADTYPE;
   if (model->handle.ident.ptr != NULL) return GEM_BADTYPE;
   
-  /* make copy of transformed brep and place it in model */
+  /* make copies of the transformed breps */
+  
+  added = (gemBRep **) gem_allocate(nBRep*sizeof(gemBRep *));
+  if (added == NULL) return GEM_ALLOC;
+  for (i = 0; i < nBRep; i++) {
+    if (xforms == NULL) {
+      stat = gem_kernelCopy(BReps[i], NULL, &added[i]);
+    } else {
+      stat = gem_kernelCopy(BReps[i], &xforms[12*i], &added[i]);
+    }
+    if (stat != GEM_SUCCESS) {
+      for (j = 0; j < i; j++) {
+        gem_kernelDelete(added[j]->body->handle);
+        gem_releaseBRep(added[j]);
+      }
+      gem_free(added);
+      return stat;
+    }
+    added[i]->omodel = model;
+  }
   
-  stat = gem_kernelCopy(brep, xform, &added);
-  if (stat != GEM_SUCCESS) return stat;
-  added->omodel = model;
+  /* make room in the model (doubling) & in its DReps */
   
-  if (model->nBRep == 0) {
-    BReps = (gemBRep **) gem_allocate(sizeof(gemBRep *));
-  } else {
-    BReps = (gemBRep **) gem_reallocate( model->BReps,
-                                        (model->nBRep+1)*sizeof(gemBRep *));
+  stat = GEM_SUCCESS;
+  if (model->nBRep+nBRep > model->mBRep) {
+    m = 2*model->mBRep;
+    if (m < model->nBRep+nBRep) m = model->nBRep+nBRep;
+    slots = (gemBRep **) gem_reallocate(model->BReps, m*sizeof(gemBRep *));
+    if (slots == NULL) {
+      stat = GEM_ALLOC;
+    } else {
+      model->BReps = slots;
+      model->mBRep = m;
+    }
   }
-  if (BReps == NULL) {
-    gem_kernelDelete(added->body->handle);
-    gem_releaseBRep(added);
-    return GEM_ALLOC;
+  if (stat == GEM_SUCCESS)
+    stat = gem_growDReps(model, model->nBRep+nBRep, 0);
+  if (stat != GEM_SUCCESS) {
+    for (i = 0; i < nBRep; i++) {
+      gem_kernelDelete(added[i]->body->handle);
+      gem_releaseBRep(added[i]);
+    }
+    gem_free(added);
+    return stat;
   }
   
-  gem_clrDReps(model, 0);
-  BReps[model->nBRep] = added;
-  model->BReps  = BReps;
-  model->nBRep += 1;
-  gem_clrDReps(model, 1);
+  for (i = 0; i < nBRep; i++) model->BReps[model->nBRep+i] = added[i];
+  model->nBRep += nBRep;
+  gem_free(added);
+  gem_growDReps(model, model->nBRep, 1);
 
   return GEM_SUCCESS;
 }
 
 
+int
+gem_add2Model(gemModel *model, gemBRep *brep, /*@null@*/ double *xform)
+{
+  return gem_addBReps2Model(model, 1, &brep, xform);
+}
+
+
 int
 gem_saveModel(gemModel *model, /*@null@*/ char *filename)
 {
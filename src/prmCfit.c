@@ -47,7 +47,7 @@ static int    splineWithGaps1d        (int, double[], double[], int, int,
 /*
  * external routines defined in prmUV
  */
-extern int    sparseBCG               (double[], int[], double[], double[]);
+extern int    sparseILU               (double[], int[], int, double[], double[]);
 
 /*
  * global constants
@@ -1481,8 +1481,8 @@ splineWithGaps1d(int      nvrt,              /* (in)   number of Vertices to fit
         /*
          * solve for the new x-locations
          */
-        status = sparseBCG(asmf, ismf, xx, rhs);
-        DPRINT1("sparseBCG -> status=%d", status);
+        status = sparseILU(asmf, ismf, 1, xx, rhs);
+        DPRINT1("sparseILU -> status=%d", status);
         CHECK_STATUS;
 
         if (ipin > maxpin) break;
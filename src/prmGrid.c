@@ -16,12 +16,32 @@
 #include "gem.h"
 #include "memory.h"
 #include "prm.h"
+#include "profile.h"
 
 #ifdef GRAFIC
 #include "grafic.h"
 #endif
 
 
+/*
+ * a trial refinement (the U and V trials in prm_BestGrid may run concurrently)
+ */
+typedef struct {
+    int         dtype;                  /* division type (0 if not tried) */
+    gridTree    *base;                  /* Tree to refine */
+    double      *resid0;                /* residuals of base */
+    gridTree    *tree;                  /* refined Tree */
+    double      *resid;                 /* residuals of tree */
+    int         nsize;                  /* size of the residuals (bytes) */
+    int         nvrt;                   /* number of Vertices */
+    int         periodic;               /* periodicity flag */
+    int         *ppnts;                 /* indices of periodic points */
+    prmUV       *uv;                    /* array  of Vertices */
+    double      rmserr;                 /* RMS     error of tree */
+    double      maxerr;                 /* maximum error of tree */
+} gridTrial;
+
+
 /*
  * internal routines defined below
  */
@@ -41,6 +61,7 @@ static int    globalRefine2d          (int, gridTree*, int, int, /*@null@*/int[]
                                        prmUV[], double[], double*, double*);
 static int    initialTree2d           (gridTree*, int, int, int, /*@null@*/int[],
                                        prmUV[], double[], double*, double*);
+static int    latticeCells            (gridTree*);
 #ifdef GRAFIC
 static void   plotGrid                (int, int, int, int, prmUV[], double[], double[], double[]);
 static void   plotGridImage           (int*, void*, void*, void*, void*, void*,
@@ -62,14 +83,20 @@ static void   plotVrtsImage           (int*, void*, void*, void*, void*, void*,
 #ifdef DEBUG
 static void   printTree               (FILE*, gridTree*);
 #endif
-static int    splineWithGaps2d        (int, prmUV[], double[], int, /*@null@*/int[], int, int,
-                                       double[], double[], double[], double[]);
+static int    refineTrials            (void*, int, int);
+static int    splineWithGaps2d        (int, prmUV[], int, double[], int, /*@null@*/int[],
+                                       int, int, double[], double[], double[], double[]);
 
 /*
  * external routines defined in prmUV
  */
 extern int    printSMF                (FILE*, double[], int[], double[], double[]);
-extern int    sparseBCG               (double[], int[], double[], double[]);
+extern int    sparseILU               (double[], int[], int, double[], double[]);
+
+/*
+ * external routines defined in thread
+ */
+extern int    gem_threadTasks         (int, int, int (*)(void*, int, int), void*);
 
 /*
  * global constants
@@ -245,7 +272,6 @@ static FILE     *dbg_fp = NULL;         /* file pointer for debug information */
         DPRINT2("freeing %s in routine %s", #PTR, routine);\
         gem_free(PTR);\
         PTR = NULL;
-static void *realloc_temp = NULL;            /* used by RALLOC macro */
 #define MEMCPY(DEST,SRC,SIZE) \
         if ((SIZE) > 0) {\
             memcpy(DEST,SRC,SIZE);\
@@ -365,6 +391,7 @@ copyGrid(gridTree *dest,                     /* (out)  pointer to destination Tr
      */
     FREE(dest->cell);
     FREE(dest->knot);
+    FREE(dest->lcel);
 
     /*
      * copy the scalar data
@@ -384,6 +411,11 @@ copyGrid(gridTree *dest,                     /* (out)  pointer to destination Tr
     MEMCPY(dest->cell, src->cell, (dest->ncel)               *sizeof(gridCell));
     MEMCPY(dest->knot, src->knot, (dest->nknt)*4*(dest->nvar)*sizeof(double  ));
 
+    if (src->lcel != NULL) {
+        MALLOC(dest->lcel, int,    (dest->nu-1)*(dest->nv-1)  );
+        MEMCPY(dest->lcel, src->lcel, (dest->nu-1)*(dest->nv-1)*sizeof(int     ));
+    }
+
  cleanup:
     DPRINT2("%s --> status=%d}", routine, status);
     return status;
@@ -416,6 +448,7 @@ divideCell(gridTree *tree,                   /* (in)   pointer to Grid Tree */
     int         nborws, nborwn, nbores, nboren;
     int         nborsw, nborse, nbornw, nborne;
     double      umin, umax, vmin, vmax;
+    void        *realloc_temp = NULL;        /* used by RALLOC macro */
 
     int         nvar4 = 4 * tree->nvar;
 
@@ -705,6 +738,11 @@ divideCell(gridTree *tree,                   /* (in)   pointer to Grid Tree */
 //$$$    DPRINT3("     %5d     %5d     %5d",    knot00, knot10, knot20);
 //$$$    DPRINT2("          %5d     %5d",       nborsw, nborse);
 
+    /*
+     * the lattice (if any) no longer describes the finest Cells
+     */
+    FREE(tree->lcel);
+
     /*
      * extend the Cell array for the new Cells
      */
@@ -1154,7 +1192,8 @@ finestCell(gridTree *tree,                   /* (in)   Grid Tree */
 {
     int         icel = 0;                    /* (out)  finest Cell containing u,v */
 
-    double      umin, umax, vmin, vmax;
+    double      umin, umax, vmin, vmax, x;
+    int         ii, jj, nlu, nlv;
 
 //    ROUTINE(finestCell);
 //    DPRINT3("%s(u=%f, v=%f) {",
@@ -1162,6 +1201,35 @@ finestCell(gridTree *tree,                   /* (in)   Grid Tree */
 
     /* ----------------------------------------------------------------------- */
 
+    /*
+     * if the finest Cells form a lattice, pick the slot directly (a
+     *    point on a Cell boundary goes to the lower Cell, as below)
+     */
+    if (tree->lcel != NULL) {
+        nlu = tree->nu - 1;
+        nlv = tree->nv - 1;
+
+        x = u * nlu;
+        if        (x <= 0  ) {
+            ii = 0;
+        } else if (x <  nlu) {
+            ii = (int) ceil(x) - 1;
+        } else {
+            ii = nlu - 1;
+        }
+
+        x = v * nlv;
+        if        (x <= 0  ) {
+            jj = 0;
+        } else if (x <  nlv) {
+            jj = (int) ceil(x) - 1;
+        } else {
+            jj = nlv - 1;
+        }
+
+        return tree->lcel[ii + nlu * jj];
+    }
+
     /*
      * traverse the Tree until we find an undivided Cell
      */
@@ -1232,12 +1300,12 @@ globalRefine2d(int      dtype,               /* (in)   division type */
                                              /*        PRM_NOTCONVERGED */
                                              /*        PRM_BADPARAM */
 
-    double      *xvrt   = NULL;
     double      *xspln  = NULL;
     double      *uspln  = NULL;
     double      *vspln  = NULL;
     double      *cspln  = NULL;
     double      *xyz    = NULL;
+    int         *vcel   = NULL;
 
     int         ibeg, iend, ii, jj, ivrt, ivar, icel, iknt, nuv;
     int         ncel, nknt;
@@ -1299,12 +1367,19 @@ globalRefine2d(int      dtype,               /* (in)   division type */
         CHECK_STATUS;
     }
 
+    status = latticeCells(tree);
+    CHECK_STATUS;
+
     /*
-     * count number of Vertices in each new Cell
+     * count number of Vertices in each new Cell (and remember the Cell
+     *    so that the residuals below do not have to search for it)
      */
+    MALLOC(vcel, int, nvrt);
+
     for (ivrt = 0; ivrt < nvrt; ivrt++) {
         icel = finestCell(tree, uv[ivrt].u, uv[ivrt].v);
         tree->cell[icel].count++;
+        vcel[ivrt] = icel;
     }
 
 #ifdef DEBUG
@@ -1317,29 +1392,21 @@ globalRefine2d(int      dtype,               /* (in)   division type */
     nuv =             (tree->nu    ) * (tree->nv    );
     DPRINT2("nu=%d, nv=%d", tree->nu, tree->nv);
 
-    MALLOC(xvrt,  double, nvrt);
-    MALLOC(xspln, double, nuv );
-    MALLOC(uspln, double, nuv );
-    MALLOC(vspln, double, nuv );
-    MALLOC(cspln, double, nuv );
+    MALLOC(xspln, double, nuv*nvar);
+    MALLOC(uspln, double, nuv*nvar);
+    MALLOC(vspln, double, nuv*nvar);
+    MALLOC(cspln, double, nuv*nvar);
+
+    /*
+     * spline fit for all the variables at once
+     */
+    status = splineWithGaps2d(nvrt, uv, nvar, resid, periodic, ppnts,
+                              tree->nu, tree->nv, xspln, uspln, vspln, cspln);
+    CHECK_STATUS;
 
     for (ivar = 0; ivar < nvar; ivar++) {
         DPRINT1("working on ivar=%d", ivar);
 
-        /*
-         * copy the Vertex data into xvrt
-         */
-        for (ivrt = 0; ivrt < nvrt; ivrt++) {
-            xvrt[ivrt] = resid[nvar*ivrt+ivar];
-        }
-
-        /*
-         * spline fit for this group
-         */
-        status = splineWithGaps2d(nvrt, uv, xvrt, periodic, ppnts,
-                                  tree->nu, tree->nv, xspln, uspln, vspln, cspln);
-        CHECK_STATUS;
-
         /*
          * store the data in the Knots
          */
@@ -1348,28 +1415,28 @@ globalRefine2d(int      dtype,               /* (in)   division type */
             jj = tree->nv * tree->cell[icel].vmin;
 
             iknt = tree->cell[icel].swKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj  )];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
 
             iknt = tree->cell[icel].seKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj  )];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
 
             iknt = tree->cell[icel].nwKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj+1)];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
 
             iknt = tree->cell[icel].neKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj+1)];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
         }
     }
 
@@ -1381,45 +1448,41 @@ globalRefine2d(int      dtype,               /* (in)   division type */
         uu = uv[ivrt].u;
         vv = uv[ivrt].v;
 
-        for (icel = ncel; icel < tree->ncel; icel++) {
-            umin = tree->cell[icel].umin;
-            umax = tree->cell[icel].umax;
-            vmin = tree->cell[icel].vmin;
-            vmax = tree->cell[icel].vmax;
-
-            if (uu >= umin && uu <= umax && vv >= vmin && vv <= vmax) {
-                ss  = (uu - umin) / (umax - umin);
-                tt  = (vv - vmin) / (vmax - vmin);
-                evalBicubic(ss, tt, nvar,
-                            &(tree->knot[nvar4*(tree->cell[icel].swKnot)]),
-                            &(tree->knot[nvar4*(tree->cell[icel].seKnot)]),
-                            &(tree->knot[nvar4*(tree->cell[icel].nwKnot)]),
-                            &(tree->knot[nvar4*(tree->cell[icel].neKnot)]),
-                            xyz, NULL, NULL, NULL, NULL, NULL);
+        icel = vcel[ivrt];
+        umin = tree->cell[icel].umin;
+        umax = tree->cell[icel].umax;
+        vmin = tree->cell[icel].vmin;
+        vmax = tree->cell[icel].vmax;
 
-                for (ivar = 0; ivar < nvar; ivar++) {
-                    resid[nvar*ivrt+ivar] -= xyz[ivar];
-                    err = fabs(resid[nvar*ivrt+ivar]);
+        ss  = (uu - umin) / (umax - umin);
+        tt  = (vv - vmin) / (vmax - vmin);
+        evalBicubic(ss, tt, nvar,
+                    &(tree->knot[nvar4*(tree->cell[icel].swKnot)]),
+                    &(tree->knot[nvar4*(tree->cell[icel].seKnot)]),
+                    &(tree->knot[nvar4*(tree->cell[icel].nwKnot)]),
+                    &(tree->knot[nvar4*(tree->cell[icel].neKnot)]),
+                    xyz, NULL, NULL, NULL, NULL, NULL);
+
+        for (ivar = 0; ivar < nvar; ivar++) {
+            resid[nvar*ivrt+ivar] -= xyz[ivar];
+            err = fabs(resid[nvar*ivrt+ivar]);
 
-                    tree->cell[icel].rmserr += SQR(err);
-                    *rmserr                 += SQR(err);
-                    *maxerr = MAX(*maxerr,         err);
+            tree->cell[icel].rmserr += SQR(err);
+            *rmserr                 += SQR(err);
+            *maxerr = MAX(*maxerr,         err);
 
-                    if (err > tree->cell[icel].maxerr) tree->cell[icel].maxerr = err;
-                }
-                break;
-            }
+            if (err > tree->cell[icel].maxerr) tree->cell[icel].maxerr = err;
         }
     }
 
     *rmserr = sqrt(*rmserr / nvrt);
 
  cleanup:
+    FREE(vcel );
     FREE(cspln);
     FREE(vspln);
     FREE(uspln);
     FREE(xspln);
-    FREE(xvrt );
     FREE(xyz  );
 
     DPRINT4("%s --> rmserr=%f, maxerr=%f, status=%d}",
@@ -1452,14 +1515,13 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
                                              /*        PRM_NOTCONVERGED */
                                              /*        PRM_BADPARAM */
 
-    double      *xvrt   = NULL;
     double      *xspln  = NULL;
     double      *uspln  = NULL;
     double      *vspln  = NULL;
     double      *cspln  = NULL;
     double      *xyz    = NULL;
 
-    int         ncel, ivrt, ivar, iknt, icel, ii, jj;
+    int         ncel, ivrt, ivar, iknt, icel, ii, jj, nuv;
     double      err, uu, vv, umin, umax, vmin, vmax, ss, tt;
 
     int         nvar2 = 2 * nvar;
@@ -1487,6 +1549,7 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
     tree->cell = NULL;
     tree->nknt = 4;
     tree->knot = NULL;
+    tree->lcel = NULL;
 
     /*
      * allocate and initialize the Cell and Knot arrays
@@ -1558,6 +1621,9 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
         }
     }
 
+    status = latticeCells(tree);
+    CHECK_STATUS;
+
     /*
      * count number of Vertices in each Cell
      */
@@ -1569,34 +1635,25 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
     /*
      * allocate storage for (extended) Vertex table and spline data
      */
-    MALLOC(xvrt,  double,       nvrt);
-    MALLOC(xspln, double, tree->nknt);
-    MALLOC(uspln, double, tree->nknt);
-    MALLOC(vspln, double, tree->nknt);
-    MALLOC(cspln, double, tree->nknt);
+    nuv = tree->nu * tree->nv;
+
+    MALLOC(xspln, double, nuv*nvar);
+    MALLOC(uspln, double, nuv*nvar);
+    MALLOC(vspln, double, nuv*nvar);
+    MALLOC(cspln, double, nuv*nvar);
 
 #ifdef DEBUG
     printTree(dbg_fp, tree);
 #endif
 
     /*
-     * create splines for each of the dependent variables
+     * create splines for all of the dependent variables
      */
-    for (ivar = 0; ivar < nvar; ivar++) {
-
-        /*
-         * copy the Vertex data into xvrt
-         */
-        for (ivrt = 0; ivrt < nvrt; ivrt++) {
-            xvrt[ivrt] = resid[nvar*ivrt+ivar];
-        }
+    status = splineWithGaps2d(nvrt, uv, nvar, resid, periodic, ppnts,
+                              tree->nu, tree->nv, xspln, uspln, vspln, cspln);
+    CHECK_STATUS;
 
-        /*
-         * find the spline
-         */
-        status = splineWithGaps2d(nvrt, uv, xvrt, periodic, ppnts,
-                                  tree->nu, tree->nv, xspln, uspln, vspln, cspln);
-        CHECK_STATUS;
+    for (ivar = 0; ivar < nvar; ivar++) {
 
         /*
          * store the spline data in the knots
@@ -1606,28 +1663,28 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
             jj = tree->nv * tree->cell[icel].vmin;
 
             iknt = tree->cell[icel].swKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj  )];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj  )+nuv*ivar];
 
             iknt = tree->cell[icel].seKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj  )];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj  )];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj  )+nuv*ivar];
 
             iknt = tree->cell[icel].nwKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj+1)];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii  )+tree->nu*(jj+1)+nuv*ivar];
 
             iknt = tree->cell[icel].neKnot;
-            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj+1)];
-            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj+1)];
+            tree->knot[nvar4*iknt      +ivar] = xspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar +ivar] = uspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar2+ivar] = vspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
+            tree->knot[nvar4*iknt+nvar3+ivar] = cspln[(ii+1)+tree->nu*(jj+1)+nuv*ivar];
         }
     }
 
@@ -1674,7 +1731,6 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
     FREE(vspln);
     FREE(uspln);
     FREE(xspln);
-    FREE(xvrt );
     FREE(xyz  );
 
     DPRINT4("%s --> rmserr=%f, maxerr=%f, status=%d}",
@@ -1684,6 +1740,77 @@ initialTree2d(gridTree *tree,                /* (both) Grid Tree to refine */
 
 
 
+/*
+ ********************************************************************************
+ *                                                                              *
+ * latticeCells -- index the finest Cells if they form a uniform lattice        *
+ *                                                                              *
+ ********************************************************************************
+ */
+static int
+latticeCells(gridTree *tree)                 /* (both) Grid Tree */
+{
+    int         status = GEM_SUCCESS;        /* (out)  return status */
+                                             /*        GEM_SUCCESS */
+
+    int         icel, ii, jj, nlu, nlv, nfill;
+    double      xmin, xmax, ymin, ymax;
+
+    ROUTINE(latticeCells);
+    DPRINT3("%s(nu=%d, nv=%d) {",
+            routine, tree->nu, tree->nv);
+
+    /* ----------------------------------------------------------------------- */
+
+    FREE(tree->lcel);
+
+    nlu = tree->nu - 1;
+    nlv = tree->nv - 1;
+    if (nlu < 1 || nlv < 1) goto cleanup;
+
+    MALLOC(tree->lcel, int, nlu*nlv);
+
+    for (ii = 0; ii < nlu*nlv; ii++) {
+        tree->lcel[ii] = -1;
+    }
+
+    /*
+     * every undivided Cell must fill exactly one slot (the Cell limits
+     *    are dyadic, so the products below are exact when it does)
+     */
+    nfill = 0;
+    for (icel = 0; icel < tree->ncel; icel++) {
+        if (tree->cell[icel].dtype != 0) continue;
+
+        xmin = tree->cell[icel].umin * nlu;
+        xmax = tree->cell[icel].umax * nlu;
+        ymin = tree->cell[icel].vmin * nlv;
+        ymax = tree->cell[icel].vmax * nlv;
+        ii   = (int) xmin;
+        jj   = (int) ymin;
+
+        if (ii < 0 || ii >= nlu || xmin != ii || xmax != ii+1 ||
+            jj < 0 || jj >= nlv || ymin != jj || ymax != jj+1 ||
+            tree->lcel[ii+nlu*jj] >= 0                         ) {
+            FREE(tree->lcel);
+            goto cleanup;
+        }
+
+        tree->lcel[ii+nlu*jj] = icel;
+        nfill++;
+    }
+
+    if (nfill != nlu*nlv) {
+        FREE(tree->lcel);
+    }
+
+ cleanup:
+    DPRINT2("%s --> status=%d}", routine, status);
+    return status;
+}
+
+
+
 #ifdef GRAFIC
 /*
  ********************************************************************************
@@ -2605,6 +2732,54 @@ printTree(FILE     *fp,                      /* (in)   file pointer */
 
 
 
+/*
+ ********************************************************************************
+ *                                                                              *
+ * refineTrials -- copy and globally refine the Trees for a range of trials     *
+ *                                                                              *
+ ********************************************************************************
+ */
+static int
+refineTrials(void     *data,                 /* (both) array  of gridTrials */
+             int      beg,                   /* (in)   first trial */
+             int      end)                   /* (in)   last  trial + 1 */
+{
+    int         status = GEM_SUCCESS;        /* (out)  return status */
+
+    gridTrial   *trial = (gridTrial *) data;
+    int         itry;
+
+    ROUTINE(refineTrials);
+    DPRINT3("%s(beg=%d, end=%d) {",
+            routine, beg, end);
+
+    /* ----------------------------------------------------------------------- */
+
+    for (itry = beg; itry < end; itry++) {
+        trial[itry].rmserr = HUGEQ;
+        trial[itry].maxerr = HUGEQ;
+        if (trial[itry].dtype == 0) continue;
+
+        status = copyGrid(trial[itry].tree, trial[itry].base);
+        CHECK_STATUS;
+
+        MEMCPY(trial[itry].resid, trial[itry].resid0, trial[itry].nsize);
+
+        status = globalRefine2d(trial[itry].dtype, trial[itry].tree,
+                                trial[itry].nvrt, trial[itry].periodic,
+                                trial[itry].ppnts, trial[itry].uv,
+                                trial[itry].resid, &(trial[itry].rmserr),
+                                                   &(trial[itry].maxerr));
+        CHECK_STATUS;
+    }
+
+ cleanup:
+    DPRINT2("%s --> status=%d}", routine, status);
+    return status;
+}
+
+
+
 /*
  ********************************************************************************
  *                                                                              *
@@ -2615,15 +2790,17 @@ printTree(FILE     *fp,                      /* (in)   file pointer */
 static int
 splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit */
                  prmUV    uv[],              /* (in)   UV for Vertices to fit */
-                 double   xvrt[],            /* (in)   X (data) to fit */
+                 int      nvar,              /* (in)   number of dependent variables */
+                 double   xvrt[],            /* (in)   X (data) to fit (nvar per Vertex) */
                  int      periodic,          /* (in)   periodicity flag */
       /*@null@*/ int      ppnts[],           /* (in)   indices of periodic points */
                  int      nu,                /* (in)   number of U grid Knots */
                  int      nv,                /* (in)   number of V grid Knots */
-                 double   x[],               /* (both) array of spline Knots */
+                 double   x[],               /* (out)  array of spline Knots */
                  double   du[],              /* (out)  array of u-derivs */
                  double   dv[],              /* (out)  array of v-derivs */
                  double   dc[])              /* (out)  array of cross derivs */
+                                             /*        (nu*nv per variable) */
 {
     int         status = GEM_SUCCESS;        /* (out)  return status */
                                              /*        GEM_SUCCESS*/
@@ -2631,7 +2808,7 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
 
     double      *asmf = NULL;                /* sparse-matrix data */
     int         *ismf = NULL;                /* sparse-matrix indices */
-    double      *rhs  = NULL;                /* right-hand sides */
+    double      *rhs  = NULL;                /* right-hand sides (4*nuv per variable) */
     double      *xx   = NULL;                /* matrix solution: x, du, dv, dc */
     int         *nn   = NULL;                /* number of Vertices near each Knot */
 
@@ -2645,22 +2822,23 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
 
     int         i, j, ij, ii, jj, kk, ivrt, nuv, is, iw;
     int         isw, ise, inw, ine, jsw, jse, jnw, jne;
-    int         nsmf, irow, icol, iuv, ileft, imidl, irite;
+    int         nsmf, irow, icol, iuv, ileft, imidl, irite, ivar, n4;
 
     double      amu    = 0.001;              /* smoothing coefficient */
     double      xtol   = 1.e-6;              /* tolerance on x for constant value */
 
     ROUTINE(splineWithGaps2d);
-    DPRINT5("%s(nvrt=%d, periodic=%d, nu=%d, nv=%d) {",
-            routine, nvrt, periodic, nu, nv);
+    DPRINT6("%s(nvrt=%d, nvar=%d, periodic=%d, nu=%d, nv=%d) {",
+            routine, nvrt, nvar, periodic, nu, nv);
 
     /* ----------------------------------------------------------------------- */
 
 #ifdef GRAFIC2
-    plotVrts(nvrt, 1, uv, xvrt);
+    plotVrts(nvrt, nvar, uv, xvrt);
 #endif
 
     nuv = nu * nv;
+    n4  = 4 * nuv;
 
     /*
      * find the count of Vertices adjacent to each Knot
@@ -2709,8 +2887,8 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
 
     MALLOC(asmf, double, 51*nuv);
     MALLOC(ismf, int,    51*nuv);
-    MALLOC(rhs,  double,  4*nuv);
-    MALLOC(xx,   double,  4*nuv);
+    MALLOC(rhs,  double,  4*nuv*nvar);
+    MALLOC(xx,   double,  4*nuv*nvar);
 
     /*
      * start out with all zeros
@@ -2720,7 +2898,7 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
         ismf[i] = 0;
     }
 
-    for (i = 0; i < 4*nuv; i++) {
+    for (i = 0; i < 4*nuv*nvar; i++) {
         rhs[i] = 0;
         xx[ i] = 0;
     }
@@ -3117,18 +3295,22 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
         /*
          * right-hand sides
          */
-        rhs[isw] += b00 * xvrt[ivrt];
-        rhs[ise] += b01 * xvrt[ivrt];
-        rhs[inw] += b02 * xvrt[ivrt];
-        rhs[ine] += b03 * xvrt[ivrt];
+        for (ivar = 0; ivar < nvar; ivar++) {
+            rhs[isw+n4*ivar] += b00 * xvrt[nvar*ivrt+ivar];
+            rhs[ise+n4*ivar] += b01 * xvrt[nvar*ivrt+ivar];
+            rhs[inw+n4*ivar] += b02 * xvrt[nvar*ivrt+ivar];
+            rhs[ine+n4*ivar] += b03 * xvrt[nvar*ivrt+ivar];
+        }
 
         /*
          * initial guesses
          */
-        xx[isw] = xvrt[ivrt];
-        xx[ise] = xvrt[ivrt];
-        xx[inw] = xvrt[ivrt];
-        xx[ine] = xvrt[ivrt];
+        for (ivar = 0; ivar < nvar; ivar++) {
+            xx[isw+n4*ivar] = xvrt[nvar*ivrt+ivar];
+            xx[ise+n4*ivar] = xvrt[nvar*ivrt+ivar];
+            xx[inw+n4*ivar] = xvrt[nvar*ivrt+ivar];
+            xx[ine+n4*ivar] = xvrt[nvar*ivrt+ivar];
+        }
     }
 
     /*
@@ -3187,14 +3369,17 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
 
             vleft = uv[  ppnts[ileft]].v;
             vrite = uv[  ppnts[irite]].v;
-            xleft = xvrt[ppnts[ileft]];
-            xrite = xvrt[ppnts[irite]];
-            xxx   = xleft + (vvv - vleft) * (xrite - xleft) / (vrite - vleft);
 
             for (i = 0; i < nu; i += nu-1) {
                 irow = (i) + nu * (j);
                 asmf[irow] = 1;
-                rhs[ irow] = xxx;
+
+                for (ivar = 0; ivar < nvar; ivar++) {
+                    xleft = xvrt[nvar*ppnts[ileft]+ivar];
+                    xrite = xvrt[nvar*ppnts[irite]+ivar];
+                    xxx   = xleft + (vvv - vleft) * (xrite - xleft) / (vrite - vleft);
+                    rhs[irow+n4*ivar] = xxx;
+                }
 
                 for (jj = ismf[irow]; jj < ismf[irow+1]; jj++) {
                     asmf[jj] = 0;
@@ -3267,14 +3452,17 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
 
             uleft = uv[  ppnts[ileft]].u;
             urite = uv[  ppnts[irite]].u;
-            xleft = xvrt[ppnts[ileft]];
-            xrite = xvrt[ppnts[irite]];
-            xxx   = xleft + (uuu - uleft) * (xrite - xleft) / (urite - uleft);
 
             for (j = 0; j < nv; j += nv-1) {
                 irow = (i) + nu * (j);
                 asmf[irow] = 1;
-                rhs[ irow] = xxx;
+
+                for (ivar = 0; ivar < nvar; ivar++) {
+                    xleft = xvrt[nvar*ppnts[ileft]+ivar];
+                    xrite = xvrt[nvar*ppnts[irite]+ivar];
+                    xxx   = xleft + (uuu - uleft) * (xrite - xleft) / (urite - uleft);
+                    rhs[irow+n4*ivar] = xxx;
+                }
 
                 for (jj = ismf[irow]; jj < ismf[irow+1]; jj++) {
                     asmf[jj] = 0;
@@ -3328,7 +3516,7 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
     /*
      * perturb initial guess so that we do not have a lot of zeroes
      */
-    for (i = 0; i < 4*nuv; i++) {
+    for (i = 0; i < 4*nuv*nvar; i++) {
         if (fabs(xx[i]) < xtol) {
             xx[i] = xtol;
         }
@@ -3342,7 +3530,10 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
             DPRINT1("pinning %d", i);
 
             asmf[i] = 1;
-            rhs[ i] = 0;
+
+            for (ivar = 0; ivar < nvar; ivar++) {
+                rhs[i+n4*ivar] = 0;
+            }
 
             for (jj = ismf[i]; jj < ismf[i+1]; jj++) {
                 asmf[jj] = 0;
@@ -3351,20 +3542,23 @@ splineWithGaps2d(int      nvrt,              /* (in)   number of Vertices to fit
     }
 
     /*
-     * solve for the new x-locations
+     * solve for the new x-locations (the matrix does not depend on
+     *    the data, so all the variables share one factorization)
      */
-    status = sparseBCG(asmf, ismf, xx, rhs);
-    DPRINT1("sparseBCG -> status=%d", status);
+    status = sparseILU(asmf, ismf, nvar, xx, rhs);
+    DPRINT1("sparseILU -> status=%d", status);
     CHECK_STATUS;
 
     /*
      * extract the new x values from the matrix solution
      */
-    for (i = 0; i < nuv; i++) {
-        x[ i] = xx[i      ];
-        du[i] = xx[i+  nuv];
-        dv[i] = xx[i+2*nuv];
-        dc[i] = xx[i+3*nuv];
+    for (ivar = 0; ivar < nvar; ivar++) {
+        for (i = 0; i < nuv; i++) {
+            x[ i+nuv*ivar] = xx[i      +n4*ivar];
+            du[i+nuv*ivar] = xx[i+  nuv+n4*ivar];
+            dv[i+nuv*ivar] = xx[i+2*nuv+n4*ivar];
+            dc[i+nuv*ivar] = xx[i+3*nuv+n4*ivar];
+        }
     }
 
 #ifdef DEBUG
@@ -3632,6 +3826,7 @@ prm_BestGrid(int      nvrt,                  /* (in)   number of Vertices */
                                              /*        = 1  periodic in U */
                                              /*        = 2  periodic in V */
   /*@null@*/ int      ppnts[],               /* (in)   indices of periodic points */
+             int      nthread,               /* (in)   threads for the U & V trials */
              int      *nu,                   /* (in)   limit on nu if > 0 */
                                              /* (out)  number of Knots in U-dirn */
              int      *nv,                   /* (in)   limit on nv if > 0 */
@@ -3655,8 +3850,11 @@ prm_BestGrid(int      nvrt,                  /* (in)   number of Vertices */
     gridTree    tree0;
     gridTree    tree1;
     gridTree    tree2;
+    gridTree    treet;
+    double      *residt;
+    gridTrial   trial[2];
 
-    int         iu, iv, iuv, numax, nvmax, nuvmax, ivrt, ivar, nsize, i;
+    int         iu, iv, iuv, numax, nvmax, nuvmax, ivrt, ivar, nsize, i, nthrd;
     int         ivrt_max, ivar_max;
     double      rmserr1, rmserr2, maxerr1, maxerr2, resid_max;
     double      xyz[100], dxyzdu[100], dxyzdv[100];
@@ -3745,12 +3943,15 @@ prm_BestGrid(int      nvrt,                  /* (in)   number of Vertices */
      */
     tree0.cell = NULL;
     tree0.knot = NULL;
+    tree0.lcel = NULL;
 
     tree1.cell = NULL;
     tree1.knot = NULL;
+    tree1.lcel = NULL;
 
     tree2.cell = NULL;
     tree2.knot = NULL;
+    tree2.lcel = NULL;
 
     /*
      * the initial residual is just the original data
@@ -3762,6 +3963,8 @@ prm_BestGrid(int      nvrt,                  /* (in)   number of Vertices */
 
     MEMCPY(resid0, var,    nsize);
 
+    nthrd = MIN(2, nthread);
+
     /*
      * initialize the Tree and set up the first (global) Cell(s)
      */
@@ -3780,43 +3983,44 @@ prm_BestGrid(int      nvrt,                  /* (in)   number of Vertices */
     while (*maxerr > tol && (tree0.nu)*(tree0.nv) < nuvmax) {
 
         /*
-         * try refinement type 1
+         * try refinement types 1 and 2 (independently, so at the same time)
          */
-        if (tree0.nu < numax) {
-            copyGrid(&tree1, &tree0);
-            MEMCPY(resid1, resid0, nsize);
+        trial[0].dtype = (tree0.nu < numax) ? 1 : 0;
+        trial[0].tree  = &tree1;
+        trial[0].resid = resid1;
+        trial[1].dtype = (tree0.nv < nvmax) ? 2 : 0;
+        trial[1].tree  = &tree2;
+        trial[1].resid = resid2;
+
+        for (i = 0; i < 2; i++) {
+            trial[i].base     = &tree0;
+            trial[i].resid0   = resid0;
+            trial[i].nsize    = nsize;
+            trial[i].nvrt     = nvrt;
+            trial[i].periodic = periodic;
+            trial[i].ppnts    = ppnts;
+            trial[i].uv       = uv;
+        }
 
-            status = globalRefine2d(1, &tree1, nvrt, periodic, ppnts,
-                                    uv, resid1, &rmserr1, &maxerr1);
-            CHECK_STATUS;
+        status = gem_threadTasks(nthrd, 2, refineTrials, trial);
+        CHECK_STATUS;
+
+        rmserr1 = trial[0].rmserr;
+        maxerr1 = trial[0].maxerr;
+        rmserr2 = trial[1].rmserr;
+        maxerr2 = trial[1].maxerr;
 
+        if (trial[0].dtype != 0) {
             PPRINT4("   (%4d,%4d)  rmserr=%12.6f  maxerr=%12.6f",
                     tree1.nu, tree1.nv, rmserr1, maxerr1);
             DPRINT4("   (%4d,%4d)  rmserr=%12.6f  maxerr=%12.6f",
                     tree1.nu, tree1.nv, rmserr1, maxerr1);
-        } else {
-            rmserr1 = HUGEQ;
-            maxerr1 = HUGEQ;
         }
-
-        /*
-         * try refinement type 2
-         */
-        if (tree0.nv < nvmax) {
-            copyGrid(&tree2, &tree0);
-            MEMCPY(resid2, resid0, nsize);
-
-            status = globalRefine2d(2, &tree2, nvrt, periodic, ppnts,
-                                    uv, resid2, &rmserr2, &maxerr2);
-            CHECK_STATUS;
-
+        if (trial[1].dtype != 0) {
             PPRINT4("   (%4d,%4d)  rmserr=%12.6f  maxerr=%12.6f",
                     tree2.nu, tree2.nv, rmserr2, maxerr2);
             DPRINT4("   (%4d,%4d)  rmserr=%12.6f  maxerr=%12.6f",
                     tree2.nu, tree2.nv, rmserr2, maxerr2);
-        } else {
-            rmserr2 = HUGEQ;
-            maxerr2 = HUGEQ;
         }
 
         /*
@@ -3834,20 +4038,30 @@ prm_BestGrid(int      nvrt,                  /* (in)   number of Vertices */
             break;
 
         /*
-         * keep the better of refinement 1 or 2
+         * keep the better of refinement 1 or 2 (swapped rather than
+         *    copied, since the trials are copied afresh from tree0)
          */
         } else if (rmserr1 < rmserr2) {
-            copyGrid(&tree0, &tree1);
-            MEMCPY(resid0, resid1, nsize);
+            treet   = tree0;
+            tree0   = tree1;
+            tree1   = treet;
+            residt  = resid0;
+            resid0  = resid1;
+            resid1  = residt;
             *rmserr = rmserr1;
             *maxerr = maxerr1;
 
         } else {
-            copyGrid(&tree0, &tree2);
-            MEMCPY(resid0, resid2, nsize);
+            treet   = tree0;
+            tree0   = tree2;
+            tree2   = treet;
+            residt  = resid0;
+            resid0  = resid2;
+            resid2  = residt;
             *rmserr = rmserr2;
             *maxerr = maxerr2;
         }
+        GEM_PROFCOUNT(GEM_CGRIDLEVEL, 1);
 
         /*
          * print the maximum residual
@@ -4153,6 +4367,7 @@ prm_FreeGrid(gridTree *tree)                 /* (in)   pointer to Grid Tree */
      */
     FREE(tree->cell);
     FREE(tree->knot);
+    FREE(tree->lcel);
 
     /*
      * reset Tree's information
@@ -16,6 +16,7 @@
 #include "gem.h"
 #include "memory.h"
 #include "prm.h"
+#include "profile.h"
 #include "fillArea.h"
 
 #ifdef GRAFIC
@@ -53,6 +54,10 @@ static void   plotTrisImage           (int*, void*, void*, void*, void*, void*,
  */
 extern int    printSMF                (FILE*, double[], int[], double[], double[]);
 extern int    sparseBCG               (double[], int[], double[], double[]);
+extern int    sparseILU               (double[], int[], int, double[], double[]);
+extern int    gem_solveILU            (int, int, int[], int[], double[],
+                                       double[], double[], double, int,
+                                       /*@null@*/ int *, /*@null@*/ double[]);
 
 /*
  * global constants
@@ -220,6 +225,14 @@ static FILE     *dbg_fp = NULL;         /* file pointer for debug information */
         } else {\
             PTR = (TYPE *)realloc_temp;\
         }
+#define SALLOC(PTR,TYPE,SIZE) \
+        DPRINT3("scratch for %s in routine %s (size=%d)", #PTR, routine, SIZE);\
+        PTR = (TYPE *) gem_arenaAlloc(&scratch, (SIZE) * sizeof(TYPE)); \
+        if (PTR == NULL) {\
+            GI_OUT2("ERROR:: SALLOC PROBLEM for %s in routine %s", #PTR, routine);\
+            status = GEM_ALLOC;\
+            goto cleanup;\
+        }
 #define FREE(PTR) \
         DPRINT2("freeing %s in routine %s", #PTR, routine);\
         gem_free(PTR);\
@@ -1199,9 +1212,19 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
     vrt_t       *vrts = NULL;                /* array of boundary Vertices */
 
 
-    double      *amat   = NULL;
+    int         *arow   = NULL;
+    int         *acol   = NULL;
+    double      *aval   = NULL;
+    int         *rowp   = NULL;
+    int         *rcol   = NULL;
+    double      *rval   = NULL;
     double      *asmf   = NULL;
     int         *ismf   = NULL;
+    int         *crow   = NULL;
+    int         *ccol   = NULL;
+    double      *cval   = NULL;
+    double      *bsol   = NULL;
+    double      *brhs   = NULL;
     double      *urhs   = NULL;
     double      *vrhs   = NULL;
     prmTri      *newTri = NULL;
@@ -1215,7 +1238,7 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
     double      d30sq, d04sq, d41sq, d15sq, d52sq;
     double      du, dv;
     double      dist;
-    double      err=1, erru, errv;
+    double      err=1, erru, errv, bnrm, resid[2];
     int         found;
     int         i, j, k, ii, ij, nn, im1, ip1;
     int         imin;
@@ -1230,6 +1253,7 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
     double      xold, yold, zold, told, gold, hold;
     double      xnew, ynew, znew, tnew, unew, vnew;
     int         nhole;
+    gemArena    scratch;                     /* the fixed-size work arrays */
 
     double      errtol = 0.000001;
     double      frac = 0.25;
@@ -1239,16 +1263,18 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
     DPRINT3("%s(ntri=%d, nvrt=%d) {",
             routine, ntri, nvrt);
 
+    gem_arenaInit(&scratch);
+
     /* ----------------------------------------------------------------------- */
 
     /*
      * allocate storage that will be used to keep track of the Loop
      *    number and the next Vertex in the Loop
      */
-    MALLOC(vrts, vrt_t,  nvrt    );
-    MALLOC(lups, lup_t,  MAXLOOPS);
-    MALLOC(urhs, double, nvrt    );
-    MALLOC(vrhs, double, nvrt    );
+    SALLOC(vrts, vrt_t,  nvrt    );
+    SALLOC(lups, lup_t,  MAXLOOPS);
+    SALLOC(urhs, double, nvrt    );
+    SALLOC(vrhs, double, nvrt    );
 
     /*
      * for each Vertex that is along a boundary of the Quilt, keep track of
@@ -1689,14 +1715,14 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
     }
 
     /*
-     * initialize the amat matrix (which will be used to solve for the UV
-     *    at all interior Vertices)
+     * the weights are gathered as (row, column, value) entries -- each
+     *    Triangle gives at most one entry to each of its Vertices' rows
+     *    (which will be used to solve for the UV at all interior Vertices)
      */
-    MALLOC(amat, double, SQR(nvrt));
-
-    for (ij = 0; ij < nvrt*nvrt; ij++) {
-        amat[ij] = 0;
-    }
+    SALLOC(arow, int,    3*ntri);
+    SALLOC(acol, int,    3*ntri);
+    SALLOC(aval, double, 3*ntri);
+    nn = 0;
 
     /*
      * find the mean value weights at each Vertex due to its neighbors.  the
@@ -1756,7 +1782,10 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
 
             ang3 = ACOS((d30sq + d20sq - d23sq) / 2 / sqrt(d30sq * d20sq));
 
-            amat[iv0+iv2*nvrt] = (tan(ang0/2) + tan(ang3/2)) / sqrt(d20sq);
+            arow[nn] = iv0;
+            acol[nn] = iv2;
+            aval[nn] = (tan(ang0/2) + tan(ang3/2)) / sqrt(d20sq);
+            nn++;
         }
 
         if (newTri[itri].neigh[2] > 0) {
@@ -1778,7 +1807,10 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
 
             ang4 = ACOS((d41sq + d01sq - d04sq) / 2 / sqrt(d41sq * d01sq));
 
-            amat[iv1+iv0*nvrt] = (tan(ang1/2) + tan(ang4/2)) / sqrt(d01sq);
+            arow[nn] = iv1;
+            acol[nn] = iv0;
+            aval[nn] = (tan(ang1/2) + tan(ang4/2)) / sqrt(d01sq);
+            nn++;
         }
 
         if (newTri[itri].neigh[0] > 0) {
@@ -1800,30 +1832,88 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
 
             ang5 = ACOS((d52sq + d12sq - d15sq) / 2 / sqrt(d52sq * d12sq));
 
-            amat[iv2+iv1*nvrt] = (tan(ang2/2) + tan(ang5/2)) / sqrt(d12sq);
+            arow[nn] = iv2;
+            acol[nn] = iv1;
+            aval[nn] = (tan(ang2/2) + tan(ang5/2)) / sqrt(d12sq);
+            nn++;
+        }
+    }
+
+    /*
+     * bucket the entries by row (keeping the Triangle order) and then sort
+     *    each row by column.  a repeated entry keeps the last value (as the
+     *    dense assembly overwrote)
+     */
+    DPRINT0("setting up sparse matrix");
+    SALLOC(rowp, int,    nvrt+1);
+    SALLOC(rcol, int,    nn    );
+    SALLOC(rval, double, nn    );
+
+    for (i = 0; i <= nvrt; i++) {
+        rowp[i] = 0;
+    }
+    for (k = 0; k < nn; k++) {
+        rowp[arow[k]+1]++;
+    }
+    for (i = 0; i < nvrt; i++) {
+        rowp[i+1] += rowp[i];
+    }
+    for (k = 0; k < nn; k++) {
+        ij       = rowp[arow[k]]++;
+        rcol[ij] = acol[k];
+        rval[ij] = aval[k];
+    }
+    for (i = nvrt; i > 0; i--) {
+        rowp[i] = rowp[i-1];
+    }
+    rowp[0] = 0;
+
+    for (i = 0; i < nvrt; i++) {
+        for (k = rowp[i]+1; k < rowp[i+1]; k++) {
+            j   = rcol[k];
+            sum = rval[k];
+            for (ij = k; ij > rowp[i] && rcol[ij-1] > j; ij--) {
+                rcol[ij] = rcol[ij-1];
+                rval[ij] = rval[ij-1];
+            }
+            rcol[ij] = j;
+            rval[ij] = sum;
         }
     }
 
     /*
-     * set up the final amat and the right-hand sides
+     * set up the final matrix (in sparse-matrix form as described in
+     *    'Numerical Recipes') and the right-hand sides.  the diagonal is
+     *    always 1 and there are at most nn off-diagonal entries
      */
+    SALLOC(asmf, double, nvrt+2+nn);
+    SALLOC(ismf, int,    nvrt+2+nn);
+
+    ismf[0] = nvrt + 2;
+    k = nvrt + 1;
     for (i = 0; i < nvrt; i++) {
+        asmf[i] = 1;
 
         /*
-         * for interior Vertices, normalize the weights, set the diagonal to 1,
-         *    and zero-out the right-hand sides
+         * for interior Vertices, normalize the weights and zero-out the
+         *    right-hand sides
          */
         if (vrts[i].lup != outer) {
             sum = 0;
-            for (j = 0; j < nvrt; j++) {
-                sum -= amat[i+j*nvrt];
+            for (ij = rowp[i]; ij < rowp[i+1]; ij++) {
+                if (ij+1 < rowp[i+1] && rcol[ij+1] == rcol[ij]) continue;
+                sum -= rval[ij];
             }
-            for (j = 0; j < nvrt; j++) {
-                amat[i+j*nvrt] /= sum;
+            for (ij = rowp[i]; ij < rowp[i+1]; ij++) {
+                if (ij+1 < rowp[i+1] && rcol[ij+1] == rcol[ij]) continue;
+                if (rcol[ij] == i) continue;
+                if (fabs(rval[ij] / sum) > EPS20) {
+                    k++;
+                    asmf[k] = rval[ij] / sum;
+                    ismf[k] = rcol[ij];
+                }
             }
 
-            amat[i+i*nvrt] = 1;
-
             urhs[i] = 0;
             vrhs[i] = 0;
 
@@ -1831,87 +1921,82 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
             uv[i].v = 0;
 
         /*
-         * for boundary Vertices, zero-out all amat elements, set the diagonal
-         *    to 1, and store the boundary values in the RHS
+         * for boundary Vertices, there are no off-diagonal elements and the
+         *    boundary values go in the RHS
          */
         } else {
-            for (j = 0; j < nvrt; j++) {
-                amat[i+j*nvrt] = 0;
-            }
-
-            amat[i+i*nvrt] = 1;
-
             urhs[i] = uv[i].u;
             vrhs[i] = uv[i].v;
         }
+
+        ismf[i+1] = k + 1;
     }
 
     /*
-     * count the number of non-zero entries in amat
+     * copy into compressed rows (with the diagonal in column order) for
+     *    the Krylov solver
      */
-    nn = 0;
+    SALLOC(crow, int,    nvrt+1          );
+    SALLOC(ccol, int,    ismf[nvrt]-2    );
+    SALLOC(cval, double, ismf[nvrt]-2    );
+    SALLOC(bsol, double, 2*nvrt          );
+    SALLOC(brhs, double, 2*nvrt          );
+
+    nn   = 0;
+    bnrm = 0;
     for (i = 0; i < nvrt; i++) {
-        for (j = 0; j < nvrt; j++) {
-            if (fabs(amat[i+j*nvrt]) < EPS20) {
+        crow[i] = nn;
+        for (k = ismf[i]; k <= ismf[i+1]; k++) {
+            if (k < ismf[i+1] && ismf[k] < i) {
+                ccol[nn] = ismf[k];
+                cval[nn] = asmf[k];
                 nn++;
+            } else {
+                ccol[nn] = i;
+                cval[nn] = asmf[i];
+                nn++;
+                break;
             }
         }
-    }
+        for (; k < ismf[i+1]; k++) {
+            ccol[nn] = ismf[k];
+            cval[nn] = asmf[k];
+            nn++;
+        }
 
-    /*
-     * allocate matrices for sparse-matrix form.  this form is as
-     *    described in 'Numerical Recipes'
-     */
-    DPRINT0("setting up sparse matrix");
-    MALLOC(asmf, double, nn);
-    MALLOC(ismf, int,    nn);
+        brhs[2*i  ] = urhs[i];
+        brhs[2*i+1] = vrhs[i];
+        bsol[2*i  ] = uv[i].u;
+        bsol[2*i+1] = uv[i].v;
+        bnrm       += SQR(urhs[i]) + SQR(vrhs[i]);
+    }
+    crow[nvrt] = nn;
 
     /*
-     * store the matrix in sparse-matrix form (which will make
-     *    the iterations below much more efficient)
+     * solve for the Us and Vs together with ILU(0) preconditioned BiCGStab
+     *    (the tolerance is scaled to land inside errtol below)
      */
-    for (j = 0; j < nvrt; j++) {
-        asmf[j] = amat[j+j*nvrt];
-    }
-
-    ismf[0] = nvrt + 2;
-
-    k = nvrt + 1;
-    for (i = 0; i < nvrt; i++) {
-        for (j = 0; j < nvrt; j++) {
-            if (i!=j && fabs(amat[i+j*nvrt]) > EPS20) {
-                k++;
-                asmf[k] = amat[i+j*nvrt];
-                ismf[k] = j;
-            }
+    DPRINT0("solving sparse matrix");
+    bnrm = sqrt(bnrm);
+    if (bnrm < errtol) bnrm = errtol;
+    status = gem_solveILU(nvrt, 2, crow, ccol, cval, brhs, bsol,
+                          0.1*errtol/bnrm, itmax, &iter, resid);
+    DPRINT4("gem_solveILU -> status=%d, iter=%d, resid=%15.8e %15.8e",
+            status, iter, resid[0], resid[1]);
+    if (status == GEM_ALLOC) goto cleanup;
+    if (status == GEM_SUCCESS) {
+        for (i = 0; i < nvrt; i++) {
+            uv[i].u = bsol[2*i  ];
+            uv[i].v = bsol[2*i+1];
         }
-
-        ismf[i+1] = k + 1;
     }
 
     /*
-     * solve for the Gs and Hs using successive-over-relaxation
+     * check the residual and fall back to successive-over-relaxation if
+     *    the Krylov solve did not get there
      */
-    DPRINT0("solving sparse matrix");
     for (iter = 0; iter < itmax; iter++) {
 
-        /*
-         * apply successive-over-relaxation
-         */
-        for (i = 0; i < nvrt; i++) {
-            du = urhs[i] - asmf[i] * uv[i].u;
-            dv = vrhs[i] - asmf[i] * uv[i].v;
-
-            for (k = ismf[i]; k < ismf[i+1]; k++) {
-                j    = ismf[k];
-                du  -= asmf[k] * uv[j].u;
-                dv  -= asmf[k] * uv[j].v;
-            }
-
-            uv[i].u += omega * du / asmf[i];
-            uv[i].v += omega * dv / asmf[i];
-        }
-
         /*
          * compute the norm of the residual
          */
@@ -1935,6 +2020,23 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
          */
         DPRINT2("iter=%5d   err=%15.8e", iter, err);
         if (err < errtol) break;
+
+        /*
+         * apply successive-over-relaxation
+         */
+        for (i = 0; i < nvrt; i++) {
+            du = urhs[i] - asmf[i] * uv[i].u;
+            dv = vrhs[i] - asmf[i] * uv[i].v;
+
+            for (k = ismf[i]; k < ismf[i+1]; k++) {
+                j    = ismf[k];
+                du  -= asmf[k] * uv[j].u;
+                dv  -= asmf[k] * uv[j].v;
+            }
+
+            uv[i].u += omega * du / asmf[i];
+            uv[i].v += omega * dv / asmf[i];
+        }
     }
 
     /*
@@ -1965,13 +2067,7 @@ floaterParameterization(int        ntri,     /* (in)   number of Triangles */
     }
 
  cleanup:
-    FREE(vrts);
-    FREE(lups);
-    FREE(urhs);
-    FREE(vrhs);
-    FREE(amat);
-    FREE(asmf);
-    FREE(ismf);
+    gem_arenaFree(&scratch);
     FREE(newTri);
     FREE(ihole);
     FREE(ahole);
@@ -3640,6 +3736,7 @@ sparseBCG(double   asmf[],                   /* (in)   sparse-matrix data */
 
         if (fabs(bkden) < EPS20) {
             DPRINT2("restarting because bknum = %f (ipass=%d)", bknum, ipass);
+            GEM_PROFCOUNT(GEM_CBCGITER, iter);
             goto new_pass;
         }
 
@@ -3659,6 +3756,7 @@ sparseBCG(double   asmf[],                   /* (in)   sparse-matrix data */
 
         if (fabs(akden) < EPS20) {
             DPRINT2("restarting because akden = %f (ipass=%d)", akden, ipass);
+            GEM_PROFCOUNT(GEM_CBCGITER, iter);
             goto new_pass;
         }
 
@@ -3694,11 +3792,13 @@ sparseBCG(double   asmf[],                   /* (in)   sparse-matrix data */
         err = sqrt(err);
 
         if (err < tol) {
+            GEM_PROFCOUNT(GEM_CBCGITER, iter+1);
             goto cleanup;
         }
     }
 
     DPRINT1("exceeded maxiter=%d", maxiter);
+    GEM_PROFCOUNT(GEM_CBCGITER, maxiter);
     status = PRM_NOTCONVERGED;
 
  cleanup:
@@ -3732,6 +3832,161 @@ sparseBCG(double   asmf[],                   /* (in)   sparse-matrix data */
 }
 
 
+
+/*
+ ********************************************************************************
+ *                                                                              *
+ * sparseILU -- solve sparse matrix for several right-hand sides at once        *
+ *                                                                              *
+ ********************************************************************************
+ */
+extern int
+sparseILU(double   asmf[],                   /* (in)   sparse-matrix data */
+          int      ismf[],                   /* (in)   sparse-matrix indices */
+          int      nrhs,                     /* (in)   number of right-hand sides */
+          double   x[],                      /* (in)   initial  guesses (nrhs*n) */
+                                             /* (out)  solutions to A * x = rhs */
+          double   rhs[])                    /* (in)   right-hand sides (nrhs*n) */
+                                             /*        x[i+n*k] for rhs k */
+{
+    int         status = GEM_SUCCESS;        /* (out)  return status */
+                                             /*        GEM_SUCCESS */
+                                             /*        PRM_NOTCONVERGED */
+                                             /*        PRM_ZEROPIVOT */
+
+    int         *rowp = NULL;                /* CSR row pointers */
+    int         *cols = NULL;                /* CSR column indices */
+    double      *vals = NULL;                /* CSR values */
+    double      *xi   = NULL;                /* interleaved solutions */
+    double      *bi   = NULL;                /* interleaved right-hand sides */
+
+    double      bmax, bnrm, rmin, rmax, resid[4];
+    int         i, j, k, m, n, nnz, iter;
+
+    double      tol     = 1e-8;              /* convergence tolerance */
+    int         maxiter = 10000;             /* maximum number iterations */
+
+    ROUTINE(sparseILU);
+    DPRINT3("%s(ismf[0]=%d, nrhs=%d) {",
+            routine, ismf[0], nrhs);
+
+    /* ----------------------------------------------------------------------- */
+
+    n = ismf[0] - 1;
+
+    /*
+     * make sure that no diagonal elements are zero
+     */
+    for (i = 0; i < n; i++) {
+        if (fabs(asmf[i]) < EPS20) {
+            status = PRM_ZEROPIVOT;
+            goto cleanup;
+        }
+    }
+
+    /*
+     * convert to compressed rows with the columns sorted (and the
+     *    diagonal in place), dropping zeros and summing duplicates
+     */
+    MALLOC(rowp, int,    n+1             );
+    MALLOC(cols, int,    ismf[n]-1       );
+    MALLOC(vals, double, ismf[n]-1       );
+    MALLOC(xi,   double, nrhs*n          );
+    MALLOC(bi,   double, nrhs*n          );
+
+    nnz = 0;
+    for (i = 0; i < n; i++) {
+        rowp[i]    = nnz;
+        cols[nnz]  = i;
+        vals[nnz]  = asmf[i];
+        nnz++;
+
+        for (k = ismf[i]; k < ismf[i+1]; k++) {
+            if (asmf[k] == 0) continue;
+
+            for (j = nnz-1; j >= rowp[i] && cols[j] > ismf[k]; j--) {
+                cols[j+1] = cols[j];
+                vals[j+1] = vals[j];
+            }
+            if (j >= rowp[i] && cols[j] == ismf[k]) {
+                vals[j] += asmf[k];
+                for (m = j+1; m < nnz; m++) {
+                    cols[m] = cols[m+1];
+                    vals[m] = vals[m+1];
+                }
+            } else {
+                cols[j+1] = ismf[k];
+                vals[j+1] = asmf[k];
+                nnz++;
+            }
+        }
+    }
+    rowp[n] = nnz;
+
+    /*
+     * interleave the right-hand sides (those that are all zero have
+     *    the trivial solution, as in sparseBCG)
+     */
+    bmax = 1;
+    for (k = 0; k < nrhs; k++) {
+        rmin = +HUGEQ;
+        rmax = -HUGEQ;
+        bnrm = 0;
+        for (i = 0; i < n; i++) {
+            rmin  = MIN(rmin, rhs[i+n*k]);
+            rmax  = MAX(rmax, rhs[i+n*k]);
+            bnrm += SQR(rhs[i+n*k]);
+        }
+        bmax = MAX(bmax, sqrt(bnrm));
+
+        for (i = 0; i < n; i++) {
+            bi[nrhs*i+k] = rhs[i+n*k];
+            if (fabs(rmin) < tol && fabs(rmax) < tol) {
+                xi[nrhs*i+k] = 0;
+            } else {
+                xi[nrhs*i+k] = x[i+n*k];
+            }
+        }
+    }
+
+    /*
+     * one ILU(0) factorization shared by all right-hand sides (the
+     *    tolerance keeps the residuals below tol, as in sparseBCG)
+     */
+    status = gem_solveILU(n, nrhs, rowp, cols, vals, bi, xi, tol/bmax,
+                          maxiter, &iter, (nrhs <= 4) ? resid : NULL);
+    DPRINT2("gem_solveILU -> status=%d, iter=%d", status, iter);
+    if (status == GEM_ALLOC) goto cleanup;
+
+    if (status == GEM_SUCCESS) {
+        for (k = 0; k < nrhs; k++) {
+            for (i = 0; i < n; i++) {
+                x[i+n*k] = xi[nrhs*i+k];
+            }
+        }
+
+    /*
+     * fall back to biconjugate gradient one right-hand side at a time
+     */
+    } else {
+        for (k = 0; k < nrhs; k++) {
+            status = sparseBCG(asmf, ismf, &(x[n*k]), &(rhs[n*k]));
+            CHECK_STATUS;
+        }
+    }
+
+ cleanup:
+    FREE(bi  );
+    FREE(xi  );
+    FREE(vals);
+    FREE(cols);
+    FREE(rowp);
+
+    DPRINT2("%s --> status=%d}", routine, status);
+    return status;
+}
+
+
 
 /*
  ********************************************************************************
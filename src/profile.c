@@ -0,0 +1,353 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Profile Functions
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <pthread.h>
+#endif
+
+#include "gem.h"
+#include "profile.h"
+
+
+#ifdef GEM_PROFILE
+
+#ifdef WIN32
+#define PROFTLS     __declspec(thread)
+#else
+#define PROFTLS     __thread
+#endif
+
+
+/* a completed phase for the trace */
+  typedef struct {
+    int    phase;
+    int    tid;                 /* the (profile) thread number */
+    double beg;                 /* seconds from the start of the trace */
+    double dur;
+  } profEvent;
+
+/* the profile of a Context -- kept out of the GEM memory statistics */
+  typedef struct {
+    gemProfile totals;
+    char       *trace;          /* the trace file -- NULL if not tracing */
+    double     start;           /* when the trace started */
+    int        nevent;
+    int        mevent;
+    profEvent  *events;
+  } gemProf;
+
+
+  static char *profPhase[GEM_NPHASE] = {"kernelTessel", "defineQuilt",
+                                        "checkQuilt",   "paramQuilt",
+                                        "CreateUV",     "SmoothUV",
+                                        "BestGrid",     "locate",
+                                        "conjGrad" };
+  static char *profCount[GEM_NCOUNT] = {"located", "extrapolated",
+                                        "cgIterations", "bcgIterations",
+                                        "gridLevels" };
+
+  static gemProf            *profActive = NULL;
+  static int                profNtid    = 0;
+  static PROFTLS int        profTid     = 0;
+  static PROFTLS double     profStart[GEM_NPHASE];
+#ifdef WIN32
+  static int                profInit    = 0;
+  static CRITICAL_SECTION   profLock;
+#define PROFLOCK    EnterCriticalSection(&profLock)
+#define PROFUNLOCK  LeaveCriticalSection(&profLock)
+#else
+  static pthread_mutex_t    profLock    = PTHREAD_MUTEX_INITIALIZER;
+#define PROFLOCK    pthread_mutex_lock(&profLock)
+#define PROFUNLOCK  pthread_mutex_unlock(&profLock)
+#endif
+
+
+static double
+gem_profClock()
+{
+#ifdef WIN32
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.e-9*ts.tv_nsec;
+#endif
+}
+
+
+/* the calling thread's number in the trace -- 1 is the first seen */
+static int
+gem_profThread()
+{
+  if (profTid == 0) {
+    PROFLOCK;
+    profNtid++;
+    profTid = profNtid;
+    PROFUNLOCK;
+  }
+  return profTid;
+}
+
+
+static void
+gem_profClear(gemProf *prof)
+{
+  int i;
+
+  for (i = 0; i < GEM_NPHASE; i++) {
+    prof->totals.calls[i]   = 0;
+    prof->totals.seconds[i] = 0.0;
+  }
+  for (i = 0; i < GEM_NCOUNT; i++) prof->totals.counts[i] = 0;
+}
+
+
+/* write the trace events & the counters -- the caller holds the lock */
+static int
+gem_profWrite(gemProf *prof)
+{
+  int  i;
+  FILE *fp;
+
+  fp = fopen(prof->trace, "w");
+  if (fp == NULL) return GEM_BADNAME;
+
+  fprintf(fp, "{\"traceEvents\":[\n");
+  for (i = 0; i < prof->nevent; i++)
+    fprintf(fp, "{\"name\":\"%s\",\"cat\":\"gem\",\"ph\":\"X\",\"pid\":1,"
+            "\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f},\n",
+            profPhase[prof->events[i].phase], prof->events[i].tid,
+            1.e6*prof->events[i].beg, 1.e6*prof->events[i].dur);
+  fprintf(fp, "{\"name\":\"counters\",\"cat\":\"gem\",\"ph\":\"C\","
+          "\"pid\":1,\"tid\":1,\"ts\":%.3f,\"args\":{",
+          1.e6*(gem_profClock() - prof->start));
+  for (i = 0; i < GEM_NCOUNT; i++)
+    fprintf(fp, "%s\"%s\":%lld", (i == 0) ? "" : ",", profCount[i],
+            prof->totals.counts[i]);
+  fprintf(fp, "}}\n],\"displayTimeUnit\":\"ms\"}\n");
+  fclose(fp);
+
+  return GEM_SUCCESS;
+}
+
+
+/* done tracing -- the caller holds the lock */
+static void
+gem_profStop(gemProf *prof)
+{
+  free(prof->trace);
+  free(prof->events);
+  prof->trace  = NULL;
+  prof->events = NULL;
+  prof->nevent = prof->mevent = 0;
+}
+
+
+/*
+ * the DRep operations select the profile of their Context -- like the
+ *   allocator it is process wide
+ */
+void
+gem_profSelect(/*@null@*/ gemCntxt *cntxt)
+{
+  PROFLOCK;
+  profActive = NULL;
+  if (cntxt != NULL) profActive = (gemProf *) cntxt->prof;
+  PROFUNLOCK;
+}
+
+
+void
+gem_profBegin(int phase)
+{
+  profStart[phase] = gem_profClock();
+}
+
+
+void
+gem_profEnd(int phase)
+{
+  int       tid, m;
+  double    end;
+  profEvent *events;
+  gemProf   *prof;
+
+  end = gem_profClock();
+  tid = gem_profThread();
+
+  PROFLOCK;
+  prof = profActive;
+  if (prof == NULL) {
+    PROFUNLOCK;
+    return;
+  }
+  prof->totals.calls[phase]++;
+  prof->totals.seconds[phase] += end - profStart[phase];
+  if (prof->trace != NULL) {
+    if (prof->nevent == prof->mevent) {
+      m      = (prof->mevent == 0) ? 1024 : 2*prof->mevent;
+      events = (profEvent *) realloc(prof->events, m*sizeof(profEvent));
+      if (events != NULL) {
+        prof->events = events;
+        prof->mevent = m;
+      }
+    }
+    if (prof->nevent < prof->mevent) {
+      prof->events[prof->nevent].phase = phase;
+      prof->events[prof->nevent].tid   = tid;
+      prof->events[prof->nevent].beg   = profStart[phase] - prof->start;
+      prof->events[prof->nevent].dur   = end - profStart[phase];
+      prof->nevent++;
+    }
+  }
+  PROFUNLOCK;
+}
+
+
+void
+gem_profCount(int counter, long long n)
+{
+  gemProf *prof;
+
+  PROFLOCK;
+  prof = profActive;
+  if (prof != NULL) prof->totals.counts[counter] += n;
+  PROFUNLOCK;
+}
+
+#endif
+
+
+void
+gem_profInit(gemCntxt *cntxt)
+{
+#ifdef GEM_PROFILE
+  gemProf *prof;
+
+#ifdef WIN32
+  if (profInit == 0) {
+    InitializeCriticalSection(&profLock);
+    profInit = 1;
+  }
+#endif
+  prof = (gemProf *) malloc(sizeof(gemProf));
+  if (prof != NULL) {
+    gem_profClear(prof);
+    prof->trace  = NULL;
+    prof->start  = 0.0;
+    prof->nevent = prof->mevent = 0;
+    prof->events = NULL;
+  }
+  cntxt->prof = prof;
+#else
+  cntxt->prof = NULL;
+#endif
+}
+
+
+/* an unfinished trace is written as the Context goes away */
+void
+gem_profFree(gemCntxt *cntxt)
+{
+#ifdef GEM_PROFILE
+  gemProf *prof;
+
+  prof = (gemProf *) cntxt->prof;
+  if (prof == NULL) return;
+  PROFLOCK;
+  if (profActive == prof) profActive = NULL;
+  if (prof->trace != NULL) gem_profWrite(prof);
+  gem_profStop(prof);
+  PROFUNLOCK;
+  free(prof);
+#endif
+  cntxt->prof = NULL;
+}
+
+
+int
+gem_getProfile(gemCntxt *cntxt, int reset, gemProfile *profile)
+{
+#ifdef GEM_PROFILE
+  gemProf *prof;
+#endif
+
+  if (cntxt == NULL) return GEM_NULLOBJ;
+  if (cntxt->magic != GEM_MCONTEXT) return GEM_BADCONTEXT;
+  if (profile == NULL) return GEM_NULLVALUE;
+  memset(profile, 0, sizeof(gemProfile));
+#ifdef GEM_PROFILE
+  prof = (gemProf *) cntxt->prof;
+  if (prof == NULL) return GEM_ALLOC;
+
+  PROFLOCK;
+  *profile = prof->totals;
+  if (reset != 0) gem_profClear(prof);
+  PROFUNLOCK;
+  return GEM_SUCCESS;
+#else
+  return GEM_UNSUPPORTED;
+#endif
+}
+
+
+int
+gem_traceProfile(gemCntxt *cntxt, /*@null@*/ const char *filename)
+{
+#ifdef GEM_PROFILE
+  int     stat;
+  char    *trace;
+  gemProf *prof;
+#endif
+
+  if (cntxt == NULL) return GEM_NULLOBJ;
+  if (cntxt->magic != GEM_MCONTEXT) return GEM_BADCONTEXT;
+#ifdef GEM_PROFILE
+  prof = (gemProf *) cntxt->prof;
+  if (prof == NULL) return GEM_ALLOC;
+
+  /* stop -- write the file */
+  if (filename == NULL) {
+    PROFLOCK;
+    stat = GEM_NOTCHANGED;
+    if (prof->trace != NULL) {
+      stat = gem_profWrite(prof);
+      gem_profStop(prof);
+    }
+    PROFUNLOCK;
+    return stat;
+  }
+
+  /* start (again) */
+  trace = (char *) malloc(strlen(filename)+1);
+  if (trace == NULL) return GEM_ALLOC;
+  strcpy(trace, filename);
+  PROFLOCK;
+  gem_profStop(prof);
+  prof->trace = trace;
+  prof->start = gem_profClock();
+  PROFUNLOCK;
+  return GEM_SUCCESS;
+#else
+  return GEM_UNSUPPORTED;
+#endif
+}
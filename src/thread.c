@@ -0,0 +1,306 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Simple Thread Functions
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <pthread.h>
+#endif
+
+#include "gem.h"
+#include "memory.h"
+
+
+#define MAXTHREAD   256         /* limit on the number of threads */
+#define MINCHUNK    64          /* minimum number of items per thread */
+
+
+  typedef struct {
+    int  (*func)(void *data, int beg, int end);
+    void *data;
+    int  beg;
+    int  end;
+    int  stat;
+  } gemChunk;
+
+  typedef struct {
+    int  (*func)(void *data, int beg, int end);
+    void *data;
+    int  n;
+    int  next;                  /* the next task to hand out */
+    int  fail;                  /* the lowest failing task (n if none) */
+    int  stat;                  /* its status */
+#ifdef WIN32
+    CRITICAL_SECTION lock;
+#else
+    pthread_mutex_t  lock;
+#endif
+  } gemTasks;
+
+
+/*
+ * the number of processors available
+ */
+int
+gem_nProcessors()
+{
+  int  n;
+#ifdef WIN32
+  SYSTEM_INFO info;
+
+  GetSystemInfo(&info);
+  n = info.dwNumberOfProcessors;
+#else
+  n = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+  if (n < 1) n = 1;
+  if (n > MAXTHREAD) n = MAXTHREAD;
+  return n;
+}
+
+
+#ifdef WIN32
+static DWORD WINAPI
+gem_chunkRun(LPVOID arg)
+{
+  gemChunk *chunk = (gemChunk *) arg;
+
+  chunk->stat = chunk->func(chunk->data, chunk->beg, chunk->end);
+  return 0;
+}
+#else
+static void *
+gem_chunkRun(void *arg)
+{
+  gemChunk *chunk = (gemChunk *) arg;
+
+  chunk->stat = chunk->func(chunk->data, chunk->beg, chunk->end);
+  return NULL;
+}
+#endif
+
+
+/*
+ * run func over [0,n) split into contiguous chunks -- one per thread. the
+ *   caller's thread does the first chunk. the returned status is that of
+ *   the lowest failing chunk, so errors are reported as in a serial sweep.
+ */
+int
+gem_threadRun(int nThread, int n, int (*func)(void *data, int beg, int end),
+              void *data)
+{
+  int      i, nchunk, stat;
+  gemChunk *chunks;
+#ifdef WIN32
+  HANDLE   *threads;
+#else
+  pthread_t *threads;
+#endif
+
+  if (n <= 0) return GEM_SUCCESS;
+  nchunk = n/MINCHUNK;
+  if (nchunk > nThread)   nchunk = nThread;
+  if (nchunk > MAXTHREAD) nchunk = MAXTHREAD;
+  if (nchunk <= 1) return func(data, 0, n);
+
+  chunks  = (gemChunk *) gem_allocate(nchunk*sizeof(gemChunk));
+  if (chunks == NULL) return func(data, 0, n);
+#ifdef WIN32
+  threads = (HANDLE *)    gem_allocate(nchunk*sizeof(HANDLE));
+#else
+  threads = (pthread_t *) gem_allocate(nchunk*sizeof(pthread_t));
+#endif
+  if (threads == NULL) {
+    gem_free(chunks);
+    return func(data, 0, n);
+  }
+
+  for (i = 0; i < nchunk; i++) {
+    chunks[i].func = func;
+    chunks[i].data = data;
+    chunks[i].beg  = (int) (((long) n* i   )/nchunk);
+    chunks[i].end  = (int) (((long) n*(i+1))/nchunk);
+    chunks[i].stat = GEM_SUCCESS;
+  }
+
+  /* start the others (or run the chunk here if a thread cannot start) */
+  for (i = 1; i < nchunk; i++) {
+#ifdef WIN32
+    threads[i] = CreateThread(NULL, 0, gem_chunkRun, &chunks[i], 0, NULL);
+    if (threads[i] == NULL) gem_chunkRun(&chunks[i]);
+#else
+    if (pthread_create(&threads[i], NULL, gem_chunkRun, &chunks[i]) != 0) {
+      threads[i] = pthread_self();
+      gem_chunkRun(&chunks[i]);
+    }
+#endif
+  }
+  gem_chunkRun(&chunks[0]);
+
+  for (i = 1; i < nchunk; i++) {
+#ifdef WIN32
+    if (threads[i] == NULL) continue;
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    if (pthread_equal(threads[i], pthread_self())) continue;
+    pthread_join(threads[i], NULL);
+#endif
+  }
+
+  stat = GEM_SUCCESS;
+  for (i = 0; i < nchunk; i++)
+    if (chunks[i].stat != GEM_SUCCESS) {
+      stat = chunks[i].stat;
+      break;
+    }
+
+  gem_free(threads);
+  gem_free(chunks);
+  return stat;
+}
+
+
+#ifdef WIN32
+static DWORD WINAPI
+gem_taskRun(LPVOID arg)
+#else
+static void *
+gem_taskRun(void *arg)
+#endif
+{
+  int      i, stat;
+  gemTasks *tasks = (gemTasks *) arg;
+
+  for (;;) {
+#ifdef WIN32
+    EnterCriticalSection(&tasks->lock);
+#else
+    pthread_mutex_lock(&tasks->lock);
+#endif
+    i = tasks->next;
+    if (i < tasks->n) tasks->next++;
+#ifdef WIN32
+    LeaveCriticalSection(&tasks->lock);
+#else
+    pthread_mutex_unlock(&tasks->lock);
+#endif
+    if (i >= tasks->n) break;
+
+    stat = tasks->func(tasks->data, i, i+1);
+    if (stat == GEM_SUCCESS) continue;
+#ifdef WIN32
+    EnterCriticalSection(&tasks->lock);
+#else
+    pthread_mutex_lock(&tasks->lock);
+#endif
+    if (i < tasks->fail) {
+      tasks->fail = i;
+      tasks->stat = stat;
+    }
+#ifdef WIN32
+    LeaveCriticalSection(&tasks->lock);
+#else
+    pthread_mutex_unlock(&tasks->lock);
+#endif
+  }
+
+#ifdef WIN32
+  return 0;
+#else
+  return NULL;
+#endif
+}
+
+
+/*
+ * run func once for each of [0,n) where the items are coarse and of uneven
+ *   cost (e.g. a BRep) -- the threads take the next item as they finish.
+ *   all items are run; the returned status is that of the lowest failing.
+ */
+int
+gem_threadTasks(int nThread, int n, int (*func)(void *data, int beg, int end),
+                void *data)
+{
+  int      i, nthrd, stat;
+  gemTasks tasks;
+#ifdef WIN32
+  HANDLE   *threads;
+#else
+  pthread_t *threads;
+#endif
+
+  if (n <= 0) return GEM_SUCCESS;
+  nthrd = nThread;
+  if (nthrd > n)         nthrd = n;
+  if (nthrd > MAXTHREAD) nthrd = MAXTHREAD;
+  if (nthrd <= 1) {
+    tasks.stat = GEM_SUCCESS;
+    for (i = 0; i < n; i++) {
+      stat = func(data, i, i+1);
+      if ((stat != GEM_SUCCESS) && (tasks.stat == GEM_SUCCESS))
+        tasks.stat = stat;
+    }
+    return tasks.stat;
+  }
+
+#ifdef WIN32
+  threads = (HANDLE *)    gem_allocate(nthrd*sizeof(HANDLE));
+#else
+  threads = (pthread_t *) gem_allocate(nthrd*sizeof(pthread_t));
+#endif
+  if (threads == NULL) return gem_threadTasks(1, n, func, data);
+
+  tasks.func = func;
+  tasks.data = data;
+  tasks.n    = n;
+  tasks.next = 0;
+  tasks.fail = n;
+  tasks.stat = GEM_SUCCESS;
+#ifdef WIN32
+  InitializeCriticalSection(&tasks.lock);
+#else
+  pthread_mutex_init(&tasks.lock, NULL);
+#endif
+
+  /* the caller's thread is a worker too */
+  for (i = 1; i < nthrd; i++) {
+#ifdef WIN32
+    threads[i] = CreateThread(NULL, 0, gem_taskRun, &tasks, 0, NULL);
+#else
+    if (pthread_create(&threads[i], NULL, gem_taskRun, &tasks) != 0)
+      threads[i] = pthread_self();
+#endif
+  }
+  gem_taskRun(&tasks);
+
+  for (i = 1; i < nthrd; i++) {
+#ifdef WIN32
+    if (threads[i] == NULL) continue;
+    WaitForSingleObject(threads[i], INFINITE);
+    CloseHandle(threads[i]);
+#else
+    if (pthread_equal(threads[i], pthread_self())) continue;
+    pthread_join(threads[i], NULL);
+#endif
+  }
+
+#ifdef WIN32
+  DeleteCriticalSection(&tasks.lock);
+#else
+  pthread_mutex_destroy(&tasks.lock);
+#endif
+  gem_free(threads);
+  return tasks.stat;
+}
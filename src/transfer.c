@@ -18,10 +18,13 @@
 #include "memory.h"
 #include "disMethod.h"
 #include "connect.h"
+#include "profile.h"
 
 
 //#define DEBUG
 
+#define SIDECHUNK 16384         /* minimum sides per thread (neighbors) */
+
 
   typedef struct {
     int      irank;
@@ -44,11 +47,58 @@
     bInterp  *Interpol_bar;
     gIntegr  *Integrate;
     bIntegr  *Integr_bar;
+    gInterpB *InterpBatch;      /* optional batched entries (may be NULL) */
+    gIntegrB *IntegrBatch;
+    double   *asrc;             /* source integral per rank (fixed) */
+    double   *fsrc;             /* source at the MatchPoints (fixed) */
+    double   *ftgt;             /* target at the MatchPoints -- forward sweep */
+    double   *work;             /* workspace -- rank*max(nElems) */
+    double   *res_bar;          /* workspace -- rank */
+    double   *dat_bar;          /* workspace -- rank*npts */
   } gemCFit;
 
 
+  typedef struct {
+    gemQuilt  *quilt;
+    gemUVGrid *grid;
+    invEval   iEval;
+    double    *uvq;
+    gemTarget *target;
+    double    *uvs;
+  } gemLocate;
+
+
+  typedef struct {
+    gInterpB  batch;
+    gInterp   single;
+    gemQuilt  *quilt;
+    int       geomFlag;
+    gemTarget *pos;
+    int       rank;
+    double    *data;
+    double    *result;
+  } gemInterpRun;
+
+
+  typedef struct {
+    int      row;
+    int      col;
+    double   val;
+  } gemTrip;
+
+
   extern double gem_orienTri(double *t0, double *t1, double *t2);
   extern int    gem_metDLoaded(const char *name);
+  extern int    gem_drepThreads(gemDRep *drep);
+  extern int    gem_threadRun(int nThread, int n,
+                              int (*func)(void *data, int beg, int end),
+                              void *data);
+  extern int    gem_threadTasks(int nThread, int n,
+                                int (*func)(void *data, int beg, int end),
+                                void *data);
+  extern int    gem_solveSPD(int n, int nrhs, int rowp[], int cols[],
+                             double vals[], double rhs[], double x[],
+                             double tol, int maxit, /*@null@*/ int *iters);
   extern int    gem_conjGrad(int (*objFn)(int n, double x[], void *data,
                                           double *obj, /*@null@*/ double grad[]),
                              void *data, int n, double x[], double ftol,
@@ -123,6 +173,176 @@ gem_fillNeighbor(int k1, int k2, int *tri, int *kside, int *vtable,
 }
 
 
+/*
+ * the triangle sides sorted by their (smaller, larger) vertex pair -- two
+ *   stable counting sorts (larger vertex, then smaller), each split into
+ *   contiguous chunks of sides so the counts & scatters run in parallel
+ */
+
+  typedef struct {
+    int    nbin;                /* npts+1 (bin 0 holds bad sides) */
+    int    nside;               /* 3*ntris */
+    int    nchunk;              /* number of chunks of sides */
+    prmTri *tris;
+    int    *key1;               /* smaller vertex of each side (bias 1) */
+    int    *key2;               /* larger  vertex of each side (bias 1) */
+    int    *key;                /* the key for this pass */
+    int    *hist;               /* bin offsets for each chunk */
+    int    *in;                 /* sides in the current order (or NULL) */
+    int    *out;                /* sides in the next order */
+    int    pass;
+  } gemSideSort;
+
+
+static int
+gem_sideRange(void *data, int beg, int end)
+{
+  int         i, c, k, s, lo, hi, t0, t1, v0, v1, *hist;
+  gemSideSort *srt = (gemSideSort *) data;
+  static int  sideVerts[3][2] = { {1, 2}, {0, 2}, {0, 1} };
+
+  for (c = beg; c < end; c++) {
+    lo   = (int) (((long) srt->nside* c   )/srt->nchunk);
+    hi   = (int) (((long) srt->nside*(c+1))/srt->nchunk);
+    hist = &srt->hist[c*srt->nbin];
+
+    if (srt->pass == 0) {
+
+      /* the keys -- every side starts out unmatched */
+      for (s = lo; s < hi; s++) {
+        i  = s/3;
+        k  = s%3;
+        v0 = srt->tris[i].indices[sideVerts[k][0]];
+        v1 = srt->tris[i].indices[sideVerts[k][1]];
+        if (v0 > v1) {
+          t0 = v0;
+          v0 = v1;
+          v1 = t0;
+        }
+        if ((v0 < 1) || (v1 >= srt->nbin)) v0 = v1 = 0;
+        srt->key1[s] = v0;
+        srt->key2[s] = v1;
+        srt->tris[i].neigh[k] = 0;
+      }
+
+    } else if (srt->pass == 1) {
+
+      /* count the bins */
+      for (k = 0; k < srt->nbin; k++) hist[k] = 0;
+      for (i = lo; i < hi; i++) {
+        s = (srt->in == NULL) ? i : srt->in[i];
+        hist[srt->key[s]]++;
+      }
+
+    } else if (srt->pass == 2) {
+
+      /* scatter -- chunks fill their bins in order so the sort is stable */
+      for (i = lo; i < hi; i++) {
+        s = (srt->in == NULL) ? i : srt->in[i];
+        srt->out[hist[srt->key[s]]++] = s;
+      }
+
+    } else {
+
+      /* pair the first two of each run of equal sides (in triangle order) --
+         a run is handled by the chunk it starts in */
+      i = lo;
+      while ((i > 0) && (i < hi) &&
+             (srt->key1[srt->in[i]] == srt->key1[srt->in[i-1]]) &&
+             (srt->key2[srt->in[i]] == srt->key2[srt->in[i-1]])) i++;
+      while (i < hi) {
+        s = srt->in[i];
+        for (k = i+1; k < srt->nside; k++)
+          if ((srt->key1[srt->in[k]] != srt->key1[s]) ||
+              (srt->key2[srt->in[k]] != srt->key2[s])) break;
+        if ((srt->key1[s] != 0) && (k-i > 1)) {
+          t0 = srt->in[i  ];
+          t1 = srt->in[i+1];
+          srt->tris[t0/3].neigh[t0%3] = t1/3 + 1;
+          srt->tris[t1/3].neigh[t1%3] = t0/3 + 1;
+          for (t1 = i+2; t1 < k; t1++) {
+            t0 = srt->in[t1];
+            srt->tris[t0/3].neigh[t0%3] = t0/3 + 1;
+            printf("GEM Internal: Side %d %d complete [but %d] (gem_triNeighbors)!\n",
+                   srt->key1[s], srt->key2[s], t0/3 + 1);
+          }
+        }
+        i = k;
+      }
+
+    }
+  }
+
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * fill in the triangle neighbors (bias 1, 0 for an open side) -- as
+ *   gem_fillNeighbor: the first two triangles with a side are neighbors,
+ *   any more refer to themselves
+ */
+int
+gem_triNeighbors(int nThread, int npts, int ntris, prmTri *tris)
+{
+  int         i, j, c, run, tmp, *keys, *perm;
+  gemSideSort srt;
+
+  if (ntris <= 0) return GEM_SUCCESS;
+
+  srt.nbin   = npts+1;
+  srt.nside  = 3*ntris;
+  srt.nchunk = srt.nside/SIDECHUNK;
+  if (srt.nchunk > nThread) srt.nchunk = nThread;
+  if (srt.nchunk < 1)       srt.nchunk = 1;
+  srt.tris   = tris;
+  keys = (int *) gem_allocate(2*srt.nside*sizeof(int));
+  if (keys == NULL) return GEM_ALLOC;
+  perm = (int *) gem_allocate(2*srt.nside*sizeof(int));
+  if (perm == NULL) {
+    gem_free(keys);
+    return GEM_ALLOC;
+  }
+  srt.hist = (int *) gem_allocate(srt.nchunk*srt.nbin*sizeof(int));
+  if (srt.hist == NULL) {
+    gem_free(perm);
+    gem_free(keys);
+    return GEM_ALLOC;
+  }
+  srt.key1 = keys;
+  srt.key2 = keys + srt.nside;
+  srt.in   = NULL;
+  srt.out  = perm;
+  srt.pass = 0;
+  gem_threadTasks(nThread, srt.nchunk, gem_sideRange, &srt);
+
+  /* sort on the larger vertex and then (stably) on the smaller */
+  for (j = 0; j < 2; j++) {
+    srt.key  = (j == 0) ? srt.key2 : srt.key1;
+    srt.pass = 1;
+    gem_threadTasks(nThread, srt.nchunk, gem_sideRange, &srt);
+    for (run = i = 0; i < srt.nbin; i++)
+      for (c = 0; c < srt.nchunk; c++) {
+        tmp = srt.hist[c*srt.nbin+i];
+        srt.hist[c*srt.nbin+i] = run;
+        run += tmp;
+      }
+    srt.pass = 2;
+    gem_threadTasks(nThread, srt.nchunk, gem_sideRange, &srt);
+    srt.in   = srt.out;
+    srt.out  = (srt.in == perm) ? perm + srt.nside : perm;
+  }
+
+  srt.pass = 3;
+  gem_threadTasks(nThread, srt.nchunk, gem_sideRange, &srt);
+
+  gem_free(srt.hist);
+  gem_free(perm);
+  gem_free(keys);
+  return GEM_SUCCESS;
+}
+
+
 static int
 gem_sign(double s)
 {
@@ -176,73 +396,288 @@ gem_inTriExact(double *t1, double *t2, double *t3, double *p, double *w)
 }
 
 
+static int
+gem_uvCell(double x, double xmin, double dx, int n)
+{
+  double d;
+  
+  if (dx <= 0.0) return 0;
+  d = (x - xmin)/dx;
+  if (d <  0.0) return 0;
+  if (d >= n)   return n-1;
+  return (int) d;
+}
+
+
 static void
-gem_inElem(gemQuilt *quilt, invEval iEval, double *uvq, int npts,
-           gemTarget *target, double *uvs)
+gem_freeUVGrid(/*@null@*/ /*@only@*/ gemUVGrid *grid)
+{
+  if (grid == NULL) return;
+  
+  if (grid->cells != NULL) gem_free(grid->cells);
+  if (grid->start != NULL) gem_free(grid->start);
+  if (grid->tris  != NULL) gem_free(grid->tris);
+  gem_free(grid);
+}
+
+
+/*
+ * invalidates the point-location grid -- must be called whenever the
+ *             quilt or the "uv" DataSet of the VertexSet changes
+ */
+void
+gem_clrLocate(gemVSet *vset)
 {
-  int    i, j, k, i0, i1, i2, n, stat, type;
-  double w[3], *st0, *st1, *st2;
+  gem_freeUVGrid(vset->locate);
+  vset->locate = NULL;
+}
+
 
-  /* find closest triangle for all positions */
-  for (i = 0; i < quilt->nElems; i++) {
+static void
+gem_triBox(gemUVGrid *grid, double *uvq, int itri, int *ibox)
+{
+  int    i, k;
+  double box[4];
+  
+  k      = grid->tris[5*itri+2];
+  box[0] = box[1] = uvq[2*k  ];
+  box[2] = box[3] = uvq[2*k+1];
+  for (i = 3; i < 5; i++) {
+    k = grid->tris[5*itri+i];
+    if (uvq[2*k  ] < box[0]) box[0] = uvq[2*k  ];
+    if (uvq[2*k  ] > box[1]) box[1] = uvq[2*k  ];
+    if (uvq[2*k+1] < box[2]) box[2] = uvq[2*k+1];
+    if (uvq[2*k+1] > box[3]) box[3] = uvq[2*k+1];
+  }
+  ibox[0] = gem_uvCell(box[0], grid->box[0], grid->du, grid->nu);
+  ibox[1] = gem_uvCell(box[1], grid->box[0], grid->du, grid->nu);
+  ibox[2] = gem_uvCell(box[2], grid->box[2], grid->dv, grid->nv);
+  ibox[3] = gem_uvCell(box[3], grid->box[2], grid->dv, grid->nv);
+}
+
+
+/*
+ * bins the internal triangles of the quilt into a uniform grid in uv
+ *         (cell lists are ordered by element so the first hit matches
+ *          the order of a brute-force scan)
+ */
+static /*@null@*/ gemUVGrid *
+gem_makeUVGrid(gemQuilt *quilt, double *uvq)
+{
+  int       i, j, k, m, n, iu, iv, type, ntris, ibox[4], *conn;
+  double    aspect;
+  gemUVGrid *grid;
+  
+  grid = (gemUVGrid *) gem_allocate(sizeof(gemUVGrid));
+  if (grid == NULL) return NULL;
+  grid->ntris = 0;
+  grid->tris  = NULL;
+  grid->start = NULL;
+  grid->cells = NULL;
+  
+  for (ntris = i = 0; i < quilt->nElems; i++) {
+    type   = quilt->elems[i].tIndex - 1;
+    ntris += quilt->types[type].ntri;
+  }
+  if (ntris == 0) ntris = 1;
+  grid->tris = (int *) gem_allocate(5*ntris*sizeof(int));
+  if (grid->tris == NULL) {
+    gem_freeUVGrid(grid);
+    return NULL;
+  }
+  
+  /* collect the non-degenerate triangles */
+  for (ntris = i = 0; i < quilt->nElems; i++) {
     type = quilt->elems[i].tIndex - 1;
+    conn = &quilt->packed->conn[quilt->packed->eptr[i]];
     for (j = 0; j < quilt->types[type].ntri; j++) {
-      n   =  quilt->types[type].tris[3*j  ] - 1;
-      i0  =  quilt->elems[i].gIndices[n] - 1;
-      st0 = &quilt->types[type].gst[2*n];
-      n   =  quilt->types[type].tris[3*j+1] - 1;
-      i1  =  quilt->elems[i].gIndices[n] - 1;
-      st1 = &quilt->types[type].gst[2*n];
-      n   =  quilt->types[type].tris[3*j+2] - 1;
-      i2  =  quilt->elems[i].gIndices[n] - 1;
-      st2 = &quilt->types[type].gst[2*n];
-      if (gem_sign(gem_orienTri(&uvq[2*i0], &uvq[2*i1],
-                                &uvq[2*i2])) == 0) continue;
-      for (k = 0; k < npts; k++) {
-        if (target[k].eIndex > 0) continue;
-        stat = gem_inTriExact(&uvq[2*i0], &uvq[2*i1], &uvq[2*i2], &uvs[2*k], w);
-        if (stat == GEM_SUCCESS) {
-          /* inside -- set the position */
-          target[k].eIndex = i+1;
-          target[k].st[0]  = w[0]*st0[0] + w[1]*st1[0] + w[2]*st2[0];
-          target[k].st[1]  = w[0]*st0[1] + w[1]*st1[1] + w[2]*st2[1];
-/*        printf("  %d/%d:  %lf %lf  ", i+1, j, 
-                 target[k].st[0], target[k].st[1]);  */
-          iEval(quilt, uvq, &uvs[2*k], &target[k].eIndex, target[k].st);
-/*        printf(" %lf %lf\n", target[k].st[0], target[k].st[1]);  */
-          break;
-        }
-        if (w[1] < w[0]) w[0] = w[1];
-        if (w[2] < w[0]) w[0] = w[2];
-        if (target[k].eIndex == 0) {
-          target[k].eIndex = -i-1;
-          target[k].st[0]  = w[0];
-          target[k].st[1]  = j;
-        } else {
-          if (w[0] > target[k].st[0]) {
-            target[k].eIndex = -i-1;
-            target[k].st[0]  = w[0];
-            target[k].st[1]  = j;
+      grid->tris[5*ntris  ] = i;
+      grid->tris[5*ntris+1] = j;
+      for (k = 0; k < 3; k++) {
+        n = quilt->types[type].tris[3*j+k] - 1;
+        grid->tris[5*ntris+2+k] = conn[n];
+      }
+      if (gem_sign(gem_orienTri(&uvq[2*grid->tris[5*ntris+2]],
+                                &uvq[2*grid->tris[5*ntris+3]],
+                                &uvq[2*grid->tris[5*ntris+4]])) == 0) continue;
+      if (ntris == 0) {
+        grid->box[0] = grid->box[1] = uvq[2*grid->tris[2]  ];
+        grid->box[2] = grid->box[3] = uvq[2*grid->tris[2]+1];
+      }
+      for (k = 2; k < 5; k++) {
+        m = grid->tris[5*ntris+k];
+        if (uvq[2*m  ] < grid->box[0]) grid->box[0] = uvq[2*m  ];
+        if (uvq[2*m  ] > grid->box[1]) grid->box[1] = uvq[2*m  ];
+        if (uvq[2*m+1] < grid->box[2]) grid->box[2] = uvq[2*m+1];
+        if (uvq[2*m+1] > grid->box[3]) grid->box[3] = uvq[2*m+1];
+      }
+      ntris++;
+    }
+  }
+  grid->ntris = ntris;
+  if (ntris == 0) {
+    grid->box[0] = grid->box[1] = grid->box[2] = grid->box[3] = 0.0;
+    ntris = 1;
+  }
+
+  /* size the grid for about one triangle per cell */
+  aspect = 1.0;
+  if ((grid->box[1] > grid->box[0]) && (grid->box[3] > grid->box[2]))
+    aspect = (grid->box[1] - grid->box[0])/(grid->box[3] - grid->box[2]);
+  grid->nu = sqrt(ntris*aspect);
+  if (grid->nu < 1)     grid->nu = 1;
+  if (grid->nu > ntris) grid->nu = ntris;
+  grid->nv = ntris/grid->nu;
+  if (grid->nv < 1)     grid->nv = 1;
+  grid->du = (grid->box[1] - grid->box[0])/grid->nu;
+  grid->dv = (grid->box[3] - grid->box[2])/grid->nv;
+  
+  grid->start = (int *) gem_allocate((grid->nu*grid->nv+1)*sizeof(int));
+  if (grid->start == NULL) {
+    gem_freeUVGrid(grid);
+    return NULL;
+  }
+  for (i = 0; i <= grid->nu*grid->nv; i++) grid->start[i] = 0;
+  
+  /* count and then fill the cells (in triangle order) */
+  for (i = 0; i < grid->ntris; i++) {
+    gem_triBox(grid, uvq, i, ibox);
+    for (iv = ibox[2]; iv <= ibox[3]; iv++)
+      for (iu = ibox[0]; iu <= ibox[1]; iu++)
+        grid->start[iv*grid->nu+iu+1]++;
+  }
+  for (i = 0; i < grid->nu*grid->nv; i++)
+    grid->start[i+1] += grid->start[i];
+  
+  n = grid->start[grid->nu*grid->nv];
+  if (n == 0) n = 1;
+  grid->cells = (int *) gem_allocate(n*sizeof(int));
+  if (grid->cells == NULL) {
+    gem_freeUVGrid(grid);
+    return NULL;
+  }
+  for (i = 0; i < grid->ntris; i++) {
+    gem_triBox(grid, uvq, i, ibox);
+    for (iv = ibox[2]; iv <= ibox[3]; iv++)
+      for (iu = ibox[0]; iu <= ibox[1]; iu++) {
+        k = iv*grid->nu + iu;
+        grid->cells[grid->start[k]] = i;
+        grid->start[k]++;
+      }
+  }
+  for (i = grid->nu*grid->nv; i > 0; i--) grid->start[i] = grid->start[i-1];
+  grid->start[0] = 0;
+
+  return grid;
+}
+
+
+/*
+ * returns the point-location grid of a source VertexSet -- built on first
+ *         use and kept until gem_clrLocate
+ */
+static /*@null@*/ gemUVGrid *
+gem_getUVGrid(gemVSet *vset)
+{
+  if (vset->locate == NULL)
+    vset->locate = gem_makeUVGrid(vset->quilt, vset->sets[1].dset.data);
+  
+  return vset->locate;
+}
+
+
+static void
+gem_inElem(gemQuilt *quilt, gemUVGrid *grid, invEval iEval, double *uvq,
+           int npts, gemTarget *target, double *uvs)
+{
+  int    i, j, k, i0, i1, i2, n, m, stat, type, iu, iv, ju, jv, ring, last;
+  int    step, best, *tri, *conn;
+  double w[3], wbest, *st0, *st1, *st2;
+#ifdef GEM_PROFILE
+  int    nex = 0;
+#endif
+
+  for (k = 0; k < npts; k++) {
+    if (target[k].eIndex > 0) continue;
+    iu = gem_uvCell(uvs[2*k  ], grid->box[0], grid->du, grid->nu);
+    iv = gem_uvCell(uvs[2*k+1], grid->box[2], grid->dv, grid->nv);
+
+    /* the first triangle (in element order) that contains the point */
+    n = iv*grid->nu + iu;
+    for (m = grid->start[n]; m < grid->start[n+1]; m++) {
+      tri  = &grid->tris[5*grid->cells[m]];
+      stat = gem_inTriExact(&uvq[2*tri[2]], &uvq[2*tri[3]], &uvq[2*tri[4]],
+                            &uvs[2*k], w);
+      if (stat != GEM_SUCCESS) continue;
+      /* inside -- set the position */
+      i    = tri[0];
+      j    = tri[1];
+      type = quilt->elems[i].tIndex - 1;
+      st0  = &quilt->types[type].gst[2*(quilt->types[type].tris[3*j  ]-1)];
+      st1  = &quilt->types[type].gst[2*(quilt->types[type].tris[3*j+1]-1)];
+      st2  = &quilt->types[type].gst[2*(quilt->types[type].tris[3*j+2]-1)];
+      target[k].eIndex = i+1;
+      target[k].st[0]  = w[0]*st0[0] + w[1]*st1[0] + w[2]*st2[0];
+      target[k].st[1]  = w[0]*st0[1] + w[1]*st1[1] + w[2]*st2[1];
+      iEval(quilt, uvq, &uvs[2*k], &target[k].eIndex, target[k].st);
+      break;
+    }
+    if (target[k].eIndex > 0) continue;
+    
+    /* outside -- find the closest triangle in rings of cells about the
+       point (one ring beyond the first that has candidates) */
+    best  = -1;
+    wbest =  0.0;
+    last  = grid->nu;
+    if (grid->nv > last) last = grid->nv;
+    for (ring = 0; ring <= last; ring++) {
+      for (jv = iv-ring; jv <= iv+ring; jv++) {
+        if ((jv < 0) || (jv >= grid->nv)) continue;
+        step = 2*ring;
+        if (abs(jv-iv) == ring) step = 1;
+        for (ju = iu-ring; ju <= iu+ring; ju += step) {
+          if ((ju < 0) || (ju >= grid->nu)) continue;
+          n = jv*grid->nu + ju;
+          for (m = grid->start[n]; m < grid->start[n+1]; m++) {
+            tri = &grid->tris[5*grid->cells[m]];
+            gem_inTriExact(&uvq[2*tri[2]], &uvq[2*tri[3]], &uvq[2*tri[4]],
+                           &uvs[2*k], w);
+            if (w[1] < w[0]) w[0] = w[1];
+            if (w[2] < w[0]) w[0] = w[2];
+            if ((best == -1) || (w[0] > wbest) ||
+                ((w[0] == wbest) && (grid->cells[m] < best))) {
+              best  = grid->cells[m];
+              wbest = w[0];
+            }
           }
         }
       }
+      if ((best != -1) && (last > ring+1)) last = ring+1;
     }
+    if (best == -1) continue;
+    target[k].eIndex = -grid->tris[5*best]-1;
+    target[k].st[0]  =  wbest;
+    target[k].st[1]  =  grid->tris[5*best+1];
   }
   
   /* fix up points from extrapolated triangles */
   for (i = 0; i < npts; i++) {
     if (target[i].eIndex >= 0) continue;
+#ifdef GEM_PROFILE
+    nex++;
+#endif
     k    = -target[i].eIndex - 1;
     j    =  target[i].st[1] + 0.00001;
     type =  quilt->elems[k].tIndex - 1;
+    conn = &quilt->packed->conn[quilt->packed->eptr[k]];
     n    =  quilt->types[type].tris[3*j  ] - 1;
-    i0   =  quilt->elems[k].gIndices[n] - 1;
+    i0   =  conn[n];
     st0  = &quilt->types[type].gst[2*n];
     n    =  quilt->types[type].tris[3*j+1] - 1;
-    i1   =  quilt->elems[k].gIndices[n] - 1;
+    i1   =  conn[n];
     st1  = &quilt->types[type].gst[2*n];
     n    =  quilt->types[type].tris[3*j+2] - 1;
-    i2   =  quilt->elems[k].gIndices[n] - 1;
+    i2   =  conn[n];
     st2  = &quilt->types[type].gst[2*n];
     gem_inTriExact(&uvq[2*i0], &uvq[2*i1], &uvq[2*i2], &uvs[2*i], w);
     target[i].eIndex = k+1;
@@ -253,7 +688,41 @@ gem_inElem(gemQuilt *quilt, invEval iEval, double *uvq, int npts,
     iEval(quilt, uvq, &uvs[2*i], &target[i].eIndex, target[i].st);
 /*  printf(" %lf %lf\n", target[i].st[0], target[i].st[1]);  */
   }
+  GEM_PROFCOUNT(GEM_CLOCATED, npts-nex);
+  GEM_PROFCOUNT(GEM_CEXTRAP,  nex);
+
+}
+
 
+static int
+gem_inElemRange(void *data, int beg, int end)
+{
+  gemLocate *loc = (gemLocate *) data;
+  
+  gem_inElem(loc->quilt, loc->grid, loc->iEval, loc->uvq, end-beg,
+             &loc->target[beg], &loc->uvs[2*beg]);
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * locate the points -- each is independent so the work is split over threads
+ */
+static void
+gem_locate(int nThread, gemQuilt *quilt, gemUVGrid *grid, invEval iEval,
+           double *uvq, int npts, gemTarget *target, double *uvs)
+{
+  gemLocate loc;
+  
+  loc.quilt  = quilt;
+  loc.grid   = grid;
+  loc.iEval  = iEval;
+  loc.uvq    = uvq;
+  loc.target = target;
+  loc.uvs    = uvs;
+  GEM_PROFBEG(GEM_PLOCATE);
+  gem_threadRun(nThread, npts, gem_inElemRange, &loc);
+  GEM_PROFEND(GEM_PLOCATE);
 }
 
 
@@ -264,6 +733,7 @@ gem_getPositions(gemDRep *drep, int bound, invEval iEval, gemXfer *xfer)
   double    *uvq, *uvs;
   gemQuilt  *quilt;
   gemTarget *target;
+  gemUVGrid *grid;
 
   ivsrc  = xfer->ivss;
   vs     = xfer->ivst;
@@ -280,7 +750,13 @@ gem_getPositions(gemDRep *drep, int bound, invEval iEval, gemXfer *xfer)
     target[i].st[0]  = 0.0;
     target[i].st[1]  = 0.0;
   }
-  gem_inElem(quilt, iEval, uvq, npts, target, uvs);
+  grid = gem_getUVGrid(&drep->bound[bound-1].VSet[ivsrc-1]);
+  if (grid == NULL) {
+    gem_free(target);
+    return GEM_ALLOC;
+  }
+  gem_locate(gem_drepThreads(drep), quilt, grid, iEval, uvq, npts, target,
+             uvs);
 
   xfer->position   = target;
   xfer->nPositions = npts;
@@ -295,6 +771,7 @@ gem_getConnPos(gemDRep *drep, int bound, invEval iEval, gemXfer *xfer)
   double    *uvq, *uvs;
   gemQuilt  *quilt;
   gemTarget *target;
+  gemUVGrid *grid;
   
   ivsrc  = xfer->ivss;
   vs     = xfer->ivst;
@@ -314,7 +791,13 @@ gem_getConnPos(gemDRep *drep, int bound, invEval iEval, gemXfer *xfer)
     target[i].st[0]  = 0.0;
     target[i].st[1]  = 0.0;
   }
-  gem_inElem(quilt, iEval, uvq, npts, target, uvs);
+  grid = gem_getUVGrid(&drep->bound[bound-1].VSet[ivsrc-1]);
+  if (grid == NULL) {
+    gem_free(target);
+    return GEM_ALLOC;
+  }
+  gem_locate(gem_drepThreads(drep), quilt, grid, iEval, uvq, npts, target,
+             uvs);
   
   xfer->position   = target;
   xfer->nPositions = npts;
@@ -331,6 +814,7 @@ gem_makeMatch(gemDRep *drep, int bound, gInterp *Interpolate, invEval iEval,
   gemQuilt  *quilt, *quiltt;
   gemTarget *target;
   gemMatch  *match;
+  gemUVGrid *grid;
   
   ivsrc  = xfer->ivss;
   vs     = xfer->ivst;
@@ -465,7 +949,15 @@ gem_makeMatch(gemDRep *drep, int bound, gInterp *Interpolate, invEval iEval,
     target[i].st[0]  = 0.0;
     target[i].st[1]  = 0.0;
   }
-  gem_inElem(quilt, iEval, uvq, npts, target, uvs);
+  grid = gem_getUVGrid(&drep->bound[bound-1].VSet[ivsrc-1]);
+  if (grid == NULL) {
+    gem_free(target);
+    gem_free(uvs);
+    gem_free(match);
+    return GEM_ALLOC;
+  }
+  gem_locate(gem_drepThreads(drep), quilt, grid, iEval, uvq, npts, target,
+             uvs);
   gem_free(uvs);
 
   for (i = 0; i < npts; i++) {
@@ -498,6 +990,153 @@ gem_makeMatch(gemDRep *drep, int bound, gInterp *Interpolate, invEval iEval,
 }
 
 
+/*
+ * interpolate at a set of positions -- use the disMethod's batched entry
+ *   point if it exists, otherwise loop over the single element function
+ *   (eIndex <= 0 positions are skipped)
+ */
+static int
+gem_interpBatch(gInterpB batch, gInterp single, gemQuilt *quilt, int geomFlag,
+                int npts, gemTarget *pos, int rank, double *data,
+                double *result)
+{
+  int i, stat;
+  
+  if (batch != NULL)
+    return batch(quilt, geomFlag, npts, pos, rank, data, result);
+  
+  for (i = 0; i < npts; i++) {
+    if (pos[i].eIndex <= 0) continue;
+    stat = single(quilt, geomFlag, pos[i].eIndex, pos[i].st, rank, data,
+                  &result[rank*i]);
+    if (stat != GEM_SUCCESS) return stat;
+  }
+  
+  return GEM_SUCCESS;
+}
+
+
+static int
+gem_interpRange(void *data, int beg, int end)
+{
+  gemInterpRun *run = (gemInterpRun *) data;
+  
+  return gem_interpBatch(run->batch, run->single, run->quilt, run->geomFlag,
+                         end-beg, &run->pos[beg], run->rank, run->data,
+                         &run->result[run->rank*beg]);
+}
+
+
+/*
+ * as gem_interpBatch but with the positions split over threads
+ */
+static int
+gem_interpPar(int nThread, gInterpB batch, gInterp single, gemQuilt *quilt,
+              int geomFlag, int npts, gemTarget *pos, int rank, double *data,
+              double *result)
+{
+  gemInterpRun run;
+  
+  run.batch    = batch;
+  run.single   = single;
+  run.quilt    = quilt;
+  run.geomFlag = geomFlag;
+  run.pos      = pos;
+  run.rank     = rank;
+  run.data     = data;
+  run.result   = result;
+  return gem_threadRun(nThread, npts, gem_interpRange, &run);
+}
+
+
+/*
+ * integrate a set of elements (eIndices NULL -> all elements in order)
+ */
+static int
+gem_integrBatch(gIntegrB batch, gIntegr single, gemQuilt *quilt, int geomFlag,
+                int nelem, /*@null@*/ int *eIndices, int rank, double *data,
+                double *result)
+{
+  int i, stat;
+  
+  if (batch != NULL)
+    return batch(quilt, geomFlag, nelem, eIndices, rank, data, result);
+  
+  for (i = 0; i < nelem; i++) {
+    stat = single(quilt, geomFlag, eIndices == NULL ? i+1 : eIndices[i], rank,
+                  data, &result[rank*i]);
+    if (stat != GEM_SUCCESS) return stat;
+  }
+  
+  return GEM_SUCCESS;
+}
+
+
+/*
+ * set up the fixed parts of the fit -- the source data does not change
+ *   during the optimization, so its integral and its values at the
+ *   MatchPoints are computed once (all ranks) along with the workspace --
+ *   all taken from the scratch arena of the transfer
+ */
+static int
+gem_setupCFit(gemCFit *cfit, int npts, gemArena *scratch)
+{
+  int       i, j, k, nelem, stat;
+  size_t    mark;
+  gemTarget *pos;
+  
+  nelem = cfit->src->nElems;
+  if (cfit->tgt->nElems > nelem) nelem = cfit->tgt->nElems;
+  if (nelem < 1) nelem = 1;
+  cfit->work    = (double *) gem_arenaAlloc(scratch,
+                                            nelem*cfit->nrank*sizeof(double));
+  cfit->res_bar = (double *) gem_arenaAlloc(scratch,
+                                            cfit->nrank*sizeof(double));
+  cfit->dat_bar = (double *) gem_arenaAlloc(scratch,
+                                       (npts+1)*cfit->nrank*sizeof(double));
+  cfit->fsrc    = (double *) gem_arenaAlloc(scratch,
+                                  (cfit->nmat+1)*cfit->nrank*sizeof(double));
+  cfit->ftgt    = (double *) gem_arenaAlloc(scratch,
+                                            (cfit->nmat+1)*sizeof(double));
+  cfit->asrc    = (double *) gem_arenaAlloc(scratch,
+                                            cfit->nrank*sizeof(double));
+  mark          = gem_arenaMark(scratch);
+  pos           = (gemTarget *) gem_arenaAlloc(scratch,
+                                          (cfit->nmat+1)*sizeof(gemTarget));
+  if ((cfit->work == NULL) || (cfit->res_bar == NULL) ||
+      (cfit->dat_bar == NULL) || (cfit->fsrc == NULL) ||
+      (cfit->ftgt == NULL) || (cfit->asrc == NULL) || (pos == NULL))
+    return GEM_ALLOC;
+  
+  /* the source integral */
+  stat = gem_integrBatch(cfit->IntegrBatch[cfit->sindx],
+                         cfit->Integrate[cfit->sindx], cfit->src, cfit->geomFs,
+                         cfit->src->nElems, NULL, cfit->nrank, cfit->data_src,
+                         cfit->work);
+  if (stat != GEM_SUCCESS) {
+    gem_arenaRelease(scratch, mark);
+    return stat;
+  }
+  for (k = 0; k < cfit->nrank; k++) cfit->asrc[k] = 0.0;
+  for (j = 0; j < cfit->src->nElems; j++)
+    for (k = 0; k < cfit->nrank; k++)
+      cfit->asrc[k] += cfit->work[cfit->nrank*j+k];
+  
+  /* the source at the MatchPoints */
+  for (i = 0; i < cfit->nmat; i++) {
+    pos[i] = cfit->mat[i].source;
+    if (cfit->mat[i].target.eIndex == 0) pos[i].eIndex = 0;
+  }
+  stat = gem_interpBatch(cfit->InterpBatch[cfit->sindx],
+                         cfit->Interpolate[cfit->sindx], cfit->src,
+                         cfit->geomFs, cfit->nmat, pos, cfit->nrank,
+                         cfit->data_src, cfit->fsrc);
+  gem_arenaRelease(scratch, mark);
+  
+  return stat;
+}
+
+
 /*
  * obj_bar: compute objective function and gradient via backward differentiation
  */
@@ -510,48 +1149,39 @@ obj_bar(int    n,                     /* (in)  number of design variables */
 {
   int     status = GEM_SUCCESS;       /* (out) return status */
   
-  int     idat, ielms, ielmt, imat, irank, jrank, nrank, sindx, tindx, gfs, gft;
+  int     idat, ielms, ielmt, imat, irank, jrank, nrank, tindx, gft;
   double  f_src, f_tgt;
   double  area_src, area_tgt, area_tgt_bar, obj_bar1;
-  double  *result, *result_bar = NULL, *data_bar = NULL;
+  double  *result, *result_bar, *data_bar;
   gemCFit *cfit = (gemCFit *) blind;
   
   irank  = cfit->irank;
   nrank  = cfit->nrank;
-  sindx  = cfit->sindx;
   tindx  = cfit->tindx;
-  gfs    = cfit->geomFs;
   gft    = cfit->geomFt;
-
-  result = (double *) gem_allocate(nrank*sizeof(double));
-  if (result == NULL) return GEM_ALLOC;
+  
+  /* workspace from gem_setupCFit */
+  result     = cfit->work;
+  result_bar = cfit->res_bar;
+  data_bar   = cfit->dat_bar;
   
   /* store ftgt into tgt structure */
   for (idat = 0; idat < n; idat++)
     cfit->data_tgt[nrank*idat+irank] = ftgt[idat];
   
-  /* compute the area for src */
-  area_src = 0.0;
-  
-  for (ielms = 0; ielms < cfit->src->nElems; ielms++) {
-    status = cfit->Integrate[sindx](cfit->src, gfs, ielms+1, nrank,
-                                    cfit->data_src, result);
-    if (status != GEM_SUCCESS) goto cleanup;
-    
-    area_src += result[irank];
-  }
+  /* the area for src is fixed */
+  area_src       = cfit->asrc[irank];
   cfit->area_src = area_src;
   
   /* compute the area for tgt */
   area_tgt = 0.0;
   
-  for (ielmt = 0; ielmt < cfit->tgt->nElems; ielmt++) {
-    status = cfit->Integrate[tindx](cfit->tgt, gft, ielmt+1, nrank,
-                                    cfit->data_tgt, result);
-    if (status != GEM_SUCCESS) goto cleanup;
-    
-    area_tgt += result[irank];
-  }
+  status = gem_integrBatch(cfit->IntegrBatch[tindx], cfit->Integrate[tindx],
+                           cfit->tgt, gft, cfit->tgt->nElems, NULL, nrank,
+                           cfit->data_tgt, result);
+  if (status != GEM_SUCCESS) return status;
+  for (ielmt = 0; ielmt < cfit->tgt->nElems; ielmt++)
+    area_tgt += result[nrank*ielmt+irank];
   cfit->area_tgt = area_tgt;
   
   /* penalty function part of objective function */
@@ -562,34 +1192,20 @@ obj_bar(int    n,                     /* (in)  number of design variables */
     ielms  = cfit->mat[imat].source.eIndex;
     ielmt  = cfit->mat[imat].target.eIndex;
     if ((ielms == 0) || (ielmt == 0)) continue;
-    status = cfit->Interpolate[sindx](cfit->src, gfs, ielms,
-                                      cfit->mat[imat].source.st,
-                                      nrank, cfit->data_src, result);
-    if (status != GEM_SUCCESS) goto cleanup;
-    f_src  = result[irank];
+    f_src  = cfit->fsrc[nrank*imat+irank];
     
     status = cfit->Interpolate[tindx](cfit->tgt, gft, ielmt,
                                       cfit->mat[imat].target.st,
                                       nrank, cfit->data_tgt, result);
-    if (status != GEM_SUCCESS) goto cleanup;
+    if (status != GEM_SUCCESS) return status;
     f_tgt  = result[irank];
+    cfit->ftgt[imat] = f_tgt;
     
     *obj  += pow(f_tgt-f_src, 2);
   }
   
   /* if we do not need gradient, return now */
-  if (ftgt_bar == NULL) goto cleanup;
-  
-  result_bar = (double *) gem_allocate(nrank*sizeof(double));
-  if (result_bar == NULL) {
-    status = GEM_ALLOC;
-    goto cleanup;
-  }
-  data_bar = (double *) gem_allocate(nrank*n*sizeof(double));
-  if (data_bar == NULL) {
-    status = GEM_ALLOC;
-    goto cleanup;
-  }
+  if (ftgt_bar == NULL) return status;
 
   /* initialize the derivatives */
   obj_bar1  = 1.0;
@@ -600,22 +1216,13 @@ obj_bar(int    n,                     /* (in)  number of design variables */
   }
   
   /* backward: minimize the difference between the source and target
-   at the Match points */
+   at the Match points (values kept from the forward sweep) */
   for (imat = cfit->nmat-1; imat >= 0; imat--) {
     ielms  = cfit->mat[imat].source.eIndex;
     ielmt  = cfit->mat[imat].target.eIndex;
     if ((ielms == 0) || (ielmt == 0)) continue;
-    status = cfit->Interpolate[sindx](cfit->src, gfs, ielms,
-                                      cfit->mat[imat].source.st,
-                                      nrank, cfit->data_src, result);
-    if (status != GEM_SUCCESS) goto cleanup;
-    f_src  = result[irank];
-    
-    status = cfit->Interpolate[tindx](cfit->tgt, gft, ielmt,
-                                      cfit->mat[imat].target.st,
-                                      nrank, cfit->data_tgt, result);
-    if (status != GEM_SUCCESS) goto cleanup;
-    f_tgt  = result[irank];
+    f_src  = cfit->fsrc[nrank*imat+irank];
+    f_tgt  = cfit->ftgt[imat];
     
 /*  *obj += pow(f_tgt-f_src, 2);  */
     result_bar[irank] = (f_tgt - f_src) * 2 * obj_bar1;
@@ -623,7 +1230,7 @@ obj_bar(int    n,                     /* (in)  number of design variables */
     status = cfit->Interpol_bar[tindx](cfit->tgt, gft, ielmt,
                                        cfit->mat[imat].target.st,
                                        nrank, result_bar, data_bar);
-    if (status != GEM_SUCCESS) goto cleanup;
+    if (status != GEM_SUCCESS) return status;
   }
   
   /* backward: penalty function part of objective function
@@ -636,17 +1243,303 @@ obj_bar(int    n,                     /* (in)  number of design variables */
   for (ielmt = cfit->tgt->nElems-1; ielmt >= 0; ielmt--) {
     status = cfit->Integr_bar[tindx](cfit->tgt, gft, ielmt+1, nrank, result_bar,
                                      data_bar);
-    if (status != GEM_SUCCESS) goto cleanup;
+    if (status != GEM_SUCCESS) return status;
   }
 
   for (idat = 0; idat < n; idat++)
     ftgt_bar[idat] = data_bar[nrank*idat+irank];
   
+  return status;
+}
+
+
+static int
+gem_cmpTrip(const void *a, const void *b)
+{
+  const gemTrip *ta = (const gemTrip *) a;
+  const gemTrip *tb = (const gemTrip *) b;
+  
+  if (ta->row != tb->row) return ta->row - tb->row;
+  return ta->col - tb->col;
+}
+
+
+void
+gem_freeCSys(gemCSys *csys)
+{
+  if (csys->imat != NULL) gem_free(csys->imat);
+  if (csys->wptr != NULL) gem_free(csys->wptr);
+  if (csys->wcol != NULL) gem_free(csys->wcol);
+  if (csys->wval != NULL) gem_free(csys->wval);
+  if (csys->sptr != NULL) gem_free(csys->sptr);
+  if (csys->scol != NULL) gem_free(csys->scol);
+  if (csys->sval != NULL) gem_free(csys->sval);
+  if (csys->pin  != NULL) gem_free(csys->pin);
+  if (csys->area != NULL) gem_free(csys->area);
+  if (csys->y    != NULL) gem_free(csys->y);
+  gem_free(csys);
+}
+
+
+/*
+ * assemble the normal equations of the MatchPoint residuals for the target
+ *   -- the area penalty (a rank one term) is applied in gem_conserve
+ */
+static int
+gem_makeCSys(gemQuilt *tgt, int gft, int tindx, int nmat, gemMatch *mat,
+             bInterp *Interpol_bar, bIntegr *Integr_bar, gemCSys **csys)
+{
+  int     i, j, k, m, n, ie, it, ir, idx, nrow, nw, nt, len, stat, *list;
+  double  one = 1.0, *scratch = NULL;
+  gemTrip *trip = NULL;
+  gemCSys *sys;
+  
+  *csys = NULL;
+  n     = tgt->nVerts;
+  sys   = (gemCSys *) gem_allocate(sizeof(gemCSys));
+  if (sys == NULL) return GEM_ALLOC;
+  sys->n    = n;
+  sys->nrow = 0;
+  sys->imat = NULL;
+  sys->wptr = NULL;
+  sys->wcol = NULL;
+  sys->wval = NULL;
+  sys->sptr = NULL;
+  sys->scol = NULL;
+  sys->sval = NULL;
+  sys->pin  = NULL;
+  sys->area = NULL;
+  sys->y    = NULL;
+  sys->ay   = 0.0;
+  
+  /* count the active rows and bound their lengths */
+  for (nrow = nw = m = 0; m < nmat; m++) {
+    if ((mat[m].source.eIndex == 0) || (mat[m].target.eIndex == 0)) continue;
+    it  = tgt->elems[mat[m].target.eIndex-1].tIndex - 1;
+    nw += tgt->types[it].nref + tgt->types[it].ndata;
+    nrow++;
+  }
+  
+  stat = GEM_ALLOC;
+  sys->imat = (int *)    gem_allocate((nrow+1)*sizeof(int));
+  sys->wptr = (int *)    gem_allocate((nrow+1)*sizeof(int));
+  sys->wcol = (int *)    gem_allocate((nw+1)*sizeof(int));
+  sys->wval = (double *) gem_allocate((nw+1)*sizeof(double));
+  sys->sptr = (int *)    gem_allocate((n+1)*sizeof(int));
+  sys->pin  = (int *)    gem_allocate((n+1)*sizeof(int));
+  sys->area = (double *) gem_allocate((n+1)*sizeof(double));
+  sys->y    = (double *) gem_allocate((n+1)*sizeof(double));
+  scratch   = (double *) gem_allocate((n+1)*sizeof(double));
+  if ((sys->imat == NULL) || (sys->wptr == NULL) || (sys->wcol == NULL) ||
+      (sys->wval == NULL) || (sys->sptr == NULL) || (sys->pin  == NULL) ||
+      (sys->area == NULL) || (sys->y    == NULL) || (scratch   == NULL))
+    goto cleanup;
+  for (i = 0; i < n; i++) {
+    sys->pin[i]  = 0;
+    sys->area[i] = sys->y[i] = scratch[i] = 0.0;
+  }
+  
+  /* interpolation weights at the MatchPoints -- the nonzeros are picked up
+     from the element's reference indices */
+  sys->wptr[0] = 0;
+  for (nrow = nw = m = 0; m < nmat; m++) {
+    if ((mat[m].source.eIndex == 0) || (mat[m].target.eIndex == 0)) continue;
+    ie   = mat[m].target.eIndex;
+    stat = Interpol_bar[tindx](tgt, gft, ie, mat[m].target.st, 1, &one,
+                               scratch);
+    if (stat != GEM_SUCCESS) goto cleanup;
+    it = tgt->elems[ie-1].tIndex - 1;
+    for (k = 0; k < 2; k++) {
+      if (k == 0) {
+        list = tgt->elems[ie-1].gIndices;
+        len  = tgt->types[it].nref;
+      } else {
+        list = tgt->elems[ie-1].dIndices;
+        len  = tgt->types[it].ndata;
+      }
+      if (list == NULL) continue;
+      for (i = 0; i < len; i++) {
+        idx = list[i] - 1;
+        if ((idx < 0) || (idx >= n)) continue;
+        if (scratch[idx] == 0.0) continue;
+        sys->wcol[nw] = idx;
+        sys->wval[nw] = scratch[idx];
+        scratch[idx]  = 0.0;
+        nw++;
+      }
+    }
+    sys->imat[nrow] = m;
+    nrow++;
+    sys->wptr[nrow] = nw;
+  }
+  sys->nrow = nrow;
+  
+  /* derivative of the target integral w.r.t. the data */
+  for (ie = 1; ie <= tgt->nElems; ie++) {
+    stat = Integr_bar[tindx](tgt, gft, ie, 1, &one, sys->area);
+    if (stat != GEM_SUCCESS) goto cleanup;
+  }
+  
+  /* W^T W as triplets (with every diagonal present) */
+  for (nt = n, ir = 0; ir < nrow; ir++) {
+    len = sys->wptr[ir+1] - sys->wptr[ir];
+    nt += len*len;
+  }
+  stat = GEM_ALLOC;
+  trip = (gemTrip *) gem_allocate(nt*sizeof(gemTrip));
+  if (trip == NULL) goto cleanup;
+  for (i = 0; i < n; i++) {
+    trip[i].row = trip[i].col = i;
+    trip[i].val = 0.0;
+  }
+  for (k = n, ir = 0; ir < nrow; ir++)
+    for (i = sys->wptr[ir]; i < sys->wptr[ir+1]; i++)
+      for (j = sys->wptr[ir]; j < sys->wptr[ir+1]; j++, k++) {
+        trip[k].row = sys->wcol[i];
+        trip[k].col = sys->wcol[j];
+        trip[k].val = sys->wval[i]*sys->wval[j];
+      }
+  qsort(trip, nt, sizeof(gemTrip), gem_cmpTrip);
+  for (j = i = 0; i < nt; i++)
+    if ((j > 0) && (trip[j-1].row == trip[i].row) &&
+                   (trip[j-1].col == trip[i].col)) {
+      trip[j-1].val += trip[i].val;
+    } else {
+      trip[j] = trip[i];
+      j++;
+    }
+  nt = j;
+  
+  sys->scol = (int *)    gem_allocate(nt*sizeof(int));
+  sys->sval = (double *) gem_allocate(nt*sizeof(double));
+  if ((sys->scol == NULL) || (sys->sval == NULL)) goto cleanup;
+  for (i = 0; i <= n; i++) sys->sptr[i] = 0;
+  for (k = 0; k < nt; k++) {
+    sys->sptr[trip[k].row+1]++;
+    sys->scol[k] = trip[k].col;
+    sys->sval[k] = trip[k].val;
+  }
+  for (i = 0; i < n; i++) sys->sptr[i+1] += sys->sptr[i];
+  
+  /* points that no MatchPoint sees are held at their initial values; a
+     slight diagonal shift keeps the remainder positive definite */
+  for (i = 0; i < n; i++)
+    for (k = sys->sptr[i]; k < sys->sptr[i+1]; k++) {
+      if (sys->scol[k] != i) continue;
+      if (sys->sval[k] <= 0.0) {
+        sys->pin[i]  = 1;
+        sys->sval[k] = 1.0;
+      } else {
+        sys->sval[k] *= 1.0 + 1.e-8;
+      }
+    }
+  
+  /* the penalty direction does not depend on the data -- solve it once */
+  for (i = 0; i < n; i++) scratch[i] = (sys->pin[i] == 1) ? 0.0 : sys->area[i];
+  stat = gem_solveSPD(n, 1, sys->sptr, sys->scol, sys->sval, scratch, sys->y,
+                      1.e-12, 2*n+100, NULL);
+  if (stat != GEM_SUCCESS) goto cleanup;
+  for (i = 0; i < n; i++) sys->ay += scratch[i]*sys->y[i];
+  
+  *csys = sys;
+  sys   = NULL;
+  
+cleanup:
+  if (trip    != NULL) gem_free(trip);
+  if (scratch != NULL) gem_free(scratch);
+  if (sys     != NULL) gem_freeCSys(sys);
+  return stat;
+}
+
+
+/*
+ * conservative fit via the assembled system -- minimizes
+ *        |W f - b|^2 + afact (a.f - area_src)^2
+ *   for all ranks at once; the rank one penalty is applied after the sparse
+ *   solve (Sherman-Morrison). finit holds the initial values at the targets.
+ */
+static int
+gem_conserve(gemCSys *sys, gemCFit *fit, double *finit, gemArena *scratch)
+{
+  int       i, j, k, ir, n, nrank, sindx, nsrc, stat;
+  size_t    mark;
+  double    *bsrc, *rhs, *sum, *x, c, ax, fact;
+  gemTarget *pos;
+  
+  n     = sys->n;
+  nrank = fit->nrank;
+  sindx = fit->sindx;
+  nsrc  = fit->src->nElems;
+  x     = fit->data_tgt;
+  
+  stat = GEM_ALLOC;
+  mark = gem_arenaMark(scratch);
+  pos  = (gemTarget *) gem_arenaAlloc(scratch,
+                                      (sys->nrow+1)*sizeof(gemTarget));
+  j    = sys->nrow;
+  if (nsrc > j) j = nsrc;
+  bsrc = (double *) gem_arenaAlloc(scratch, (j+1)*nrank*sizeof(double));
+  rhs  = (double *) gem_arenaAlloc(scratch, (n+1)*nrank*sizeof(double));
+  sum  = (double *) gem_arenaAlloc(scratch, nrank*sizeof(double));
+  if ((pos == NULL) || (bsrc == NULL) || (rhs == NULL) || (sum == NULL))
+    goto cleanup;
+  
+  /* integral of the source */
+  stat = gem_integrBatch(fit->IntegrBatch[sindx], fit->Integrate[sindx],
+                         fit->src, fit->geomFs, nsrc, NULL, nrank,
+                         fit->data_src, bsrc);
+  if (stat != GEM_SUCCESS) goto cleanup;
+  for (k = 0; k < nrank; k++) sum[k] = 0.0;
+  for (j = 0; j < nsrc; j++)
+    for (k = 0; k < nrank; k++) sum[k] += bsrc[nrank*j+k];
+  
+  /* source values at the MatchPoints */
+  for (ir = 0; ir < sys->nrow; ir++) pos[ir] = fit->mat[sys->imat[ir]].source;
+  stat = gem_interpBatch(fit->InterpBatch[sindx], fit->Interpolate[sindx],
+                         fit->src, fit->geomFs, sys->nrow, pos, nrank,
+                         fit->data_src, bsrc);
+  if (stat != GEM_SUCCESS) goto cleanup;
+  
+  /* right hand sides: W^T b, or the initial value where pinned */
+  for (i = 0; i < n*nrank; i++) rhs[i] = 0.0;
+  for (ir = 0; ir < sys->nrow; ir++)
+    for (j = sys->wptr[ir]; j < sys->wptr[ir+1]; j++)
+      for (k = 0; k < nrank; k++)
+        rhs[nrank*sys->wcol[j]+k] += sys->wval[j]*bsrc[nrank*ir+k];
+  for (i = 0; i < n; i++) {
+    for (k = 0; k < nrank; k++) x[nrank*i+k] = finit[nrank*i+k];
+    if (sys->pin[i] == 0) continue;
+    for (k = 0; k < nrank; k++) rhs[nrank*i+k] = finit[nrank*i+k];
+  }
+  
+  stat = gem_solveSPD(n, nrank, sys->sptr, sys->scol, sys->sval, rhs, x,
+                      1.e-12, 2*n+100, NULL);
+  if (stat != GEM_SUCCESS) goto cleanup;
+  
+  /* fold in the area penalty */
+  for (k = 0; k < nrank; k++) {
+    c = sum[k];
+    for (ax = 0.0, i = 0; i < n; i++)
+      if (sys->pin[i] == 1) {
+        c  -= sys->area[i]*x[nrank*i+k];
+      } else {
+        ax += sys->area[i]*x[nrank*i+k];
+      }
+    fact = fit->afact*(c - ax)/(1.0 + fit->afact*sys->ay);
+    for (i = 0; i < n; i++) x[nrank*i+k] += fact*sys->y[i];
+    
+    fit->area_src = sum[k];
+    for (fit->area_tgt = 0.0, i = 0; i < n; i++)
+      fit->area_tgt += sys->area[i]*x[nrank*i+k];
+#ifdef DEBUG
+    printf("  Rank = %d:  integrated src = %le,  tgt = %le\n", k,
+           fit->area_src, fit->area_tgt);
+#endif
+  }
+  
 cleanup:
-  if (data_bar   != NULL) gem_free(data_bar);
-  if (result_bar != NULL) gem_free(result_bar);
-  gem_free(result);
-  return(status);
+  gem_arenaRelease(scratch, mark);
+  return stat;
 }
 
 
@@ -654,17 +1547,19 @@ int
 gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
                  int method, int *iset, gInterp *Interpolate,
                  bInterp *Interpol_bar, gIntegr *Integrate, bIntegr *Integr_bar,
-                 invEval *iEval)
+                 gInterpB *InterpBatch, gIntegrB *IntegrBatch, invEval *iEval)
 {
-  int      i, j, nrank, npts, mindx, stat, eIndex, gflgs, gflgt;
+  int      i, j, nrank, npts, mindx, stat, eIndex, gflgs, gflgt, nThread;
   char     *name;
-  double   *data, *sdata, *ftgt, st[2], fopt;
+  double   *data, *sdata, *ftgt, *finit, fopt;
   gemQuilt *quilt;
   gemDSet  *sets;
   gemXfer  *xfer, *last;
   gemCFit  fit;
   FILE     *fp;
 
+  nThread = gem_drepThreads(drep);
+
   /* get source information*/
   if (drep->bound[bound-1].VSet[ivsrc-1].disMethod == NULL)
     return GEM_NOTCONNECT;
@@ -704,6 +1599,9 @@ gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
     xfer->nMatch     = 0;
     xfer->position   = NULL;
     xfer->match      = NULL;
+    xfer->csys       = NULL;
+    xfer->cstat      = GEM_SUCCESS;
+    xfer->scratch    = NULL;
     xfer->next       = NULL;
     if (last == NULL) {
       drep->bound[bound-1].xferList = xfer;
@@ -728,6 +1626,14 @@ gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
       stat = gem_getPositions(drep, bound, iEval[mindx], xfer);
   }
   if (stat != GEM_SUCCESS) return stat;
+  
+  /* the scratch of the last transfer is reused from its start */
+  if (xfer->scratch == NULL) {
+    xfer->scratch = (gemArena *) gem_allocate(sizeof(gemArena));
+    if (xfer->scratch == NULL) return GEM_ALLOC;
+    gem_arenaInit(xfer->scratch);
+  }
+  gem_arenaRelease(xfer->scratch, 0);
 
   /* create storage for the new DataSet */
   name = gem_strdup(name);
@@ -749,18 +1655,13 @@ gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
 
     if (method == GEM_INTERP) {
       
-      for (i = 0; i < npts; i++) {
-        eIndex = xfer->position[i].eIndex;
-        if (eIndex == 0) continue;
-        st[0]  = xfer->position[i].st[0];
-        st[1]  = xfer->position[i].st[1];
-        stat   = Interpolate[mindx](quilt, gflgs, eIndex, st, nrank, data,
-                                    &sdata[nrank*i]);
-        if (stat != GEM_SUCCESS) {
-          gem_free(sdata);
-          gem_free(name);
-          return stat;
-        }
+      stat = gem_interpPar(nThread, InterpBatch[mindx], Interpolate[mindx],
+                           quilt, gflgs, npts, xfer->position, nrank, data,
+                           sdata);
+      if (stat != GEM_SUCCESS) {
+        gem_free(sdata);
+        gem_free(name);
+        return stat;
       }
       
     } else {
@@ -791,10 +1692,42 @@ gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
       fit.Interpol_bar = Interpol_bar;
       fit.Integrate    = Integrate;
       fit.Integr_bar   = Integr_bar;
+      fit.InterpBatch  = InterpBatch;
+      fit.IntegrBatch  = IntegrBatch;
       
       /* set up vectors for optimizer's dependent variables */
-      ftgt = (double *) gem_allocate((npts+nrank)*sizeof(double));
+      ftgt = (double *) gem_arenaAlloc(xfer->scratch,
+                                       (npts+npts*nrank)*sizeof(double));
       if (ftgt == NULL) {
+        gem_free(sdata);
+        gem_free(name);
+        return GEM_ALLOC;
+      }
+      finit = &ftgt[npts];
+      for (j = 0; j < npts+npts*nrank; j++) ftgt[j] = 0.0;
+      
+      /* initial values at the target nodes -- all ranks at once */
+      stat = gem_interpPar(nThread, InterpBatch[mindx], Interpolate[mindx],
+                           quilt, gflgt, npts, xfer->position, nrank, data,
+                           finit);
+      if (stat != GEM_SUCCESS) {
+        gem_free(sdata);
+        gem_free(name);
+        return stat;
+      }
+      
+      /* the objective is quadratic -- solve the assembled system directly
+         (kept with the transfer structure for subsequent transfers, as is
+          a failure to build it so that is not repeated each time) */
+      stat = xfer->cstat;
+      if ((xfer->csys == NULL) && (stat == GEM_SUCCESS)) {
+        stat = gem_makeCSys(fit.tgt, gflgt, fit.tindx, xfer->nMatch,
+                            xfer->match, Interpol_bar, Integr_bar, &xfer->csys);
+        if (stat != GEM_ALLOC) xfer->cstat = stat;
+      }
+      if (stat == GEM_SUCCESS) stat = gem_conserve(xfer->csys, &fit, finit,
+                                                   xfer->scratch);
+      if (stat == GEM_ALLOC) {
         gem_free(sdata);
         gem_free(name);
         return stat;
@@ -805,33 +1738,25 @@ gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
       fp = stdout;
 #endif
       
-      /* perform optimization (with area penalty function) */
-      for (i = 0; i < nrank; i++) {
-        fit.irank = i;
-        /* initialize the dependent variables at the target nodes */
-        for (j = 0; j < npts; j++) {
-          eIndex = xfer->position[j].eIndex;
-          if (eIndex == 0) continue;
-          st[0]  = xfer->position[j].st[0];
-          st[1]  = xfer->position[j].st[1];
-          stat   = Interpolate[mindx](quilt, gflgt, eIndex, st, nrank, data,
-                                      &ftgt[npts]);
-          if (stat != GEM_SUCCESS) {
-            gem_free(ftgt);
-            gem_free(sdata);
-            gem_free(name);
-            return stat;
-          }
-          ftgt[j] = ftgt[npts+i];
-        }
-        stat = gem_conjGrad(obj_bar, &fit, npts, ftgt, 1e-6, fp, &fopt);
-        if (stat != GEM_SUCCESS) break;
+      /* otherwise perform optimization (with area penalty function) */
+      if (stat != GEM_SUCCESS) {
+        stat = gem_setupCFit(&fit, npts, xfer->scratch);
+        if (stat == GEM_SUCCESS)
+          for (i = 0; i < nrank; i++) {
+            fit.irank = i;
+            /* initialize the dependent variables at the target nodes */
+            for (j = 0; j < npts; j++) {
+              if (xfer->position[j].eIndex <= 0) continue;
+              ftgt[j] = finit[nrank*j+i];
+            }
+            stat = gem_conjGrad(obj_bar, &fit, npts, ftgt, 1e-6, fp, &fopt);
+            if (stat != GEM_SUCCESS) break;
 //#ifdef DEBUG
-        printf("  Rank = %d:  integrated src = %le,  tgt = %le\n", i,
-               fit.area_src, fit.area_tgt);
+            printf("  Rank = %d:  integrated src = %le,  tgt = %le\n", i,
+                   fit.area_src, fit.area_tgt);
 //#endif
+          }
       }
-      gem_free(ftgt);
       if (stat != GEM_SUCCESS) {
         gem_free(sdata);
         gem_free(name);
@@ -846,21 +1771,16 @@ gem_dataTransfer(gemDRep *drep, int bound, int ivsrc, int issrc, int vs,
     
     for (i = 0; i < npts; i++) {
       eIndex = xfer->position[i].eIndex;
-      if (eIndex == 0) continue;
-      st[0]  = xfer->position[i].st[0];
-      st[1]  = xfer->position[i].st[1];
-      if (eIndex <= 0) {
-        printf(" dataTransfer: eIndex = %d for point %d %d\n",
-               eIndex, i+1, npts);
-        continue;
-      }
-      stat = Interpolate[mindx](quilt, gflgs, eIndex, st, nrank, data,
-                                &sdata[nrank*i]);
-      if (stat != GEM_SUCCESS) {
-        gem_free(sdata);
-        gem_free(name);
-        return stat;
-      }
+      if (eIndex >= 0) continue;
+      printf(" dataTransfer: eIndex = %d for point %d %d\n",
+             eIndex, i+1, npts);
+    }
+    stat = gem_interpPar(nThread, InterpBatch[mindx], Interpolate[mindx],
+                         quilt, gflgs, npts, xfer->position, nrank, data, sdata);
+    if (stat != GEM_SUCCESS) {
+      gem_free(sdata);
+      gem_free(name);
+      return stat;
     }
 
   }
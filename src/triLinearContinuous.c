@@ -357,21 +357,22 @@ gemIntegration(gemQuilt *quilt,       /* (in)  the quilt to integrate upon */
                double   data[],       /* (in)  values (rank*npts in length) */
                double   result[])     /* (out) integrated result - (rank) */
 {
-  int    i, in[3];
-  double x1[3], x2[3], x3[3], area;
+  int    i, in[3], *conn;
+  double x1[3], x2[3], x3[3], area, *xyz = quilt->packed->xyz;
 
   /* element indices */
 
-  in[0] = quilt->elems[eIndex-1].gIndices[0] - 1;
-  in[1] = quilt->elems[eIndex-1].gIndices[1] - 1;
-  in[2] = quilt->elems[eIndex-1].gIndices[2] - 1;
+  conn  = &quilt->packed->conn[quilt->packed->eptr[eIndex-1]];
+  in[0] = conn[0];
+  in[1] = conn[1];
+  in[2] = conn[2];
   
-  x1[0] = quilt->points[in[1]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x2[0] = quilt->points[in[2]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x1[1] = quilt->points[in[1]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x2[1] = quilt->points[in[2]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x1[2] = quilt->points[in[1]].xyz[2] - quilt->points[in[0]].xyz[2];
-  x2[2] = quilt->points[in[2]].xyz[2] - quilt->points[in[0]].xyz[2];
+  x1[0] = xyz[3*in[1]  ] - xyz[3*in[0]  ];
+  x2[0] = xyz[3*in[2]  ] - xyz[3*in[0]  ];
+  x1[1] = xyz[3*in[1]+1] - xyz[3*in[0]+1];
+  x2[1] = xyz[3*in[2]+1] - xyz[3*in[0]+1];
+  x1[2] = xyz[3*in[1]+2] - xyz[3*in[0]+2];
+  x2[2] = xyz[3*in[2]+2] - xyz[3*in[0]+2];
   CROSS(x3, x1, x2);
   area  = sqrt(DOT(x3, x3))/6.0;      /* 1/2 for area and then 1/3 for sum */
 
@@ -394,21 +395,22 @@ gemIntegrate_bar(gemQuilt *quilt,     /* (in)   the quilt to integrate upon */
                  double   dat_bar[])  /* (both) d(objective)/d(data)
                                                 (rank*npts in len) */
 {
-  int    i, in[3];
-  double x1[3], x2[3], x3[3], area;
+  int    i, in[3], *conn;
+  double x1[3], x2[3], x3[3], area, *xyz = quilt->packed->xyz;
   
   /* element indices */
   
-  in[0] = quilt->elems[eIndex-1].gIndices[0] - 1;
-  in[1] = quilt->elems[eIndex-1].gIndices[1] - 1;
-  in[2] = quilt->elems[eIndex-1].gIndices[2] - 1;
+  conn  = &quilt->packed->conn[quilt->packed->eptr[eIndex-1]];
+  in[0] = conn[0];
+  in[1] = conn[1];
+  in[2] = conn[2];
   
-  x1[0] = quilt->points[in[1]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x2[0] = quilt->points[in[2]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x1[1] = quilt->points[in[1]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x2[1] = quilt->points[in[2]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x1[2] = quilt->points[in[1]].xyz[2] - quilt->points[in[0]].xyz[2];
-  x2[2] = quilt->points[in[2]].xyz[2] - quilt->points[in[0]].xyz[2];
+  x1[0] = xyz[3*in[1]  ] - xyz[3*in[0]  ];
+  x2[0] = xyz[3*in[2]  ] - xyz[3*in[0]  ];
+  x1[1] = xyz[3*in[1]+1] - xyz[3*in[0]+1];
+  x2[1] = xyz[3*in[2]+1] - xyz[3*in[0]+1];
+  x1[2] = xyz[3*in[1]+2] - xyz[3*in[0]+2];
+  x2[2] = xyz[3*in[2]+2] - xyz[3*in[0]+2];
   CROSS(x3, x1, x2);
   area  = sqrt(DOT(x3, x3))/6.0;      /* 1/2 for area and then 1/3 for sum */
   
@@ -422,3 +424,84 @@ gemIntegrate_bar(gemQuilt *quilt,     /* (in)   the quilt to integrate upon */
   
   return GEM_SUCCESS;
 }
+
+
+/*
+ * batched versions of the above -- optional, found by the loader if present
+ */
+
+int
+gemInterpolationBatch(gemQuilt  *quilt,  /* (in)  the quilt description */
+                      /*@unused@*/
+                      int       geomFlag,/* (in)  0 - data ref, 1 - geom based */
+                      int       npts,    /* (in)  number of positions */
+                      gemTarget pos[],   /* (in)  element index & ref coords;
+                                                  eIndex <= 0 are skipped */
+                      int       rank,    /* (in)  data depth */
+                      double    data[],  /* (in)  values (rank*npts in length) */
+                      double    result[])/* (out) interpolated result - 
+                                                  (rank*npts in length) */
+{
+  int       j, i, i0, i1, i2, *conn;
+  double    w0, w1, w2;
+  gemPacked *packed = quilt->packed;
+  
+  for (j = 0; j < npts; j++) {
+    if (pos[j].eIndex <= 0) continue;
+    w1 = pos[j].st[0];
+    w2 = pos[j].st[1];
+    w0 = 1.0 - w1 - w2;
+    conn = &packed->conn[packed->eptr[pos[j].eIndex-1]];
+    i0 = rank*conn[0];
+    i1 = rank*conn[1];
+    i2 = rank*conn[2];
+    for (i = 0; i < rank; i++)
+      result[rank*j+i] = data[i0+i]*w0 + data[i1+i]*w1 + data[i2+i]*w2;
+  }
+  
+  return GEM_SUCCESS;
+}
+
+
+int
+gemIntegrationBatch(gemQuilt *quilt,    /* (in)  the quilt to integrate upon */
+                    /*@unused@*/
+                    int      geomFlag,  /* (in)  0 - data ref, 1 - geom based */
+                    int      nelem,     /* (in)  number of elements */
+                    /*@null@*/
+                    int      eIndices[],/* (in)  element indices (bias 1)
+                                                 NULL - 1 to nelem */
+                    int      rank,      /* (in)  data depth */
+                    double   data[],    /* (in)  values (rank*npts in length) */
+                    double   result[])  /* (out) integrated result -
+                                                 (rank*nelem in length) */
+{
+  int       j, i, in[3], *conn;
+  double    x1[3], x2[3], x3[3], area, *xyz;
+  gemPacked *packed = quilt->packed;
+  
+  xyz = packed->xyz;
+  
+  for (j = 0; j < nelem; j++) {
+    i     = (eIndices == NULL) ? j : eIndices[j]-1;
+    conn  = &packed->conn[packed->eptr[i]];
+    in[0] = conn[0];
+    in[1] = conn[1];
+    in[2] = conn[2];
+    
+    x1[0] = xyz[3*in[1]  ] - xyz[3*in[0]  ];
+    x2[0] = xyz[3*in[2]  ] - xyz[3*in[0]  ];
+    x1[1] = xyz[3*in[1]+1] - xyz[3*in[0]+1];
+    x2[1] = xyz[3*in[2]+1] - xyz[3*in[0]+1];
+    x1[2] = xyz[3*in[1]+2] - xyz[3*in[0]+2];
+    x2[2] = xyz[3*in[2]+2] - xyz[3*in[0]+2];
+    CROSS(x3, x1, x2);
+    area  = sqrt(DOT(x3, x3))/6.0;    /* 1/2 for area and then 1/3 for sum */
+    
+    for (i = 0; i < rank; i++)
+      result[rank*j+i] = (data[rank*in[0]+i] + data[rank*in[1]+i] +
+                          data[rank*in[2]+i])*area;
+  }
+  
+  return GEM_SUCCESS;
+}
@@ -423,21 +423,22 @@ gemIntegration(gemQuilt *quilt,       /* (in)  the quilt to integrate upon */
                double   data[],       /* (in)  values (rank*npts in length) */
                double   result[])     /* (out) integrated result - (rank) */
 {
-  int    i, in[3];
-  double x1[3], x2[3], x3[3], area;
+  int    i, in[3], *conn;
+  double x1[3], x2[3], x3[3], area, *xyz = quilt->packed->xyz;
 
   /* element indices */
 
-  in[0] = quilt->elems[eIndex-1].gIndices[0] - 1;
-  in[1] = quilt->elems[eIndex-1].gIndices[1] - 1;
-  in[2] = quilt->elems[eIndex-1].gIndices[2] - 1;
+  conn  = &quilt->packed->conn[quilt->packed->eptr[eIndex-1]];
+  in[0] = conn[0];
+  in[1] = conn[1];
+  in[2] = conn[2];
   
-  x1[0] = quilt->points[in[1]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x2[0] = quilt->points[in[2]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x1[1] = quilt->points[in[1]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x2[1] = quilt->points[in[2]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x1[2] = quilt->points[in[1]].xyz[2] - quilt->points[in[0]].xyz[2];
-  x2[2] = quilt->points[in[2]].xyz[2] - quilt->points[in[0]].xyz[2];
+  x1[0] = xyz[3*in[1]  ] - xyz[3*in[0]  ];
+  x2[0] = xyz[3*in[2]  ] - xyz[3*in[0]  ];
+  x1[1] = xyz[3*in[1]+1] - xyz[3*in[0]+1];
+  x2[1] = xyz[3*in[2]+1] - xyz[3*in[0]+1];
+  x1[2] = xyz[3*in[1]+2] - xyz[3*in[0]+2];
+  x2[2] = xyz[3*in[2]+2] - xyz[3*in[0]+2];
   CROSS(x3, x1, x2);
   area  = sqrt(DOT(x3, x3))/2.0;      /* 1/2 for area */
 
@@ -464,21 +465,22 @@ gemIntegrate_bar(gemQuilt *quilt,     /* (in)   the quilt to integrate upon */
                  double   dat_bar[])  /* (both) d(objective)/d(data)
                                                 (rank*npts in len) */
 {
-  int    i, in[3];
-  double x1[3], x2[3], x3[3], area;
+  int    i, in[3], *conn;
+  double x1[3], x2[3], x3[3], area, *xyz = quilt->packed->xyz;
   
   /* element indices */
   
-  in[0] = quilt->elems[eIndex-1].gIndices[0] - 1;
-  in[1] = quilt->elems[eIndex-1].gIndices[1] - 1;
-  in[2] = quilt->elems[eIndex-1].gIndices[2] - 1;
+  conn  = &quilt->packed->conn[quilt->packed->eptr[eIndex-1]];
+  in[0] = conn[0];
+  in[1] = conn[1];
+  in[2] = conn[2];
   
-  x1[0] = quilt->points[in[1]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x2[0] = quilt->points[in[2]].xyz[0] - quilt->points[in[0]].xyz[0];
-  x1[1] = quilt->points[in[1]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x2[1] = quilt->points[in[2]].xyz[1] - quilt->points[in[0]].xyz[1];
-  x1[2] = quilt->points[in[1]].xyz[2] - quilt->points[in[0]].xyz[2];
-  x2[2] = quilt->points[in[2]].xyz[2] - quilt->points[in[0]].xyz[2];
+  x1[0] = xyz[3*in[1]  ] - xyz[3*in[0]  ];
+  x2[0] = xyz[3*in[2]  ] - xyz[3*in[0]  ];
+  x1[1] = xyz[3*in[1]+1] - xyz[3*in[0]+1];
+  x2[1] = xyz[3*in[2]+1] - xyz[3*in[0]+1];
+  x1[2] = xyz[3*in[1]+2] - xyz[3*in[0]+2];
+  x2[2] = xyz[3*in[2]+2] - xyz[3*in[0]+2];
   CROSS(x3, x1, x2);
   area  = sqrt(DOT(x3, x3))/2.0;      /* 1/2 for area */
   
@@ -175,8 +175,9 @@ gemPatchTessel(const
     if (ifs != NULL)
       for (j = 0; j < drep->TReps[i].nEdges; j++) {
         if (ies[2*j+1] == 0) continue;
-        i0 = ies[2*j  ];
-        i1 = ies[2*j+1];
+        /* merge the current labels -- not the Faces' original ones */
+        i0 = ifs[quilt->bfaces[ies[2*j  ]-1].index-1];
+        i1 = ifs[quilt->bfaces[ies[2*j+1]-1].index-1];
         if (i0 == i1) continue;
         if (i0 >  i1) {
           k  = i0;
@@ -277,6 +278,12 @@ gemPatchTessel(const
   }
   free(ibs);
   
+  /* a point zipped to one that was itself removed (a Node shared by more
+     than 2 Faces) must refer to the one that is kept */
+  for (i = 0; i < npts; i++)
+    if (table[i] < 0)
+      while (table[-table[i]-1] < 0) table[i] = table[-table[i]-1];
+
   /* adjust the point definition to add faceUVs for dups */
   for (i = 0; i < npts; i++)
     if (table[i] < 0) {
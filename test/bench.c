@@ -0,0 +1,367 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             DRep/Transfer Benchmark -- Mock (Analytic) Kernel
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+/*
+ * usage: bench [-s scenario] [-n resolution] [-r repeats] [-t threads]
+ *              [-o file]
+ *
+ *   scenario    plane  -- a single planar Face
+ *               sphere -- a single curved Face with poles
+ *               box    -- 3 Faces of a box in one Bound (multi-face)
+ *               all    -- each of the above (the default)
+ *   resolution  segments along a unit length (default 100) -- the Bound
+ *               holds about 2*res^2 triangles per unit area (the box is
+ *               run at a quarter of this, see cases)
+ *   repeats     number of times each scenario is run (default 3)
+ *   threads     number of threads given to the context (default 1)
+ *
+ * One CSV line is written per phase and repeat:
+ *
+ *   scenario,res,rep,phase,count,seconds,allocs,reallocs,frees,heapPeak,rssPeak
+ *
+ *   count    the size of the phase (triangles or points)
+ *   allocs   GEM allocations, reallocations & frees made in the phase
+ *   heapPeak most bytes held by GEM at once during the phase
+ *   rssPeak  the process' peak resident set size so far (KB)
+ *
+ * GEM writes its own info lines to stdout (e.g. "GEM Info: VSet 1 selected
+ *   for reParam" from gem_paramBound in the box scenario), so without -o the
+ *   CSV goes to stderr. Errors are also written to stderr -- use -o for a
+ *   file that only holds the CSV.
+ *
+ * The transfer plugins allocate some scratch with malloc -- that is only
+ *   seen in rssPeak.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifdef WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif
+
+#include "gem.h"
+
+
+  typedef struct {
+    const char *name;           /* the scenario */
+    const char *location;       /* the mock location */
+    int        nface;           /* the number of Faces in the Bound */
+    double     scale;           /* applied to the resolution */
+  } benchCase;
+
+/* the multi-face parameterization grows much faster than the rest -- its
+ *   resolution is scaled down to keep the runs comparable in length */
+static benchCase cases[3] = { {"plane",  "plane(1,1)",  1, 1.0 },
+                              {"sphere", "sphere(0.5)", 1, 1.0 },
+                              {"box",    "box(1,1,1)",  3, 0.25} };
+
+static FILE      *out;
+static gemCntxt  *context;
+static const char *scenario;
+static int       res, resolution, repeat;
+static double    start;
+
+
+static double
+wallClock()
+{
+#ifdef WIN32
+  LARGE_INTEGER count, freq;
+
+  QueryPerformanceCounter(&count);
+  QueryPerformanceFrequency(&freq);
+  return (double) count.QuadPart / (double) freq.QuadPart;
+#else
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + 1.e-9*ts.tv_nsec;
+#endif
+}
+
+
+static long
+peakRSS()
+{
+#ifdef WIN32
+  PROCESS_MEMORY_COUNTERS pmc;
+
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) == 0)
+    return 0;
+  return (long) (pmc.PeakWorkingSetSize/1024);
+#else
+  struct rusage usage;
+
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss/1024;
+#else
+  return usage.ru_maxrss;
+#endif
+#endif
+}
+
+
+static void
+phaseStart()
+{
+  gemMemStats stats;
+
+  gem_getMemStats(context, 1, &stats);
+  start = wallClock();
+}
+
+
+static void
+phaseEnd(const char *phase, int count)
+{
+  double      secs;
+  gemMemStats stats;
+
+  secs = wallClock() - start;
+  gem_getMemStats(context, 1, &stats);
+  fprintf(out, "%s,%d,%d,%s,%d,%.6f,%lld,%lld,%lld,%lld,%ld\n",
+          scenario, res, repeat, phase, count, secs, stats.nAlloc,
+          stats.nRealloc, stats.nFree, stats.peak, peakRSS());
+  fflush(out);
+}
+
+
+static int
+runCase(benchCase *bc)
+{
+  int      i, j, stat, bound, vsrc, vdst, vun, npts, ntris, rank, nsrc;
+  int      sense, nloop, *loops, nattr;
+  char     *IDs[6];
+  double   uvbox[4], *xyz, *data, *pts;
+  gemModel *model;
+  gemDRep  *drep;
+  gemTRep  *trep;
+
+  phaseStart();
+  stat = gem_loadModel(context, NULL, (char *) bc->location, &model);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_loadModel = %d\n", bc->name, stat);
+    return stat;
+  }
+  phaseEnd("load", model->nBRep);
+
+  stat = gem_newDRep(model, &drep);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_newDRep = %d\n", bc->name, stat);
+    gem_releaseModel(model);
+    return stat;
+  }
+
+  phaseStart();
+  stat = gem_tesselDRep(drep, 0, 0.0, 1.0/res, 0.0);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_tesselDRep = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  trep = &drep->TReps[0];
+  for (ntris = j = 0; j < trep->nFaces; j++) ntris += trep->Faces[j].ntris;
+  phaseEnd("tessel", ntris);
+
+  for (j = 0; j < bc->nface; j++)
+    gem_getFace(model->BReps[0], j+1, &IDs[j], uvbox, &sense, &nloop,
+                &loops, &nattr);
+  stat = gem_createBound(drep, bc->nface, IDs, &bound);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_createBound = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+
+  /* a continuous source & a discontinuous destination */
+  phaseStart();
+  stat = gem_createVset(drep, bound, "triLinearContinuous", &vsrc);
+  if (stat == GEM_SUCCESS)
+    stat = gem_createVset(drep, bound, "triLinearDiscontinuous", &vdst);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_createVset = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  for (ntris = j = 0; j < bc->nface; j++)
+    ntris += trep->Faces[j].ntris;
+  phaseEnd("createVset", ntris);
+
+  phaseStart();
+  stat = gem_paramBound(drep, bound);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_paramBound = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  phaseEnd(bc->nface == 1 ? "paramBound" : "paramBoundMulti", ntris);
+
+  stat = gem_getData(drep, bound, vsrc, "xyz", GEM_INTERP, &nsrc, &rank,
+                     &xyz);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_getData xyz = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  data = (double *) malloc(2*nsrc*sizeof(double));
+  if (data == NULL) {
+    stat = GEM_ALLOC;
+    goto cleanup;
+  }
+  for (i = 0; i < nsrc; i++) {
+    data[2*i  ] = sin(3.0*xyz[3*i]) * cos(2.0*xyz[3*i+1]) + xyz[3*i+2];
+    data[2*i+1] = xyz[3*i] * xyz[3*i+1];
+  }
+
+  /* unconnected points between the source points */
+  phaseStart();
+  pts = (double *) malloc(3*(nsrc-1)*sizeof(double));
+  if (pts == NULL) {
+    free(data);
+    stat = GEM_ALLOC;
+    goto cleanup;
+  }
+  for (i = 0; i < nsrc-1; i++)
+    for (j = 0; j < 3; j++)
+      pts[3*i+j] = 0.5*(xyz[3*i+j] + xyz[3*i+j+3]);
+  stat = gem_makeVset(drep, bound, nsrc-1, pts, &vun);
+  free(pts);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_makeVset = %d\n", bc->name, stat);
+    free(data);
+    goto cleanup;
+  }
+  phaseEnd("makeVset", nsrc-1);
+
+  phaseStart();
+  stat = gem_putData(drep, bound, vsrc, "interp", nsrc, 2, data);
+  if (stat == GEM_SUCCESS)
+    stat = gem_putData(drep, bound, vsrc, "conserve", nsrc, 2, data);
+  free(data);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_putData = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  phaseEnd("putData", nsrc);
+
+  phaseStart();
+  stat = gem_getData(drep, bound, vdst, "interp", GEM_INTERP, &npts, &rank,
+                     &data);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_getData INTERP = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  phaseEnd("getDataInterp", npts);
+
+  phaseStart();
+  stat = gem_getData(drep, bound, vdst, "conserve", GEM_CONSERVE, &npts,
+                     &rank, &data);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_getData CONSERVE = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  phaseEnd("getDataConserve", npts);
+
+  phaseStart();
+  stat = gem_getData(drep, bound, vun, "interp", GEM_INTERP, &npts, &rank,
+                     &data);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " %s: gem_getData unconnected = %d\n", bc->name, stat);
+    goto cleanup;
+  }
+  phaseEnd("getDataUnconn", npts);
+
+cleanup:
+  phaseStart();
+  gem_destroyDRep(drep);
+  gem_releaseModel(model);
+  if (stat == GEM_SUCCESS) phaseEnd("release", 0);
+
+  return stat;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int  i, j, nrep, nThread, stat, nerr = 0;
+  char *name, *file;
+
+  name       = "all";
+  file       = NULL;
+  resolution = 100;
+  nrep       = 3;
+  nThread    = 1;
+  for (i = 1; i < argc-1; i += 2) {
+    if (strcmp(argv[i], "-s") == 0) {
+      name = argv[i+1];
+    } else if (strcmp(argv[i], "-n") == 0) {
+      resolution = atoi(argv[i+1]);
+    } else if (strcmp(argv[i], "-r") == 0) {
+      nrep = atoi(argv[i+1]);
+    } else if (strcmp(argv[i], "-t") == 0) {
+      nThread = atoi(argv[i+1]);
+    } else if (strcmp(argv[i], "-o") == 0) {
+      file = argv[i+1];
+    } else {
+      break;
+    }
+  }
+  if ((i != argc) || (resolution < 1) || (nrep < 1) || (nThread < 1)) {
+    printf(" usage: bench [-s plane|sphere|box|all] [-n resolution]\n");
+    printf("              [-r repeats] [-t threads] [-o file]\n");
+    return 1;
+  }
+  for (j = 0; j < 3; j++)
+    if (strcmp(name, cases[j].name) == 0) break;
+  if ((j == 3) && (strcmp(name, "all") != 0)) {
+    printf(" bench: unknown scenario %s!\n", name);
+    return 1;
+  }
+
+  out = stderr;
+  if (file != NULL) {
+    out = fopen(file, "w");
+    if (out == NULL) {
+      printf(" bench: cannot open %s!\n", file);
+      return 1;
+    }
+  }
+
+  stat = gem_initialize(&context);
+  if (stat != GEM_SUCCESS) {
+    fprintf(stderr, " gem_initialize = %d\n", stat);
+    if (file != NULL) fclose(out);
+    return 1;
+  }
+  gem_setThreads(context, nThread);
+
+  fprintf(out, "scenario,res,rep,phase,count,seconds,allocs,reallocs,frees,");
+  fprintf(out, "heapPeak,rssPeak\n");
+  for (i = 0; i < 3; i++) {
+    if ((j != 3) && (i != j)) continue;
+    scenario = cases[i].name;
+    res      = (int) (cases[i].scale*resolution + 0.5);
+    if (res < 1) res = 1;
+    for (repeat = 1; repeat <= nrep; repeat++)
+      if (runCase(&cases[i]) != GEM_SUCCESS) {
+        nerr++;
+        break;
+      }
+  }
+
+  gem_terminate(context);
+  if (file != NULL) fclose(out);
+  return nerr == 0 ? 0 : 1;
+}
@@ -0,0 +1,27 @@
+#
+!include ..\include\$(GEM_ARCH)
+SDIR = $(MAKEDIR)
+IDIR = $(SDIR)\..\include
+ODIR = $(GEM_BLOC)\obj
+LDIR = $(GEM_BLOC)\lib
+TDIR = $(GEM_BLOC)\test
+
+default:	start $(TDIR)\bench.exe end
+
+start:
+	cd $(ODIR)
+	copy $(SDIR)\bench.c bench.c	/Y
+
+$(TDIR)\bench.exe:	bench.obj $(LDIR)\mock.lib $(LDIR)\gem.lib
+	cl /Fe$(TDIR)\bench.exe bench.obj $(LDIR)\gem.lib $(LDIR)\mock.lib \
+		psapi.lib $(LOPTS)
+
+bench.obj:	bench.c $(IDIR)\gem.h $(IDIR)\drep.h
+	cl /c $(COPTS) -I$(IDIR) bench.c
+
+end:
+	-del bench.c
+	cd $(SDIR)
+
+clean:
+	-del $(ODIR)\bench.obj $(TDIR)\bench.exe
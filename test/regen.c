@@ -0,0 +1,171 @@
+/*
+ *      GEM: Geometry Environment for MDAO frameworks
+ *
+ *             Regeneration Test Code
+ *
+ *      Copyright 2011-2013, Massachusetts Institute of Technology
+ *      Licensed under The GNU Lesser General Public License, version 2.1
+ *      See http://www.opensource.org/licenses/lgpl-2.1.php
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "gem.h"
+
+#ifdef MOCK
+#define LOCATION "param box(1,1,1) box(1,1,0.5)"
+#else
+#define LOCATION "regen.csm"
+#endif
+
+
+/* the state of a Bound that should survive a regeneration */
+typedef struct {
+  int     nvs;
+  gemPair index;
+  double  uvlimits[4];
+} boundState;
+
+
+static int
+getBound(gemDRep *drep, int ibound, boundState *state)
+{
+  int     status, nIDs, *iIDs;
+  gemPair *indices;
+
+  status = gem_getBoundInfo(drep, ibound, &nIDs, &iIDs, &indices,
+                            state->uvlimits, &state->nvs);
+  if (status == GEM_SUCCESS) state->index = indices[0];
+  return status;
+}
+
+
+/* scale the real values of a Parameter & regenerate */
+static int
+scaleParam(gemModel *model, int param, double scale)
+{
+  int    status, i, bflag, order, ptype, plen, nattr, *ints;
+  char   *pname, *str;
+  double *reals, *vals;
+  gemSpl *spline;
+
+  status = gem_getParam(model, param, &pname, &bflag, &order, &ptype, &plen,
+                        &ints, &reals, &str, &spline, &nattr);
+  if (status != GEM_SUCCESS) return status;
+  if (ptype != GEM_REAL) return GEM_BADTYPE;
+  vals = (double *) malloc(plen*sizeof(double));
+  if (vals == NULL) return GEM_ALLOC;
+  for (i = 0; i < plen; i++) vals[i] = scale*reals[i];
+  status = gem_setParam(model, param, plen, NULL, vals, NULL, NULL);
+  free(vals);
+  printf(" gem_setParam %s = %d\n", pname, status);
+  if (status != GEM_SUCCESS) return status;
+
+  status = gem_regenModel(model);
+  printf(" gem_regenModel = %d  (%d BReps)\n", status, model->nBRep);
+  return status;
+}
+
+
+int main(int argc, char *argv[])
+{
+  int        status, i, nerr, ntris, npts, *tris, *tris0, nParams;
+  int        sense, nloops, *loops, nattr, ibound, ivs;
+  char       *location, *ID;
+  double     uvbox[4], props[14], volume, *xyzs;
+  gemPair    bface;
+  gemCntxt   *context;
+  gemModel   *model;
+  gemDRep    *drep;
+  gemBRep    *brep0;
+  boundState kept, reset;
+
+  if (argc > 2) {
+    printf(" usage: [d/m]regen [location (default: %s)]!\n", LOCATION);
+    return 1;
+  }
+  location = LOCATION;
+  if (argc == 2) location = argv[1];
+
+  status = gem_initialize(&context);
+  printf(" gem_initialize = %d\n", status);
+  status = gem_loadModel(context, NULL, location, &model);
+  printf(" gem_loadModel = %d\n", status);
+  if (status != GEM_SUCCESS) {
+    gem_terminate(context);
+    return 1;
+  }
+  nParams = model->nParams;
+  if ((model->nBRep < 2) || (nParams < 2)) {
+    printf(" need at least 2 BReps & 2 Parameters!\n");
+    gem_releaseModel(model);
+    gem_terminate(context);
+    return 1;
+  }
+
+  /* tessellate & parameterize a Bound on the first BRep */
+  status = gem_newDRep(model, &drep);
+  if (status == GEM_SUCCESS) status = gem_tesselDRep(drep, 0, 0.0, 0.0, 0.0);
+  printf(" gem_tesselDRep = %d\n", status);
+  if (status == GEM_SUCCESS)
+    status = gem_getFace(model->BReps[0], 1, &ID, uvbox, &sense, &nloops,
+                         &loops, &nattr);
+  if (status == GEM_SUCCESS) status = gem_createBound(drep, 1, &ID, &ibound);
+  if (status == GEM_SUCCESS)
+    status = gem_createVset(drep, ibound, "triLinearContinuous", &ivs);
+  if (status == GEM_SUCCESS) status = gem_paramBound(drep, ibound);
+  printf(" gem_paramBound = %d\n", status);
+  if (status == GEM_SUCCESS)
+    status = gem_getMassProps(model->BReps[model->nBRep-1], GEM_BREP, 0,
+                              props);
+  if (status != GEM_SUCCESS) {
+    gem_releaseModel(model);
+    gem_terminate(context);
+    return 1;
+  }
+  volume = props[0];
+  brep0  = model->BReps[0];
+  bface.BRep  = 1;
+  bface.index = 1;
+  gem_getTessel(drep, bface, &ntris, &npts, &tris0, &xyzs);
+  getBound(drep, ibound, &kept);
+
+  /* a change to the last feature keeps the first BRep & what is on it */
+  nerr   = 0;
+  status = scaleParam(model, nParams, 1.5);
+  if (status != GEM_SUCCESS) nerr++;
+  if (model->BReps[0] != brep0) nerr++;
+  if (drep->nBReps != model->nBRep) nerr++;
+  tris = NULL;
+  gem_getTessel(drep, bface, &ntris, &npts, &tris, &xyzs);
+  if (tris != tris0) nerr++;
+  getBound(drep, ibound, &reset);
+  if ((kept.nvs         != reset.nvs)         ||
+      (kept.index.BRep  != reset.index.BRep)  ||
+      (kept.index.index != reset.index.index)) nerr++;
+  for (i = 0; i < 4; i++)
+    if (kept.uvlimits[i] != reset.uvlimits[i]) nerr++;
+  status = gem_getMassProps(model->BReps[model->nBRep-1], GEM_BREP, 0, props);
+  if ((status != GEM_SUCCESS) || (props[0] == volume)) nerr++;
+  printf(" %s after changing the last Parameter (%d errors)\n\n",
+         (nerr == 0) ? "DRep kept" : "DRep NOT kept", nerr);
+
+  /* a change to the first feature starts the Bound over */
+  status = scaleParam(model, 1, 1.5);
+  if (status != GEM_SUCCESS) nerr++;
+  getBound(drep, ibound, &reset);
+  if ((reset.nvs != 0) || (reset.index.BRep != 1)) nerr++;
+  printf(" Bound %s after changing the first Parameter\n\n",
+         ((reset.nvs == 0) && (reset.index.BRep == 1)) ? "reset" :
+                                                         "NOT reset");
+
+  status = gem_releaseModel(model);
+  printf(" gem_releaseModel = %d\n", status);
+  status = gem_terminate(context);
+  printf(" gem_terminate = %d\n", status);
+
+  return (nerr == 0) ? 0 : 1;
+}
@@ -0,0 +1,40 @@
+#
+!include ..\include\$(GEM_ARCH)
+DBLD =
+SDIR = $(MAKEDIR)
+IDIR = $(SDIR)\..\include
+ODIR = $(GEM_BLOC)\obj
+LDIR = $(GEM_BLOC)\lib
+TDIR = $(GEM_BLOC)\test
+!ifdef EGADSLIB
+DBLD = $(TDIR)\dregen.exe
+!endif
+
+default:	start $(TDIR)\mregen.exe $(DBLD) end
+
+start:
+	cd $(ODIR)
+	copy $(SDIR)\regen.c mregen.c	/Y
+	copy $(SDIR)\regen.c dregen.c	/Y
+
+$(TDIR)\mregen.exe:	mregen.obj $(LDIR)\mock.lib $(LDIR)\gem.lib
+	cl /Fe$(TDIR)\mregen.exe mregen.obj $(LDIR)\gem.lib $(LDIR)\mock.lib \
+		$(LOPTS)
+
+$(TDIR)\dregen.exe:	dregen.obj $(LDIR)\diamond.lib $(LDIR)\gem.lib
+	cl /Fe$(TDIR)\dregen.exe dregen.obj $(LDIR)\gem.lib \
+		$(LDIR)\diamond.lib $(EGADSLIB)\egads.lib $(LOPTS)
+
+mregen.obj:	mregen.c $(IDIR)\gem.h
+	cl /c $(COPTS) /DMOCK -I$(IDIR) mregen.c
+
+dregen.obj:	dregen.c $(IDIR)\gem.h
+	cl /c $(COPTS) -I$(IDIR) dregen.c
+
+end:
+	-del mregen.c dregen.c
+	cd $(SDIR)
+
+clean:
+	-del $(ODIR)\mregen.obj $(ODIR)\dregen.obj
+	-del $(TDIR)\mregen.exe $(TDIR)\dregen.exe
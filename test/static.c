@@ -11,13 +11,145 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "gem.h"
 
 
+/* the state of a Bound that should survive adding BReps */
+typedef struct {
+  int     nvs;
+  gemPair index;
+  double  uvlimits[4];
+} boundState;
+
+
+static int
+getBound(gemDRep *drep, int ibound, boundState *state)
+{
+  int     status, nIDs, *iIDs;
+  gemPair *indices;
+
+  status = gem_getBoundInfo(drep, ibound, &nIDs, &iIDs, &indices,
+                            state->uvlimits, &state->nvs);
+  if (status == GEM_SUCCESS) state->index = indices[0];
+  return status;
+}
+
+
+/* add several BReps in one call to a tessellated & parameterized DRep */
+static int
+addMany(gemCntxt *context, int nBRep, gemBRep **BReps, double *xform)
+{
+  int        status, i, j, nerr = 0, nbound, ntris, npts, *tris, *tris0;
+  int        sense, nloops, *loops, nattr;
+  char       *IDs[2];
+  double     uvbox[4], *xyzs, *xforms;
+  gemPair    bface;
+  gemModel   *newModel, *scratch;
+  gemDRep    *drep;
+  gemBRep    **list;
+  boundState kept, reset;
+
+  /* the first BRep again (moved) and all of the others */
+  list   = (gemBRep **) malloc((nBRep+1)*sizeof(gemBRep *));
+  xforms = (double *)   malloc(12*(nBRep+1)*sizeof(double));
+  if ((list == NULL) || (xforms == NULL)) {
+    free(list);
+    free(xforms);
+    return 1;
+  }
+  for (i = 0; i <= nBRep; i++) {
+    list[i] = (i == 0) ? BReps[0] : BReps[i-1];
+    for (j = 0; j < 12; j++) xforms[12*i+j] = (j%5 == 0) ? 1.0 : 0.0;
+  }
+  for (j = 0; j < 12; j++) xforms[j] = xform[j];
+
+  /* the Face IDs of copies -- the last is only found once they are added */
+  status = gem_staticModel(context, &newModel);
+  if (status == GEM_SUCCESS) status = gem_add2Model(newModel, BReps[0], NULL);
+  if (status == GEM_SUCCESS) status = gem_staticModel(context, &scratch);
+  if (status == GEM_SUCCESS)
+    status = gem_addBReps2Model(scratch, nBRep+1, list, xforms);
+  if (status != GEM_SUCCESS) {
+    free(xforms);
+    free(list);
+    return 1;
+  }
+  gem_getFace(newModel->BReps[0], 1, &IDs[0], uvbox, &sense, &nloops,
+              &loops, &nattr);
+  gem_getFace(scratch->BReps[nBRep], 1, &IDs[1], uvbox, &sense, &nloops,
+              &loops, &nattr);
+
+  status = gem_newDRep(newModel, &drep);
+  printf(" gem_newDRep = %d\n", status);
+  if (status == GEM_SUCCESS) status = gem_tesselDRep(drep, 0, 0.0, 0.0, 0.0);
+  printf(" gem_tesselDRep = %d\n", status);
+  if (status != GEM_SUCCESS) {
+    free(xforms);
+    free(list);
+    return 1;
+  }
+  bface.BRep  = 1;
+  bface.index = 1;
+  gem_getTessel(drep, bface, &ntris, &npts, &tris0, &xyzs);
+
+  /* one Bound on the Model and (if there is one) one on a Face to come */
+  status = gem_createBound(drep, 1, IDs, &i);
+  if (status == GEM_SUCCESS)
+    status = gem_createVset(drep, 1, "triLinearContinuous", &j);
+  if (status == GEM_SUCCESS) status = gem_paramBound(drep, 1);
+  printf(" Bound 1: gem_paramBound = %d\n", status);
+  nbound = 0;
+  if ((status == GEM_SUCCESS) && (strcmp(IDs[0], IDs[1]) != 0)) {
+    status = gem_createBound(drep, 1, &IDs[1], &i);
+    if (status == GEM_SUCCESS)
+      status = gem_createVset(drep, 2, "triLinearContinuous", &j);
+    printf(" Bound 2 (not yet in the Model) = %d\n", status);
+    nbound = 2;
+  }
+  if (status != GEM_SUCCESS) {
+    free(xforms);
+    free(list);
+    return 1;
+  }
+  getBound(drep, 1, &kept);
+
+  status = gem_addBReps2Model(newModel, nBRep+1, list, xforms);
+  printf(" gem_addBReps2Model = %d  (%d BReps)\n", status, nBRep+1);
+  free(xforms);
+  free(list);
+  if (status != GEM_SUCCESS) return 1;
+
+  /* the old tessellation & parameterization are still there */
+  if (drep->nBReps != newModel->nBRep) nerr++;
+  gem_getTessel(drep, bface, &ntris, &npts, &tris, &xyzs);
+  if (tris != tris0) nerr++;
+  getBound(drep, 1, &reset);
+  if ((kept.nvs        != reset.nvs)        ||
+      (kept.index.BRep  != reset.index.BRep)  ||
+      (kept.index.index != reset.index.index)) nerr++;
+  for (i = 0; i < 4; i++)
+    if (kept.uvlimits[i] != reset.uvlimits[i]) nerr++;
+
+  /* only the Bound with the newly found ID starts over */
+  if (nbound == 2) {
+    getBound(drep, 2, &reset);
+    if ((reset.index.BRep != nBRep+2) || (reset.nvs != 0)) nerr++;
+  }
+  printf(" %s after adding BReps (%d errors)\n",
+         (nerr == 0) ? "DRep kept" : "DRep NOT kept", nerr);
+
+  gem_releaseModel(scratch);
+  status = gem_releaseModel(newModel);
+  printf(" gem_releaseModel = %d\n\n", status);
+  return nerr;
+}
+
+
 int main(int argc, char *argv[])
 {
-  int      status, i, uptodate, nBRep, nParams, nBranch, nattr;
+  int      status, i, uptodate, nBRep, nParams, nBranch, nattr, nerr;
   double   xform[12];
   char     *server, *filename, *modeler;
   gemCntxt *context;
@@ -67,6 +199,7 @@ int main(int argc, char *argv[])
   printf(" gem_add2Model = %d\n", status);
   status = gem_add2Model(newModel, BReps[0], xform);
   printf(" gem_add2Model = %d\n\n", status);
+  nerr = addMany(context, nBRep, BReps, xform);
   status  = gem_getModel(newModel, &server, &filename, &modeler, &uptodate,
                          &nBRep, &BReps, &nParams, &nBranch, &nattr);
   printf(" gem_getModel = %d\n", status);
@@ -87,5 +220,5 @@ int main(int argc, char *argv[])
   status = gem_terminate(context);
   printf(" gem_terminate = %d\n", status);
 
-  return 0;
+  return (nerr == 0) ? 0 : 1;
 }